@@ -117,6 +117,20 @@ bool IOFile::Flush()
   return m_good;
 }
 
+bool IOFile::Sync()
+{
+  if (!Flush())
+    return false;
+#ifdef _WIN32
+  if (0 != _commit(_fileno(m_file)))
+#else
+  if (0 != fsync(fileno(m_file)))
+#endif
+    m_good = false;
+
+  return m_good;
+}
+
 bool IOFile::Resize(u64 size)
 {
 #ifdef _WIN32
@@ -79,6 +79,8 @@ public:
   u64 GetSize() const;
   bool Resize(u64 size);
   bool Flush();
+  // Flushes and asks the OS to commit the file's contents to the storage device.
+  bool Sync();
 
   // clear error state
   void Clear()
@@ -0,0 +1,229 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/TaskScheduler.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/CPUDetect.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+
+namespace Common
+{
+namespace
+{
+// Number of threads outside of the pool that can have their own deque at the same time.
+constexpr size_t MAX_EXTERNAL_THREADS = 16;
+// Number of steal attempts an idle worker makes before going to sleep.
+constexpr u32 WORKER_SPIN_COUNT = 64;
+
+struct ThreadContext
+{
+  WorkStealingDeque<Task*, TaskScheduler::TASKS_PER_THREAD> deque;
+  std::array<Task, TaskScheduler::TASKS_PER_THREAD> tasks;
+  size_t next_task = 0;
+  // Only used by external contexts.
+  std::atomic<bool> leased{false};
+};
+
+thread_local ThreadContext* s_context = nullptr;
+thread_local size_t s_next_victim = 0;
+
+class Scheduler
+{
+public:
+  Scheduler()
+  {
+    const size_t num_workers = static_cast<size_t>(std::max(cpu_info.logical_cpu_count - 2, 1));
+
+    for (size_t i = 0; i < num_workers + MAX_EXTERNAL_THREADS; ++i)
+      m_contexts.push_back(std::make_unique<ThreadContext>());
+
+    for (size_t i = 0; i < num_workers; ++i)
+      m_threads.emplace_back(&Scheduler::WorkerLoop, this, i);
+  }
+
+  ~Scheduler()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_running.store(false);
+      m_wakeup.notify_all();
+    }
+    for (std::thread& thread : m_threads)
+      thread.join();
+  }
+
+  size_t GetWorkerCount() const { return m_threads.size(); }
+
+  // Returns the calling thread's context, leasing an external one if it doesn't have one yet.
+  ThreadContext* GetContext()
+  {
+    if (s_context)
+      return s_context;
+
+    for (size_t i = m_threads.size(); i < m_contexts.size(); ++i)
+    {
+      ThreadContext* context = m_contexts[i].get();
+      bool expected = false;
+      if (context->leased.compare_exchange_strong(expected, true, std::memory_order_acquire))
+      {
+        s_context = context;
+        s_lease.context = context;
+        return context;
+      }
+    }
+    return nullptr;
+  }
+
+  bool Steal(Task** task)
+  {
+    const size_t count = m_contexts.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+      ThreadContext* victim = m_contexts[s_next_victim++ % count].get();
+      if (victim != s_context && victim->deque.Steal(task))
+        return true;
+    }
+    return false;
+  }
+
+  void Notify()
+  {
+    m_epoch.fetch_add(1);
+    if (m_sleeping.load() > 0)
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_wakeup.notify_one();
+    }
+  }
+
+private:
+  struct ExternalLease
+  {
+    ~ExternalLease()
+    {
+      if (!context)
+        return;
+
+      // Any tasks still queued here can still be stolen; the next owner just keeps pushing.
+      s_context = nullptr;
+      context->leased.store(false, std::memory_order_release);
+    }
+
+    ThreadContext* context = nullptr;
+  };
+
+  static thread_local ExternalLease s_lease;
+
+  void WorkerLoop(size_t index)
+  {
+    Common::SetCurrentThreadName(StringFromFormat("Task worker %zu", index).c_str());
+    s_context = m_contexts[index].get();
+    s_next_victim = index + 1;
+
+    while (m_running.load(std::memory_order_relaxed))
+    {
+      // Read the epoch before looking for work, so that work queued after an unsuccessful search
+      // is guaranteed to change it.
+      const u32 epoch = m_epoch.load();
+
+      bool found = false;
+      for (u32 i = 0; i < WORKER_SPIN_COUNT && !found; ++i)
+      {
+        found = TaskScheduler::RunOneTask();
+        if (!found)
+          Common::YieldCPU();
+      }
+      if (found)
+        continue;
+
+      m_sleeping.fetch_add(1);
+      {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_wakeup.wait(lk, [&] { return !m_running.load() || m_epoch.load() != epoch; });
+      }
+      m_sleeping.fetch_sub(1);
+    }
+  }
+
+  // Worker contexts first, then the external ones.
+  std::vector<std::unique_ptr<ThreadContext>> m_contexts;
+  std::vector<std::thread> m_threads;
+
+  std::atomic<bool> m_running{true};
+  std::atomic<u32> m_epoch{0};
+  std::atomic<u32> m_sleeping{0};
+  std::mutex m_mutex;
+  std::condition_variable m_wakeup;
+};
+
+thread_local Scheduler::ExternalLease Scheduler::s_lease;
+
+Scheduler& GetScheduler()
+{
+  static Scheduler scheduler;
+  return scheduler;
+}
+}  // Anonymous namespace
+
+size_t TaskScheduler::GetWorkerCount()
+{
+  return GetScheduler().GetWorkerCount();
+}
+
+Task* TaskScheduler::AllocateTask()
+{
+  ThreadContext* context = GetScheduler().GetContext();
+  if (!context)
+    return nullptr;
+
+  // Only the owning thread allocates from its slots; other threads just release them.
+  for (size_t i = 0; i < TASKS_PER_THREAD; ++i)
+  {
+    Task& task = context->tasks[context->next_task];
+    context->next_task = (context->next_task + 1) % TASKS_PER_THREAD;
+    if (!task.m_in_use.load(std::memory_order_acquire))
+    {
+      task.m_in_use.store(true, std::memory_order_relaxed);
+      return &task;
+    }
+  }
+  return nullptr;
+}
+
+void TaskScheduler::Enqueue(Task* task)
+{
+  // There are as many deque entries as task slots, so this can't fail.
+  s_context->deque.Push(task);
+  GetScheduler().Notify();
+}
+
+bool TaskScheduler::RunOneTask()
+{
+  Task* task;
+  if ((s_context && s_context->deque.Pop(&task)) || GetScheduler().Steal(&task))
+  {
+    task->Run();
+    task->m_in_use.store(false, std::memory_order_release);
+    return true;
+  }
+  return false;
+}
+
+void TaskScheduler::Backoff(u32 count)
+{
+  if (count < 16)
+    Common::YieldCPU();
+  else if (count < 32)
+    Common::SleepCurrentThread(0);
+  else
+    Common::SleepCurrentThread(1);
+}
+}  // namespace Common
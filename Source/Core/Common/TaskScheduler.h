@@ -0,0 +1,251 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Work-stealing task scheduler.
+//
+// Every worker thread owns a fixed-size Chase-Lev deque of tasks: the owner pushes and pops at
+// the bottom without any locking, and idle workers steal from the top of other threads' deques.
+// Threads outside of the pool (the GPU thread, for example) lease one of a small number of
+// external deques the first time they submit work, so submission never takes a lock either.
+//
+// Tasks are stored inline in per-thread slot arrays, so submitting a task never allocates. If a
+// thread runs out of slots, or no deque is available, the task is simply run on the calling
+// thread.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+// Fixed-capacity Chase-Lev work-stealing deque. Push() and Pop() may only be called by the
+// owning thread; Steal() may be called by any thread. T must be trivially copyable, since a
+// thief may read an element that the owner is concurrently taking.
+template <typename T, size_t Capacity>
+class WorkStealingDeque
+{
+  static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+  static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+public:
+  bool Push(T item)
+  {
+    const s64 bottom = m_bottom.load(std::memory_order_relaxed);
+    const s64 top = m_top.load(std::memory_order_acquire);
+    if (bottom - top >= static_cast<s64>(Capacity))
+      return false;
+
+    m_buffer[bottom & MASK].store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool Pop(T* item)
+  {
+    const s64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    s64 top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+      // Empty.
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    *item = m_buffer[bottom & MASK].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+      // Last element; race against thieves for it.
+      const bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed);
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  bool Steal(T* item)
+  {
+    s64 top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const s64 bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+      return false;
+
+    const T value = m_buffer[top & MASK].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed))
+    {
+      return false;
+    }
+    *item = value;
+    return true;
+  }
+
+  bool Empty() const
+  {
+    return m_top.load(std::memory_order_relaxed) >= m_bottom.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr s64 MASK = static_cast<s64>(Capacity) - 1;
+
+  alignas(64) std::atomic<s64> m_top{0};
+  alignas(64) std::atomic<s64> m_bottom{0};
+  std::array<std::atomic<T>, Capacity> m_buffer{};
+};
+
+// A type-erased callable with inline storage. Run() invokes and destroys the callable.
+class alignas(64) Task
+{
+public:
+  static constexpr size_t STORAGE_SIZE = 112;
+
+  template <typename F>
+  void Set(F&& func)
+  {
+    using Functor = std::decay_t<F>;
+    static_assert(sizeof(Functor) <= STORAGE_SIZE, "Task functor is too large");
+    static_assert(alignof(Functor) <= 16, "Task functor is over-aligned");
+
+    new (m_storage) Functor(std::forward<F>(func));
+    m_invoke = [](void* storage) {
+      Functor& functor = *static_cast<Functor*>(storage);
+      functor();
+      functor.~Functor();
+    };
+  }
+
+  void Run() { m_invoke(m_storage); }
+
+  // Set while the task is queued or running; owned by the scheduler.
+  std::atomic<bool> m_in_use{false};
+
+private:
+  alignas(16) u8 m_storage[STORAGE_SIZE];
+  void (*m_invoke)(void*) = nullptr;
+};
+
+class TaskScheduler
+{
+public:
+  static constexpr size_t TASKS_PER_THREAD = 256;
+
+  // Queues func to run on any thread of the pool. Never blocks and never allocates.
+  template <typename F>
+  static void Submit(F&& func)
+  {
+    Task* task = AllocateTask();
+    if (!task)
+    {
+      func();
+      return;
+    }
+    task->Set(std::forward<F>(func));
+    Enqueue(task);
+  }
+
+  // Runs queued tasks on the calling thread until done() returns true.
+  template <typename Predicate>
+  static void HelpUntil(Predicate done)
+  {
+    u32 idle_count = 0;
+    while (!done())
+    {
+      if (RunOneTask())
+        idle_count = 0;
+      else
+        Backoff(idle_count++);
+    }
+  }
+
+  // Runs a single queued task on the calling thread, preferring its own queue. Returns false if
+  // there was nothing to run.
+  static bool RunOneTask();
+
+  static size_t GetWorkerCount();
+
+private:
+  static Task* AllocateTask();
+  static void Enqueue(Task* task);
+  static void Backoff(u32 count);
+};
+
+// Tracks a set of tasks so they can be waited on together. Wait() executes queued tasks (not
+// necessarily from this group) while waiting, so groups may be nested freely.
+class TaskGroup
+{
+public:
+  TaskGroup() = default;
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+  ~TaskGroup() { Wait(); }
+
+  template <typename F>
+  void Run(F&& func)
+  {
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    TaskScheduler::Submit([this, func = std::forward<F>(func)]() mutable {
+      func();
+      m_pending.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  void Wait()
+  {
+    TaskScheduler::HelpUntil([this] { return m_pending.load(std::memory_order_acquire) == 0; });
+  }
+
+private:
+  std::atomic<u32> m_pending{0};
+};
+
+// Calls body(chunk_begin, chunk_end) over [begin, end) split into chunks of at least grain
+// elements, and returns once every chunk is done. Chunks run in parallel on the pool and the
+// calling thread.
+template <typename Index, typename Body>
+void ParallelFor(Index begin, Index end, Index grain, const Body& body)
+{
+  if (end <= begin)
+    return;
+
+  const Index count = end - begin;
+  const Index max_chunks = static_cast<Index>((TaskScheduler::GetWorkerCount() + 1) * 4);
+  const Index chunk =
+      std::max<Index>(std::max<Index>(grain, 1), (count + max_chunks - 1) / max_chunks);
+  if (chunk >= count)
+  {
+    body(begin, end);
+    return;
+  }
+
+  TaskGroup group;
+  const Body* body_ptr = &body;
+  for (Index chunk_begin = begin + chunk; chunk_begin < end; chunk_begin += chunk)
+  {
+    const Index chunk_end = chunk_begin + std::min<Index>(chunk, end - chunk_begin);
+    group.Run([body_ptr, chunk_begin, chunk_end] { (*body_ptr)(chunk_begin, chunk_end); });
+  }
+  // The first chunk runs here, while the workers pick up the rest.
+  body(begin, begin + chunk);
+  group.Wait();
+}
+
+template <typename Index, typename Body>
+void ParallelFor(Index begin, Index end, const Body& body)
+{
+  ParallelFor(begin, end, static_cast<Index>(1), body);
+}
+}  // namespace Common
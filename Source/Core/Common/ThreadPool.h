@@ -39,6 +39,7 @@
 #include <utility>
 #include <vector>
 
+#include "Common/Common.h"
 #include "Common/Thread.h"
 
 namespace Common
@@ -428,49 +429,4 @@ public:
     return m_inner.empty();
   }
 };
-
-class IWorker
-{
-public:
-  virtual ~IWorker()
-  {}
-  virtual bool NextTask(size_t ID) = 0;
-};
-
-class ThreadPool
-{
-private:
-  std::vector<std::unique_ptr<std::thread>> m_workerThreads;
-  std::vector<IWorker*> m_workers;
-  std::atomic<s32> m_workflag;
-  std::atomic<s32> m_workercount;
-  std::atomic<bool> m_working;
-  static std::mutex m_workerLock;
-  static void Workloop(ThreadPool &state, size_t ID);
-  static ThreadPool &Getinstance();
-  ThreadPool(ThreadPool const&);
-  void operator=(ThreadPool const&);
-  ThreadPool();
-public:
-  virtual ~ThreadPool();
-  static void NotifyWorkPending();
-  static void RegisterWorker(IWorker* worker);
-  static void UnregisterWorker(IWorker* worker);
-  static inline size_t GetThreadCount() {
-    return Getinstance().m_workerThreads.size();
-  }
-};
-
-class AsyncWorker final : IWorker
-{
-private:
-  std::atomic<s32> m_inputsize;
-  ManyToManyQueue<std::function<void()>, OneToOneQueue<std::function<void()>>> m_TaskQueue;
-  static AsyncWorker &Getinstance();
-  AsyncWorker();
-public:
-  virtual ~AsyncWorker();
-  bool NextTask(size_t ID) override;
-  static void ExecuteAsync(std::function<void()> &&func);
-};
 }
@@ -38,7 +38,11 @@ extern const ConfigInfo<bool> GFX_HIRES_MATERIAL_MAPS;
 extern const ConfigInfo<bool> GFX_HIRES_MATERIAL_MAPS_BUILD;
 extern const ConfigInfo<bool> GFX_CACHE_HIRES_TEXTURES;
 extern const ConfigInfo<bool> GFX_WAIT_CACHE_HIRES_TEXTURES;
+// In MB, 0 picks a budget based on the amount of system memory.
+extern const ConfigInfo<int> GFX_HIRES_TEXTURES_CACHE_SIZE;
 extern const ConfigInfo<bool> GFX_DUMP_EFB_TARGET;
+// zlib level (0-9) used for texture and EFB dumps.
+extern const ConfigInfo<int> GFX_PNG_COMPRESSION_LEVEL;
 extern const ConfigInfo<bool> GFX_DUMP_FRAMES_AS_IMAGES;
 extern const ConfigInfo<bool> GFX_FREE_LOOK;
 extern const ConfigInfo<bool> GFX_COMPILE_SHADERS_ON_STARTUP;
@@ -48,6 +52,8 @@ extern const ConfigInfo<std::string> GFX_DUMP_FORMAT;
 extern const ConfigInfo<std::string> GFX_DUMP_CODEC;
 extern const ConfigInfo<std::string> GFX_DUMP_PATH;
 extern const ConfigInfo<int> GFX_BITRATE_KBPS;
+extern const ConfigInfo<int> GFX_FRAME_DUMP_QUEUE_SIZE;
+extern const ConfigInfo<bool> GFX_FRAME_DUMP_DROP_FRAMES;
 extern const ConfigInfo<bool> GFX_INTERNAL_RESOLUTION_FRAME_DUMPS;
 extern const ConfigInfo<bool> GFX_ENABLE_GPU_TEXTURE_DECODING;
 extern const ConfigInfo<bool> GFX_ENABLE_COMPUTE_TEXTURE_ENCODING;
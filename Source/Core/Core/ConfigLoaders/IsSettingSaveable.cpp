@@ -47,7 +47,9 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_HIRES_MATERIAL_MAPS_BUILD.location,
       Config::GFX_CACHE_HIRES_TEXTURES.location,
       Config::GFX_WAIT_CACHE_HIRES_TEXTURES.location,
+      Config::GFX_HIRES_TEXTURES_CACHE_SIZE.location,
       Config::GFX_DUMP_EFB_TARGET.location,
+      Config::GFX_PNG_COMPRESSION_LEVEL.location,
       Config::GFX_DUMP_FRAMES_AS_IMAGES.location,
       Config::GFX_FREE_LOOK.location,
       Config::GFX_COMPILE_SHADERS_ON_STARTUP.location,
@@ -56,6 +58,8 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_DUMP_CODEC.location,
       Config::GFX_DUMP_PATH.location,
       Config::GFX_BITRATE_KBPS.location,
+      Config::GFX_FRAME_DUMP_QUEUE_SIZE.location,
+      Config::GFX_FRAME_DUMP_DROP_FRAMES.location,
       Config::GFX_INTERNAL_RESOLUTION_FRAME_DUMPS.location,
       Config::GFX_ENABLE_GPU_TEXTURE_DECODING.location,
       Config::GFX_ENABLE_COMPUTE_TEXTURE_ENCODING.location,
@@ -7,8 +7,10 @@
 #include <array>
 #include <cstddef>
 
+#include "Common/BitSet.h"
 #include "Common/Logging/Log.h"
 
+#include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPMemoryMap.h"
 #include "Core/DSP/DSPTables.h"
 
@@ -23,55 +25,159 @@ constexpr size_t ISPACE = 65536;
 // Holds data about all instructions in RAM.
 std::array<u8, ISPACE> code_flags;
 
-// Good candidates for idle skipping is mail wait loops. If we're time slicing
+// Idle skip coverage of the last analysis.
+struct
+{
+  size_t candidates;
+  size_t idle_loops;
+} s_loop_stats;
+
+// Good candidates for idle skipping are mail wait loops. If we're time slicing
 // between the main CPU and the DSP, if the DSP runs into one of these, it might
 // as well give up its time slice immediately, after executing once.
+//
+// Rather than matching known instruction sequences, we look for short backward
+// jumps whose body only reads memory and tests flags: the loop then does the
+// exact same thing every time around until the CPU (or an interrupt) changes
+// something, no matter which ucode it comes from.
+
+// Longest poll loop considered, in instruction words, including the jump back.
+constexpr u16 MAX_IDLE_LOOP_SIZE = 16;
+
+// Registers an instruction inside a poll loop reads and writes.
+struct LoopOpEffects
+{
+  BitSet32 reads;
+  BitSet32 writes;
+};
+
+// Reading these hardware registers acknowledges mail or advances the accelerator,
+// so a loop that reads them is doing real work.
+bool IsVolatileIFXRead(u16 addr)
+{
+  switch (addr & 0xff)
+  {
+  case DSP_DMBL:
+  case DSP_CMBL:
+  case DSP_ACDATA1:
+  case DSP_ACCELERATOR:
+    return true;
+  default:
+    return false;
+  }
+}
+
+BitSet32 AccumulatorRegs(int acc)
+{
+  return BitSet32{DSP_REG_ACH0 + acc, DSP_REG_ACM0 + acc, DSP_REG_ACL0 + acc};
+}
+
+// Returns false unless the instruction is a plain memory read or a flag test.
+bool GetPollLoopOpEffects(UDSPInstruction inst, u16 addr, LoopOpEffects* effects)
+{
+  if ((inst & 0xf800) == 0x2000)
+  {
+    // LRS $(D+24), @M. The address depends on $cr, so be conservative.
+    if (IsVolatileIFXRead(inst))
+      return false;
+    const int reg = 0x18 + ((inst >> 8) & 0x7);
+    effects->reads = BitSet32{DSP_REG_CR};
+    effects->writes = BitSet32{reg};
+    // With SXM set, writing $acD.m also writes $acD.h and $acD.l.
+    if (reg >= DSP_REG_ACM0)
+      effects->writes |= AccumulatorRegs(reg - DSP_REG_ACM0);
+    return true;
+  }
+  if ((inst & 0xffe0) == 0x00c0)
+  {
+    // LR $D, @M
+    const int reg = inst & 0x1f;
+    const u16 mem = dsp_imem_read(static_cast<u16>(addr + 1));
+    if (reg >= DSP_REG_ST0 && reg <= DSP_REG_ST3)
+      return false;
+    if (mem >= 0xff00 && IsVolatileIFXRead(mem))
+      return false;
+    effects->reads = {};
+    effects->writes = BitSet32{reg};
+    if (reg == DSP_REG_ACM0 || reg == DSP_REG_ACM1)
+      effects->writes |= AccumulatorRegs(reg - DSP_REG_ACM0);
+    return true;
+  }
+
+  effects->writes = BitSet32{DSP_REG_SR};
+  if ((inst & 0xfeff) == 0x02a0 || (inst & 0xfeff) == 0x02c0)
+  {
+    // ANDF/ANDCF $acD.m, #I
+    effects->reads = BitSet32{DSP_REG_ACM0 + ((inst >> 8) & 1)};
+    return true;
+  }
+  if ((inst & 0xfeff) == 0x0280 || (inst & 0xfe00) == 0x0600)
+  {
+    // CMPI/CMPIS $acD, #I
+    effects->reads = AccumulatorRegs((inst >> 8) & 1);
+    return true;
+  }
 
-// Max signature length is 6. A 0 in a signature is ignored.
-constexpr size_t NUM_IDLE_SIGS = 8;
-constexpr size_t MAX_IDLE_SIG_SIZE = 6;
-
-// 0xFFFF means ignore.
-constexpr u16 idle_skip_sigs[NUM_IDLE_SIGS][MAX_IDLE_SIG_SIZE + 1] = {
-    // From AX:
-    {0x26fc,          // LRS   $30, @DMBH
-     0x02c0, 0x8000,  // ANDCF $30, #0x8000
-     0x029d, 0xFFFF,  // JLZ 0x027a
-     0, 0},           // RET
-    {0x27fc,          // LRS   $31, @DMBH
-     0x03c0, 0x8000,  // ANDCF $31, #0x8000
-     0x029d, 0xFFFF,  // JLZ 0x027a
-     0, 0},           // RET
-    {0x26fe,          // LRS   $30, @CMBH
-     0x02c0, 0x8000,  // ANDCF $30, #0x8000
-     0x029c, 0xFFFF,  // JLNZ 0x0280
-     0, 0},           // RET
-    {0x27fe,          // LRS   $31, @CMBH
-     0x03c0, 0x8000,  // ANDCF $31, #0x8000
-     0x029c, 0xFFFF,  // JLNZ 0x0280
-     0, 0},           // RET
-    {0x26fc,          // LRS  $AC0.M, @DMBH
-     0x02a0, 0x8000,  // ANDF $AC0.M, #0x8000
-     0x029c, 0xFFFF,  // JLNZ 0x????
-     0, 0},
-    {0x27fc,          // LRS  $AC1.M, @DMBH
-     0x03a0, 0x8000,  // ANDF $AC1.M, #0x8000
-     0x029c, 0xFFFF,  // JLNZ 0x????
-     0, 0},
-    // From Zelda:
-    {0x00de, 0xFFFE,  // LR    $AC0.M, @CMBH
-     0x02c0, 0x8000,  // ANDCF $AC0.M, #0x8000
-     0x029c, 0xFFFF,  // JLNZ 0x05cf
-     0},
-    // From Zelda - experimental
-    {0x00da, 0x0352,  // LR     $AX0.H, @0x0352
-     0x8600,          // TSTAXH $AX0.H
-     0x0295, 0xFFFF,  // JZ    0x????
-     0, 0}};
+  // The remaining ones may carry an extended opcode, which must be a NOP.
+  if ((inst & 0x00fc) != 0)
+    return false;
+  if ((inst & 0xfe00) == 0x8600)
+  {
+    // TSTAXH $axR.h
+    effects->reads = BitSet32{DSP_REG_AXH0 + ((inst >> 8) & 1)};
+    return true;
+  }
+  if ((inst & 0xf700) == 0xb100)
+  {
+    // TST $acR
+    effects->reads = AccumulatorRegs((inst >> 11) & 1);
+    return true;
+  }
+  if ((inst & 0xff00) == 0x8200)
+  {
+    // CMP
+    effects->reads = AccumulatorRegs(0) | AccumulatorRegs(1);
+    return true;
+  }
+  return false;
+}
+
+// Checks whether [loop_start, branch_addr] is a loop that keeps polling the same
+// state: straight-line code made only of reads and flag tests, which never
+// overwrites a register it read before writing it in the same iteration.
+bool IsPollLoop(u16 loop_start, u16 branch_addr)
+{
+  BitSet32 loop_inputs;
+  BitSet32 written;
+  u16 addr = loop_start;
+  while (addr < branch_addr)
+  {
+    const UDSPInstruction inst = dsp_imem_read(addr);
+    const DSPOPCTemplate* opcode = GetOpTemplate(inst);
+    LoopOpEffects effects;
+    if (!opcode || !(code_flags[addr] & CODE_START_OF_INST) ||
+        (code_flags[addr] & (CODE_LOOP_START | CODE_LOOP_END)) ||
+        !GetPollLoopOpEffects(inst, addr, &effects))
+    {
+      return false;
+    }
+
+    loop_inputs |= effects.reads & ~written;
+    if (effects.writes & loop_inputs)
+      return false;
+    written |= effects.writes;
+
+    addr += opcode->size;
+  }
+
+  // The jump back reads the flags, and must not sit in the middle of another instruction.
+  return addr == branch_addr && !(code_flags[branch_addr] & (CODE_LOOP_START | CODE_LOOP_END));
+}
 
 void Reset()
 {
   code_flags.fill(0);
+  s_loop_stats = {};
 }
 
 void AnalyzeRange(u16 start_addr, u16 end_addr)
@@ -129,26 +235,23 @@ void AnalyzeRange(u16 start_addr, u16 end_addr)
     addr += opcode->size;
   }
 
-  // Next, we'll scan for potential idle skips.
-  for (size_t s = 0; s < NUM_IDLE_SIGS; s++)
+  // Next, we'll scan for potential idle skips: JMPcc back to a nearby address.
+  for (u16 addr = start_addr; addr < end_addr; addr++)
   {
-    for (u16 addr = start_addr; addr < end_addr; addr++)
+    const UDSPInstruction inst = dsp_imem_read(addr);
+    if (!(code_flags[addr] & CODE_START_OF_INST) || (inst & 0xfff0) != 0x0290)
+      continue;
+
+    const u16 target = dsp_imem_read(static_cast<u16>(addr + 1));
+    if (target > addr || target < start_addr || addr - target >= MAX_IDLE_LOOP_SIZE)
+      continue;
+
+    s_loop_stats.candidates++;
+    if (IsPollLoop(target, addr))
     {
-      bool found = false;
-      for (size_t i = 0; i < MAX_IDLE_SIG_SIZE + 1; i++)
-      {
-        if (idle_skip_sigs[s][i] == 0)
-          found = true;
-        if (idle_skip_sigs[s][i] == 0xFFFF)
-          continue;
-        if (idle_skip_sigs[s][i] != dsp_imem_read(static_cast<u16>(addr + i)))
-          break;
-      }
-      if (found)
-      {
-        INFO_LOG(DSPLLE, "Idle skip location found at %02x (sigNum:%zu)", addr, s + 1);
-        code_flags[addr] |= CODE_IDLE_SKIP;
-      }
+      INFO_LOG(DSPLLE, "Idle skip location found at %04x (%u words)", target, addr + 2u - target);
+      code_flags[target] |= CODE_IDLE_SKIP;
+      s_loop_stats.idle_loops++;
     }
   }
   INFO_LOG(DSPLLE, "Finished analysis.");
@@ -160,6 +263,9 @@ void Analyze()
   Reset();
   AnalyzeRange(0x0000, 0x1000);  // IRAM
   AnalyzeRange(0x8000, 0x9000);  // IROM
+
+  NOTICE_LOG(DSPLLE, "ucode %08x: %zu of %zu short backward jumps are idle loops", g_dsp.iram_crc,
+             s_loop_stats.idle_loops, s_loop_stats.candidates);
 }
 
 u8 GetCodeFlags(u16 address)
@@ -5,13 +5,17 @@
 #include "Core/DSP/Jit/x64/DSPEmitter.h"
 
 #include <algorithm>
+#include <array>
+#include <cinttypes>
 #include <cstddef>
 #include <cstring>
+#include <utility>
 
 #include "Common/Assert.h"
 #include "Common/BitSet.h"
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 
 #include "Core/DSP/DSPAnalyzer.h"
@@ -28,21 +32,39 @@ namespace JIT
 {
 namespace x64
 {
-constexpr size_t COMPILED_CODE_SIZE = 2097152;
+// The dispatcher and the compile stub live in front of the code sets.
+constexpr size_t COMMON_CODE_SIZE = 4096;
+constexpr size_t CODE_SET_SIZE = 2097152;
+// Should be bigger than the biggest block ever.
+constexpr size_t CODE_SET_MARGIN = 0x10000;
 constexpr size_t MAX_BLOCK_SIZE = 250;
 constexpr u16 DSP_IDLE_SKIP_CYCLES = 0x1000;
 
+// Address ranges that can hold code, as (start, size). Code sets save their block tables in
+// this order.
+constexpr std::array<std::pair<u16, u16>, 2> CODE_RANGES = {
+    {{0x0000, DSP_IRAM_SIZE}, {0x8000, DSP_IROM_SIZE}}};
+
 DSPEmitter::DSPEmitter()
   : m_compile_status_register{ SR_INT_ENABLE | SR_EXT_INT_ENABLE }, m_blocks(MAX_BLOCKS),
   m_block_size(MAX_BLOCKS), m_block_links(MAX_BLOCKS)
 {
-  AllocCodeSpace(COMPILED_CODE_SIZE);
+  AllocCodeSpace(COMMON_CODE_SIZE + NUM_CODE_SETS * CODE_SET_SIZE);
 
   CompileDispatcher();
   m_stub_entry_point = CompileStub();
+  ASSERT(GetCodePtr() <= region + COMMON_CODE_SIZE);
+
+  u8* code_set_start = region + COMMON_CODE_SIZE;
+  for (CodeSet& set : m_code_sets)
+  {
+    set.code_start = code_set_start;
+    set.code_end = code_set_start + CODE_SET_SIZE;
+    ResetCodeSet(set);
+    code_set_start = set.code_end;
+  }
 
-  // Clear all of the block references
-  std::fill(m_blocks.begin(), m_blocks.end(), (DSPCompiledCode)m_stub_entry_point);
+  SwitchCodeSet();
 }
 
 DSPEmitter::~DSPEmitter()
@@ -64,7 +86,7 @@ u16 DSPEmitter::RunCycles(u16 cycles)
   exec_addr();
 
   if (g_dsp.reset_dspjit_codespace)
-    ClearIRAMandDSPJITCodespaceReset();
+    SwitchCodeSet();
 
   return m_cycles_left;
 }
@@ -76,6 +98,11 @@ void DSPEmitter::DoState(PointerWrap& p)
 
 void DSPEmitter::ClearIRAM()
 {
+  // Keep the blocks of the outgoing ucode. Anything compiled from here until the code set is
+  // switched belongs to neither ucode and is dropped.
+  if (!g_dsp.reset_dspjit_codespace)
+    SaveCodeSet(*m_active_code_set);
+
   for (size_t i = 0; i < DSP_IRAM_SIZE; i++)
   {
     m_blocks[i] = (DSPCompiledCode)m_stub_entry_point;
@@ -86,12 +113,47 @@ void DSPEmitter::ClearIRAM()
   g_dsp.reset_dspjit_codespace = true;
 }
 
-void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
+void DSPEmitter::SwitchCodeSet()
 {
-  ClearCodeSpace();
-  CompileDispatcher();
-  m_stub_entry_point = CompileStub();
+  const u64 hash = GetMurmurHash3(reinterpret_cast<const u8*>(g_dsp.iram), DSP_IRAM_BYTE_SIZE, 0);
+
+  ClearBlocks();
+
+  CodeSet* victim = &m_code_sets[0];
+  CodeSet* match = nullptr;
+  for (CodeSet& set : m_code_sets)
+  {
+    if (!set.iram.empty() && set.iram_hash == hash &&
+        std::equal(set.iram.begin(), set.iram.end(), g_dsp.iram))
+    {
+      match = &set;
+      break;
+    }
+    if (set.last_used < victim->last_used)
+      victim = &set;
+  }
+
+  if (match)
+  {
+    INFO_LOG(DSPLLE, "Reusing compiled code for IRAM hash %016" PRIx64, hash);
+    RestoreCodeSet(*match);
+  }
+  else
+  {
+    match = victim;
+    ResetCodeSet(*match);
+    match->iram_hash = hash;
+    match->iram.assign(g_dsp.iram, g_dsp.iram + DSP_IRAM_SIZE);
+    SetCodePtr(match->code_start);
+  }
+
+  match->last_used = ++m_code_set_clock;
+  m_active_code_set = match;
+  g_dsp.reset_dspjit_codespace = false;
+}
 
+void DSPEmitter::ClearBlocks()
+{
   for (size_t i = 0; i < MAX_BLOCKS; i++)
   {
     m_blocks[i] = (DSPCompiledCode)m_stub_entry_point;
@@ -99,7 +161,53 @@ void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
     m_block_size[i] = 0;
     m_unresolved_jumps[i].clear();
   }
-  g_dsp.reset_dspjit_codespace = false;
+}
+
+void DSPEmitter::ResetCodeSet(CodeSet& set)
+{
+  set.iram_hash = 0;
+  set.iram.clear();
+  set.last_used = 0;
+  set.code_ptr = set.code_start;
+  set.blocks.clear();
+  set.block_links.clear();
+  set.block_size.clear();
+}
+
+void DSPEmitter::SaveCodeSet(CodeSet& set)
+{
+  set.code_ptr = GetWritableCodePtr();
+
+  set.blocks.clear();
+  set.block_links.clear();
+  set.block_size.clear();
+  for (const auto& range : CODE_RANGES)
+  {
+    const size_t end = range.first + range.second;
+    set.blocks.insert(set.blocks.end(), m_blocks.begin() + range.first, m_blocks.begin() + end);
+    set.block_links.insert(set.block_links.end(), m_block_links.begin() + range.first,
+                           m_block_links.begin() + end);
+    set.block_size.insert(set.block_size.end(), m_block_size.begin() + range.first,
+                          m_block_size.begin() + end);
+  }
+}
+
+void DSPEmitter::RestoreCodeSet(CodeSet& set)
+{
+  SetCodePtr(set.code_ptr);
+
+  if (set.blocks.empty())
+    return;
+
+  size_t offset = 0;
+  for (const auto& range : CODE_RANGES)
+  {
+    std::copy_n(set.blocks.begin() + offset, range.second, m_blocks.begin() + range.first);
+    std::copy_n(set.block_links.begin() + offset, range.second,
+                m_block_links.begin() + range.first);
+    std::copy_n(set.block_size.begin() + offset, range.second, m_block_size.begin() + range.first);
+    offset += range.second;
+  }
 }
 
 // Must go out of block if exception is detected
@@ -206,6 +314,17 @@ void DSPEmitter::EmitInstruction(UDSPInstruction inst)
 
 void DSPEmitter::Compile(u16 start_addr)
 {
+  if (static_cast<size_t>(m_active_code_set->code_end - GetCodePtr()) < CODE_SET_MARGIN)
+  {
+    // Out of space, so start this code set over. If it was already saved for a ucode that is
+    // being replaced, that copy is lost as well.
+    WARN_LOG(DSPLLE, "DSP JIT code set is full, clearing it");
+    if (g_dsp.reset_dspjit_codespace)
+      ResetCodeSet(*m_active_code_set);
+    ClearBlocks();
+    SetCodePtr(m_active_code_set->code_start);
+  }
+
   // Remember the current block address for later
   m_start_address = start_addr;
   m_unresolved_jumps[start_addr].clear();
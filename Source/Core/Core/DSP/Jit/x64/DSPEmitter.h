@@ -43,7 +43,7 @@ public:
 
   void EmitInstruction(UDSPInstruction inst);
   void ClearIRAM();
-  void ClearIRAMandDSPJITCodespaceReset();
+  void SwitchCodeSet();
 
   void CompileDispatcher();
   Block CompileStub();
@@ -210,6 +210,31 @@ public:
   std::array<std::list<u16>, MAX_BLOCKS> m_unresolved_jumps;
 
 private:
+  // Code compiled for one IRAM image. A few of these are kept around, each in its own slice
+  // of the code space, so that switching back to a recently used ucode needs no recompilation.
+  struct CodeSet
+  {
+    u64 iram_hash = 0;
+    std::vector<u16> iram;  // Empty if the set is unused
+    u64 last_used = 0;
+
+    u8* code_start = nullptr;
+    u8* code_end = nullptr;
+    u8* code_ptr = nullptr;
+
+    // Saved block tables for IRAM followed by IROM.
+    std::vector<DSPCompiledCode> blocks;
+    std::vector<Block> block_links;
+    std::vector<u16> block_size;
+  };
+
+  static constexpr size_t NUM_CODE_SETS = 4;
+
+  void ClearBlocks();
+  void ResetCodeSet(CodeSet& set);
+  void SaveCodeSet(CodeSet& set);
+  void RestoreCodeSet(CodeSet& set);
+
   void WriteBranchExit();
   void WriteBlockLink(u16 dest);
 
@@ -311,6 +336,10 @@ private:
 
   u16 m_cycles_left = 0;
 
+  std::array<CodeSet, NUM_CODE_SETS> m_code_sets;
+  CodeSet* m_active_code_set = nullptr;
+  u64 m_code_set_clock = 0;
+
   // The index of the last stored ext value (compile time).
   int m_store_index = -1;
   int m_store_index2 = -1;
@@ -5,20 +5,39 @@
 #include "Core/FifoPlayer/FifoDataFile.h"
 
 #include <algorithm>
+#include <cinttypes>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include <xxhash.h>
+#include <zlib.h>
+
 #include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
 
 enum
 {
   FILE_ID = 0x0d01f1f0,
-  VERSION_NUMBER = 4,
+  VERSION_NUMBER = 5,
   MIN_LOADER_VERSION = 1,
+  // Compressed payloads were added in version 5.
+  MIN_LOADER_VERSION_COMPRESSED = 5,
 };
 
+// Number of recorded frames that may be waiting for the stream thread before StreamFrame()
+// blocks. This is what bounds the memory used by long recordings.
+constexpr size_t MAX_QUEUED_STREAM_FRAMES = 8;
+
 #pragma pack(push, 1)
 
 struct FileHeader
@@ -68,9 +87,32 @@ static_assert(sizeof(FileMemoryUpdate) == 24, "FileMemoryUpdate should be 24 byt
 
 #pragma pack(pop)
 
+struct FifoDataFile::StreamState
+{
+  std::string filename;
+  File::IOFile file;
+  std::vector<FileFrameInfo> frames;
+
+  // Offsets of previously written memory update payloads, keyed by content hash and size.
+  // Payloads with the same key are only shared once their contents have been compared.
+  std::multimap<std::pair<u64, u32>, u64> payloads;
+  std::vector<u8> compare_buffer;
+  std::vector<u8> compress_buffer;
+
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable queue_changed;
+  std::deque<FifoFrameInfo> queue;
+  bool exiting = false;
+};
+
 FifoDataFile::FifoDataFile() = default;
 
-FifoDataFile::~FifoDataFile() = default;
+FifoDataFile::~FifoDataFile()
+{
+  if (m_stream)
+    EndStream();
+}
 
 bool FifoDataFile::ShouldGenerateFakeVIUpdates() const
 {
@@ -99,6 +141,13 @@ void FifoDataFile::AddFrame(const FifoFrameInfo& frameInfo)
 
 bool FifoDataFile::Save(const std::string& filename)
 {
+  // A streamed recording is already on disk and only needs to be copied. If it never reached its
+  // last frame, e.g. because emulation was stopped, it is finished with what was recorded so far.
+  if (m_stream && !EndStream())
+    return false;
+  if (!m_streamed_filename.empty())
+    return filename == m_streamed_filename || File::Copy(m_streamed_filename, filename);
+
   File::IOFile file;
   if (!file.Open(filename, "wb"))
     return false;
@@ -110,46 +159,18 @@ bool FifoDataFile::Save(const std::string& filename)
   u64 frameListOffset = file.Tell();
   PadFile(m_Frames.size() * sizeof(FileFrameInfo), file);
 
-  u64 bpMemOffset = file.Tell();
-  file.WriteArray(m_BPMem, BP_MEM_SIZE);
-
-  u64 cpMemOffset = file.Tell();
-  file.WriteArray(m_CPMem, CP_MEM_SIZE);
-
-  u64 xfMemOffset = file.Tell();
-  file.WriteArray(m_XFMem, XF_MEM_SIZE);
-
-  u64 xfRegsOffset = file.Tell();
-  file.WriteArray(m_XFRegs, XF_REGS_SIZE);
-
-  u64 texMemOffset = file.Tell();
-  file.WriteArray(m_TexMem, TEX_MEM_SIZE);
-
   // Write header
   FileHeader header;
   header.fileId = FILE_ID;
   header.file_version = VERSION_NUMBER;
   header.min_loader_version = MIN_LOADER_VERSION;
 
-  header.bpMemOffset = bpMemOffset;
-  header.bpMemSize = BP_MEM_SIZE;
-
-  header.cpMemOffset = cpMemOffset;
-  header.cpMemSize = CP_MEM_SIZE;
-
-  header.xfMemOffset = xfMemOffset;
-  header.xfMemSize = XF_MEM_SIZE;
-
-  header.xfRegsOffset = xfRegsOffset;
-  header.xfRegsSize = XF_REGS_SIZE;
-
-  header.texMemOffset = texMemOffset;
-  header.texMemSize = TEX_MEM_SIZE;
+  WriteVideoMemory(file, header);
 
   header.frameListOffset = frameListOffset;
   header.frameCount = (u32)m_Frames.size();
 
-  header.flags = m_Flags;
+  header.flags = m_Flags & ~FLAG_COMPRESSED;
 
   file.Seek(0, SEEK_SET);
   file.WriteBytes(&header, sizeof(FileHeader));
@@ -186,6 +207,225 @@ bool FifoDataFile::Save(const std::string& filename)
   return true;
 }
 
+void FifoDataFile::WriteVideoMemory(File::IOFile& file, FileHeader& header)
+{
+  header.bpMemOffset = file.Tell();
+  header.bpMemSize = BP_MEM_SIZE;
+  file.WriteArray(m_BPMem, BP_MEM_SIZE);
+
+  header.cpMemOffset = file.Tell();
+  header.cpMemSize = CP_MEM_SIZE;
+  file.WriteArray(m_CPMem, CP_MEM_SIZE);
+
+  header.xfMemOffset = file.Tell();
+  header.xfMemSize = XF_MEM_SIZE;
+  file.WriteArray(m_XFMem, XF_MEM_SIZE);
+
+  header.xfRegsOffset = file.Tell();
+  header.xfRegsSize = XF_REGS_SIZE;
+  file.WriteArray(m_XFRegs, XF_REGS_SIZE);
+
+  header.texMemOffset = file.Tell();
+  header.texMemSize = TEX_MEM_SIZE;
+  file.WriteArray(m_TexMem, TEX_MEM_SIZE);
+}
+
+bool FifoDataFile::BeginStream(const std::string& filename)
+{
+  // The file is read back to compare memory updates whose hashes match
+  auto stream = std::make_unique<StreamState>();
+  stream->filename = filename;
+  if (!stream->file.Open(filename, "w+b"))
+    return false;
+  m_streamed_filename.clear();
+  m_streamed_frames = 0;
+  m_streamed_fifo_bytes = 0;
+  m_streamed_memory_bytes = 0;
+
+  // Add space for header; everything else is appended as it arrives.
+  PadFile(sizeof(FileHeader), stream->file);
+
+  m_stream = std::move(stream);
+  m_stream->thread = std::thread(&FifoDataFile::StreamThread, this);
+  return true;
+}
+
+void FifoDataFile::StreamFrame(FifoFrameInfo&& frameInfo)
+{
+  m_streamed_frames++;
+  m_streamed_fifo_bytes += frameInfo.fifoData.size();
+  for (const MemoryUpdate& update : frameInfo.memoryUpdates)
+    m_streamed_memory_bytes += update.data.size();
+
+  std::unique_lock<std::mutex> lk(m_stream->mutex);
+  m_stream->queue_changed.wait(
+      lk, [this] { return m_stream->queue.size() < MAX_QUEUED_STREAM_FRAMES; });
+  m_stream->queue.push_back(std::move(frameInfo));
+  m_stream->queue_changed.notify_all();
+}
+
+u32 FifoDataFile::GetRecordedFrameCount() const
+{
+  return GetFrameCount() + m_streamed_frames;
+}
+
+u64 FifoDataFile::GetRecordedFifoBytes() const
+{
+  u64 bytes = m_streamed_fifo_bytes;
+  for (const FifoFrameInfo& frame : m_Frames)
+    bytes += frame.fifoData.size();
+  return bytes;
+}
+
+u64 FifoDataFile::GetRecordedMemoryBytes() const
+{
+  u64 bytes = m_streamed_memory_bytes;
+  for (const FifoFrameInfo& frame : m_Frames)
+  {
+    for (const MemoryUpdate& update : frame.memoryUpdates)
+      bytes += update.data.size();
+  }
+  return bytes;
+}
+
+void FifoDataFile::StreamThread()
+{
+  Common::SetCurrentThreadName("FIFO stream writer");
+
+  std::unique_lock<std::mutex> lk(m_stream->mutex);
+  while (true)
+  {
+    m_stream->queue_changed.wait(lk,
+                                 [this] { return m_stream->exiting || !m_stream->queue.empty(); });
+    if (m_stream->queue.empty())
+      return;
+
+    FifoFrameInfo frame = std::move(m_stream->queue.front());
+    m_stream->queue.pop_front();
+    m_stream->queue_changed.notify_all();
+
+    lk.unlock();
+    WriteStreamedFrame(frame);
+    lk.lock();
+  }
+}
+
+void FifoDataFile::WriteStreamedFrame(const FifoFrameInfo& frameInfo)
+{
+  File::IOFile& file = m_stream->file;
+
+  FileFrameInfo dstFrame = {};
+  dstFrame.fifoDataSize = static_cast<u32>(frameInfo.fifoData.size());
+  dstFrame.fifoDataOffset =
+      WriteCompressedPayload(frameInfo.fifoData.data(), dstFrame.fifoDataSize);
+  dstFrame.fifoStart = frameInfo.fifoStart;
+  dstFrame.fifoEnd = frameInfo.fifoEnd;
+  dstFrame.numMemoryUpdates = static_cast<u32>(frameInfo.memoryUpdates.size());
+
+  std::vector<FileMemoryUpdate> updates(frameInfo.memoryUpdates.size());
+  for (size_t i = 0; i < updates.size(); ++i)
+  {
+    const MemoryUpdate& srcUpdate = frameInfo.memoryUpdates[i];
+    const u32 size = static_cast<u32>(srcUpdate.data.size());
+
+    FileMemoryUpdate& dstUpdate = updates[i];
+    dstUpdate = {};
+    dstUpdate.address = srcUpdate.address;
+    dstUpdate.dataOffset = FindOrWritePayload(srcUpdate.data.data(), size);
+    dstUpdate.dataSize = size;
+    dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+    dstUpdate.type = srcUpdate.type;
+  }
+
+  dstFrame.memoryUpdatesOffset = file.Tell();
+  file.WriteArray(updates.data(), updates.size());
+
+  std::lock_guard<std::mutex> lk(m_stream->mutex);
+  m_stream->frames.push_back(dstFrame);
+}
+
+u64 FifoDataFile::FindOrWritePayload(const u8* data, u32 size)
+{
+  const auto key = std::make_pair(XXH64(data, size, 0), size);
+  const auto range = m_stream->payloads.equal_range(key);
+  if (range.first != range.second)
+  {
+    std::vector<u8>& buffer = m_stream->compare_buffer;
+    buffer.resize(size);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (ReadPayload(it->second, buffer.data(), size, m_stream->file, true) &&
+          std::memcmp(buffer.data(), data, size) == 0)
+      {
+        m_stream->file.Seek(0, SEEK_END);
+        return it->second;
+      }
+    }
+    m_stream->file.Seek(0, SEEK_END);
+  }
+
+  const u64 offset = WriteCompressedPayload(data, size);
+  m_stream->payloads.emplace(key, offset);
+  return offset;
+}
+
+u64 FifoDataFile::WriteCompressedPayload(const u8* data, u32 size)
+{
+  File::IOFile& file = m_stream->file;
+  std::vector<u8>& buffer = m_stream->compress_buffer;
+
+  uLongf compressed_size = compressBound(size);
+  buffer.resize(compressed_size);
+  if (compress2(buffer.data(), &compressed_size, data, size, Z_BEST_SPEED) != Z_OK)
+  {
+    ERROR_LOG(VIDEO, "FifoDataFile: failed to compress %u bytes", size);
+    compressed_size = 0;
+  }
+
+  const u64 offset = file.Tell();
+  const u32 stored_size = static_cast<u32>(compressed_size);
+  file.WriteBytes(&stored_size, sizeof(stored_size));
+  file.WriteBytes(buffer.data(), stored_size);
+  return offset;
+}
+
+bool FifoDataFile::EndStream()
+{
+  if (!m_stream)
+    return false;
+
+  {
+    std::lock_guard<std::mutex> lk(m_stream->mutex);
+    m_stream->exiting = true;
+    m_stream->queue_changed.notify_all();
+  }
+  m_stream->thread.join();
+
+  File::IOFile& file = m_stream->file;
+
+  FileHeader header;
+  header.fileId = FILE_ID;
+  header.file_version = VERSION_NUMBER;
+  header.min_loader_version = MIN_LOADER_VERSION_COMPRESSED;
+
+  WriteVideoMemory(file, header);
+
+  header.frameListOffset = file.Tell();
+  header.frameCount = static_cast<u32>(m_stream->frames.size());
+  file.WriteArray(m_stream->frames.data(), m_stream->frames.size());
+
+  header.flags = m_Flags | FLAG_COMPRESSED;
+
+  file.Seek(0, SEEK_SET);
+  file.WriteBytes(&header, sizeof(FileHeader));
+
+  const bool result = file.Close();
+  if (result)
+    m_streamed_filename = m_stream->filename;
+  m_stream.reset();
+  return result;
+}
+
 std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bool flagsOnly)
 {
   File::IOFile file;
@@ -238,6 +478,8 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
     file.ReadArray(dataFile->m_TexMem, size);
   }
 
+  const bool compressed = (header.flags & FLAG_COMPRESSED) != 0;
+
   // Read frames
   for (u32 i = 0; i < header.frameCount; ++i)
   {
@@ -251,11 +493,11 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
     dstFrame.fifoStart = srcFrame.fifoStart;
     dstFrame.fifoEnd = srcFrame.fifoEnd;
 
-    file.Seek(srcFrame.fifoDataOffset, SEEK_SET);
-    file.ReadBytes(dstFrame.fifoData.data(), srcFrame.fifoDataSize);
+    ReadPayload(srcFrame.fifoDataOffset, dstFrame.fifoData.data(), srcFrame.fifoDataSize, file,
+                compressed);
 
     ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates,
-                      dstFrame.memoryUpdates, file);
+                      dstFrame.memoryUpdates, file, compressed);
 
     dataFile->AddFrame(dstFrame);
   }
@@ -316,7 +558,8 @@ u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates
 }
 
 void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
-                                     std::vector<MemoryUpdate>& memUpdates, File::IOFile& file)
+                                     std::vector<MemoryUpdate>& memUpdates, File::IOFile& file,
+                                     bool compressed)
 {
   memUpdates.resize(numUpdates);
 
@@ -333,7 +576,32 @@ void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
     dstUpdate.data.resize(srcUpdate.dataSize);
     dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
 
-    file.Seek(srcUpdate.dataOffset, SEEK_SET);
-    file.ReadBytes(dstUpdate.data.data(), srcUpdate.dataSize);
+    ReadPayload(srcUpdate.dataOffset, dstUpdate.data.data(), srcUpdate.dataSize, file,
+                compressed);
+  }
+}
+
+bool FifoDataFile::ReadPayload(u64 fileOffset, u8* data, u32 size, File::IOFile& file,
+                               bool compressed)
+{
+  file.Seek(fileOffset, SEEK_SET);
+  if (!compressed)
+    return file.ReadBytes(data, size);
+
+  u32 compressed_size;
+  if (!file.ReadBytes(&compressed_size, sizeof(compressed_size)))
+    return false;
+
+  std::vector<u8> buffer(compressed_size);
+  if (!file.ReadBytes(buffer.data(), compressed_size))
+    return false;
+
+  uLongf uncompressed_size = size;
+  if (uncompress(data, &uncompressed_size, buffer.data(), compressed_size) != Z_OK ||
+      uncompressed_size != size)
+  {
+    ERROR_LOG(VIDEO, "FifoDataFile: corrupt compressed data at offset 0x%" PRIx64, fileOffset);
+    return false;
   }
+  return true;
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -15,6 +16,8 @@ namespace File
 class IOFile;
 }
 
+struct FileHeader;
+
 struct MemoryUpdate
 {
   enum Type
@@ -72,14 +75,34 @@ public:
   u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
   bool Save(const std::string& filename);
 
+  // Streaming output. Instead of being kept in memory, frames passed to StreamFrame() are
+  // compressed and appended to the file by a background thread, and memory updates with
+  // identical contents share their data. The register and texture memory snapshots are
+  // written by EndStream(), so they only need to be set before then. Save() copies the streamed
+  // file, ending the stream first if it is still open.
+  bool BeginStream(const std::string& filename);
+  void StreamFrame(FifoFrameInfo&& frameInfo);
+  bool EndStream();
+  bool IsStreaming() const { return m_stream != nullptr; }
+
+  // Totals over all recorded frames, including the ones which were streamed to disk
+  u32 GetRecordedFrameCount() const;
+  u64 GetRecordedFifoBytes() const;
+  u64 GetRecordedMemoryBytes() const;
+
   static std::unique_ptr<FifoDataFile> Load(const std::string& filename, bool flagsOnly);
 
 private:
   enum
   {
-    FLAG_IS_WII = 1
+    FLAG_IS_WII = 1,
+    // FIFO data and memory update payloads are zlib-compressed, each prefixed by its
+    // compressed size.
+    FLAG_COMPRESSED = 2,
   };
 
+  struct StreamState;
+
   void PadFile(size_t numBytes, File::IOFile& file);
 
   void SetFlag(u32 flag, bool set);
@@ -87,7 +110,16 @@ private:
 
   u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
   static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
-                                std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
+                                std::vector<MemoryUpdate>& memUpdates, File::IOFile& file,
+                                bool compressed);
+  static bool ReadPayload(u64 fileOffset, u8* data, u32 size, File::IOFile& file,
+                          bool compressed);
+
+  void StreamThread();
+  void WriteStreamedFrame(const FifoFrameInfo& frameInfo);
+  u64 FindOrWritePayload(const u8* data, u32 size);
+  u64 WriteCompressedPayload(const u8* data, u32 size);
+  void WriteVideoMemory(File::IOFile& file, FileHeader& header);
 
   u32 m_BPMem[BP_MEM_SIZE];
   u32 m_CPMem[CP_MEM_SIZE];
@@ -99,4 +131,11 @@ private:
   u32 m_Version = 0;
 
   std::vector<FifoFrameInfo> m_Frames;
+
+  std::unique_ptr<StreamState> m_stream;
+  // Path of the completed streamed recording
+  std::string m_streamed_filename;
+  std::atomic<u32> m_streamed_frames{0};
+  std::atomic<u64> m_streamed_fifo_bytes{0};
+  std::atomic<u64> m_streamed_memory_bytes{0};
 };
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <cstring>
 
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 #include "Core/ConfigManager.h"
@@ -18,14 +20,27 @@ static FifoRecorder instance;
 
 FifoRecorder::FifoRecorder() = default;
 
-void FifoRecorder::StartRecording(s32 numFrames, CallbackFunc finishedCb)
+void FifoRecorder::StartRecording(s32 numFrames, CallbackFunc finishedCb,
+                                  const std::string& stream_path)
 {
   std::lock_guard<std::recursive_mutex> lk(m_mutex);
 
   FifoAnalyzer::Init();
 
+  // The previous recording has to finish writing before its file can be reused
+  m_File.reset();
   m_File = std::make_unique<FifoDataFile>();
 
+  const std::string path = stream_path.empty() ?
+                               File::GetUserPath(D_DUMP_IDX) + "FifoRecording.dff" :
+                               stream_path;
+  File::CreateFullPath(path);
+  if (!m_File->BeginStream(path))
+  {
+    ERROR_LOG(VIDEO, "FifoRecorder: Failed to open %s for writing, recording to memory",
+              path.c_str());
+  }
+
   // TODO: This, ideally, would be deallocated when done recording.
   //       However, care needs to be taken since global state
   //       and multithreading don't play well nicely together.
@@ -100,9 +115,22 @@ void FifoRecorder::WriteGPCommand(const u8* data, u32 size)
     {
       std::lock_guard<std::recursive_mutex> lk(m_mutex);
 
-      // Copy frame to file
-      // The file will be responsible for freeing the memory allocated for each frame's fifoData
-      m_File->AddFrame(m_CurrentFrame);
+      if (m_File->IsStreaming())
+      {
+        // Hand the frame over to the file's writer thread
+        m_File->StreamFrame(std::move(m_CurrentFrame));
+        m_CurrentFrame = {};
+
+        // This was the last frame, so flush everything to disk
+        if (m_RequestedRecordingEnd && !m_IsRecording)
+          m_File->EndStream();
+      }
+      else
+      {
+        // Copy frame to file
+        // The file will be responsible for freeing the memory allocated for each frame's fifoData
+        m_File->AddFrame(m_CurrentFrame);
+      }
 
       if (m_FinishedCb && m_RequestedRecordingEnd)
         m_FinishedCb();
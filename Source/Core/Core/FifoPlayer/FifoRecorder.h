@@ -7,6 +7,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "Core/FifoPlayer/FifoDataFile.h"
@@ -18,7 +19,11 @@ public:
 
   FifoRecorder();
 
-  void StartRecording(s32 numFrames, CallbackFunc finishedCb);
+  // Frames are written to stream_path as they are recorded instead of being kept in memory, and
+  // the recorded file only holds the video memory snapshot. By default, the recording goes to
+  // Dump/FifoRecording.dff, which saving the recorded file copies.
+  void StartRecording(s32 numFrames, CallbackFunc finishedCb,
+                      const std::string& stream_path = "");
   void StopRecording();
 
   bool IsRecordingDone() const;
@@ -286,12 +286,19 @@ public:
   }
 
   void DoState(PointerWrap& p);
+  void MarkBlockDirty(int index);
   DEntry m_gci_header;
   std::vector<GCMBlock> m_save_data;
   std::vector<u16> m_used_blocks;
   int UsesBlock(u16 blocknum);
   bool m_dirty;
   std::string m_filename;
+
+  // Blocks of m_save_data modified since the file was last written. These are only used when the
+  // file on disk otherwise matches m_save_data; if m_needs_full_write is set the whole file is
+  // rewritten instead.
+  std::vector<bool> m_dirty_blocks;
+  bool m_needs_full_write = true;
 };
 
 class GCMemcard
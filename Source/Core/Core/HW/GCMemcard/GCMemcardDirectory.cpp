@@ -111,6 +111,10 @@ int GCMemcardDirectory::LoadGCI(const std::string& file_name, bool current_game_
       GCMemcard::PSO_MakeSaveGameValid(m_hdr, gci.m_gci_header, gci.m_save_data);
       GCMemcard::FZEROGX_MakeSaveGameValid(m_hdr, gci.m_gci_header, gci.m_save_data);
     }
+    else
+    {
+      gci.m_needs_full_write = false;
+    }
     int idx = (int)m_saves.size();
     m_dir1.Replace(gci.m_gci_header, idx);
     m_saves.push_back(std::move(gci));
@@ -404,12 +408,15 @@ inline void GCMemcardDirectory::SyncSaves()
           PanicAlertT("Game overwrote with another games save. Data corruption ahead 0x%x, 0x%x",
                       BE32(m_saves[i].m_gci_header.Gamecode), BE32(current->Dir[i].Gamecode));
         }
+        if (BE16(m_saves[i].m_gci_header.BlockCount) != BE16(current->Dir[i].BlockCount))
+          m_saves[i].m_needs_full_write = true;
         memcpy((u8*)&(m_saves[i].m_gci_header), (u8*)&(current->Dir[i]), DENTRY_SIZE);
         if (old_start != new_start)
         {
           INFO_LOG(EXPANSIONINTERFACE, "Save moved from 0x%x to 0x%x", old_start, new_start);
           m_saves[i].m_used_blocks.clear();
           m_saves[i].m_save_data.clear();
+          m_saves[i].m_needs_full_write = true;
         }
         if (m_saves[i].m_used_blocks.size() == 0)
         {
@@ -455,6 +462,7 @@ inline s32 GCMemcardDirectory::SaveAreaRW(u32 block, bool writing)
         if (writing)
         {
           m_saves[i].m_dirty = true;
+          m_saves[i].MarkBlockDirty(idx);
         }
 
         m_last_block = block;
@@ -521,18 +529,32 @@ bool GCMemcardDirectory::SetUsedBlocks(int save_index)
 }
 
 void GCMemcardDirectory::FlushToFile()
+{
+  CommitJournal(BuildJournal());
+
+#if _WRITE_MC_HEADER
+  std::unique_lock<std::mutex> l(m_write_mutex);
+  u8 mc[BLOCK_SIZE * MC_FST_BLOCKS];
+  Read(0, BLOCK_SIZE * MC_FST_BLOCKS, mc);
+  File::IOFile hdrfile(m_save_directory + MC_HDR, "wb");
+  hdrfile.WriteBytes(mc, BLOCK_SIZE * MC_FST_BLOCKS);
+#endif
+}
+
+std::vector<GCMemcardDirectory::JournalEntry> GCMemcardDirectory::BuildJournal()
 {
   std::unique_lock<std::mutex> l(m_write_mutex);
-  int errors = 0;
-  DEntry invalid;
+  std::vector<JournalEntry> journal;
   for (u16 i = 0; i < m_saves.size(); ++i)
   {
-    if (m_saves[i].m_dirty)
+    GCIFile& save = m_saves[i];
+    bool journaled = false;
+    if (save.m_dirty)
     {
-      if (BE32(m_saves[i].m_gci_header.Gamecode) != 0xFFFFFFFF)
+      if (BE32(save.m_gci_header.Gamecode) != 0xFFFFFFFF)
       {
-        m_saves[i].m_dirty = false;
-        if (m_saves[i].m_save_data.size() == 0)
+        save.m_dirty = false;
+        if (save.m_save_data.size() == 0)
         {
           // The save's header has been changed but the actual save blocks haven't been read/written
           // to
@@ -541,9 +563,9 @@ void GCMemcardDirectory::FlushToFile()
                     "GCI header modified without corresponding save data changes");
           continue;
         }
-        if (m_saves[i].m_filename.empty())
+        if (save.m_filename.empty())
         {
-          std::string default_save_name = m_save_directory + m_saves[i].m_gci_header.GCI_FileName();
+          std::string default_save_name = m_save_directory + save.m_gci_header.GCI_FileName();
 
           // Check to see if another file is using the same name
           // This seems unlikely except in the case of file corruption
@@ -555,41 +577,45 @@ void GCMemcardDirectory::FlushToFile()
           if (File::Exists(default_save_name))
             PanicAlertT("Failed to find new filename.\n%s\n will be overwritten",
                         default_save_name.c_str());
-          m_saves[i].m_filename = default_save_name;
+          save.m_filename = default_save_name;
+          save.m_needs_full_write = true;
         }
-        File::IOFile gci(m_saves[i].m_filename, "wb");
-        if (gci)
-        {
-          gci.WriteBytes(&m_saves[i].m_gci_header, DENTRY_SIZE);
-          gci.WriteBytes(m_saves[i].m_save_data.data(), BLOCK_SIZE * m_saves[i].m_save_data.size());
 
-          if (gci.IsGood())
-          {
-            Core::DisplayMessage(
-                StringFromFormat("Wrote save contents to %s", m_saves[i].m_filename.c_str()), 4000);
-          }
-          else
+        JournalEntry entry;
+        entry.filename = save.m_filename;
+        entry.header = save.m_gci_header;
+        entry.full_write = save.m_needs_full_write;
+        if (entry.full_write)
+        {
+          entry.blocks = save.m_save_data;
+        }
+        else
+        {
+          for (u16 j = 0; j < save.m_dirty_blocks.size() && j < save.m_save_data.size(); ++j)
           {
-            ++errors;
-            Core::DisplayMessage(StringFromFormat("Failed to write save contents to %s",
-                                                  m_saves[i].m_filename.c_str()),
-                                 4000);
-            ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s",
-                      m_saves[i].m_filename.c_str());
+            if (!save.m_dirty_blocks[j])
+              continue;
+            entry.block_indices.push_back(j);
+            entry.blocks.push_back(save.m_save_data[j]);
           }
         }
+        save.m_dirty_blocks.clear();
+        save.m_needs_full_write = false;
+        journal.push_back(std::move(entry));
+        journaled = true;
       }
-      else if (m_saves[i].m_filename.length() != 0)
+      else if (save.m_filename.length() != 0)
       {
-        m_saves[i].m_dirty = false;
-        std::string& old_name = m_saves[i].m_filename;
-        std::string deleted_name = old_name + ".deleted";
-        if (File::Exists(deleted_name))
-          File::Delete(deleted_name);
-        File::Rename(old_name, deleted_name);
-        m_saves[i].m_filename.clear();
-        m_saves[i].m_save_data.clear();
-        m_saves[i].m_used_blocks.clear();
+        save.m_dirty = false;
+        JournalEntry entry;
+        entry.filename = std::move(save.m_filename);
+        entry.remove = true;
+        journal.push_back(std::move(entry));
+        save.m_filename.clear();
+        save.m_save_data.clear();
+        save.m_used_blocks.clear();
+        save.m_dirty_blocks.clear();
+        save.m_needs_full_write = true;
       }
     }
 
@@ -598,20 +624,129 @@ void GCMemcardDirectory::FlushToFile()
     // simultaneously
     // this ensures that the save data for all of the current games gci files are stored in the
     // savestate
-    u32 gamecode = BE32(m_saves[i].m_gci_header.Gamecode);
-    if (gamecode != m_game_id && gamecode != 0xFFFFFFFF && m_saves[i].m_save_data.size())
+    u32 gamecode = BE32(save.m_gci_header.Gamecode);
+    if (gamecode != m_game_id && gamecode != 0xFFFFFFFF && save.m_save_data.size())
     {
-      INFO_LOG(EXPANSIONINTERFACE, "Flushing savedata to disk for %s",
-               m_saves[i].m_filename.c_str());
-      m_saves[i].m_save_data.clear();
+      // While the file is being written the blocks on disk can't be read back, and they are
+      // needed again if the write fails, so they stay loaded until CommitJournal is done.
+      if (journaled)
+      {
+        journal.back().unload = true;
+      }
+      else
+      {
+        INFO_LOG(EXPANSIONINTERFACE, "Flushing savedata to disk for %s", save.m_filename.c_str());
+        save.m_save_data.clear();
+        m_last_block = -1;
+      }
     }
   }
-#if _WRITE_MC_HEADER
-  u8 mc[BLOCK_SIZE * MC_FST_BLOCKS];
-  Read(0, BLOCK_SIZE * MC_FST_BLOCKS, mc);
-  File::IOFile hdrfile(m_save_directory + MC_HDR, "wb");
-  hdrfile.WriteBytes(mc, BLOCK_SIZE * MC_FST_BLOCKS);
-#endif
+  return journal;
+}
+
+void GCMemcardDirectory::CommitJournal(const std::vector<JournalEntry>& journal)
+{
+  // Files stay open until every entry has been written so that they can be synced in one batch.
+  std::vector<std::pair<const JournalEntry*, File::IOFile>> written;
+  for (const JournalEntry& entry : journal)
+  {
+    if (entry.remove)
+    {
+      std::string deleted_name = entry.filename + ".deleted";
+      if (File::Exists(deleted_name))
+        File::Delete(deleted_name);
+      File::Rename(entry.filename, deleted_name);
+      continue;
+    }
+
+    File::IOFile gci(entry.filename, entry.full_write ? "wb" : "r+b");
+    if (!gci)
+    {
+      // Either way the save stays dirty, so that all of it is written on the next flush.
+      if (!entry.full_write)
+      {
+        // The file went away behind our back
+        WARN_LOG(EXPANSIONINTERFACE, "Failed to open %s for update, scheduling a full write",
+                 entry.filename.c_str());
+      }
+      else
+      {
+        ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s", entry.filename.c_str());
+      }
+      RequestFullWrite(entry.filename);
+      continue;
+    }
+
+    gci.WriteBytes(&entry.header, DENTRY_SIZE);
+    if (entry.full_write)
+    {
+      gci.WriteBytes(entry.blocks.data(), BLOCK_SIZE * entry.blocks.size());
+    }
+    else
+    {
+      for (size_t i = 0; i < entry.blocks.size(); ++i)
+      {
+        gci.Seek(DENTRY_SIZE + static_cast<s64>(entry.block_indices[i]) * BLOCK_SIZE, SEEK_SET);
+        gci.WriteBytes(&entry.blocks[i], BLOCK_SIZE);
+      }
+    }
+    written.emplace_back(&entry, std::move(gci));
+  }
+
+  std::vector<std::string> unload;
+  for (auto& file : written)
+  {
+    const std::string& filename = file.first->filename;
+    if (file.second.Sync())
+    {
+      Core::DisplayMessage(StringFromFormat("Wrote save contents to %s", filename.c_str()), 4000);
+      if (file.first->unload)
+        unload.push_back(filename);
+    }
+    else
+    {
+      Core::DisplayMessage(StringFromFormat("Failed to write save contents to %s",
+                                            filename.c_str()),
+                           4000);
+      ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s", filename.c_str());
+      RequestFullWrite(filename);
+    }
+  }
+
+  if (!unload.empty())
+    UnloadSaves(unload);
+}
+
+void GCMemcardDirectory::RequestFullWrite(const std::string& filename)
+{
+  std::unique_lock<std::mutex> l(m_write_mutex);
+  for (GCIFile& save : m_saves)
+  {
+    if (save.m_filename == filename && BE32(save.m_gci_header.Gamecode) != 0xFFFFFFFF)
+    {
+      save.m_dirty = true;
+      save.m_needs_full_write = true;
+    }
+  }
+}
+
+void GCMemcardDirectory::UnloadSaves(const std::vector<std::string>& filenames)
+{
+  std::unique_lock<std::mutex> l(m_write_mutex);
+  for (GCIFile& save : m_saves)
+  {
+    // Saves modified again since the journal was built still need their blocks
+    u32 gamecode = BE32(save.m_gci_header.Gamecode);
+    if (save.m_dirty || gamecode == m_game_id || gamecode == 0xFFFFFFFF ||
+        std::find(filenames.begin(), filenames.end(), save.m_filename) == filenames.end())
+    {
+      continue;
+    }
+
+    INFO_LOG(EXPANSIONINTERFACE, "Flushing savedata to disk for %s", save.m_filename.c_str());
+    save.m_save_data.clear();
+    m_last_block = -1;
+  }
 }
 
 void GCMemcardDirectory::DoState(PointerWrap& p)
@@ -632,6 +767,17 @@ void GCMemcardDirectory::DoState(PointerWrap& p)
   {
     itr->DoState(p);
   }
+
+  if (p.GetMode() == PointerWrap::MODE_READ)
+  {
+    // Block-level dirty state isn't part of the savestate, so whatever was loaded has to be
+    // written out in full.
+    for (GCIFile& save : m_saves)
+    {
+      save.m_dirty_blocks.clear();
+      save.m_needs_full_write = true;
+    }
+  }
 }
 
 bool GCIFile::LoadSaveBlocks()
@@ -669,6 +815,13 @@ int GCIFile::UsesBlock(u16 block_num)
   return -1;
 }
 
+void GCIFile::MarkBlockDirty(int index)
+{
+  if (m_dirty_blocks.size() <= static_cast<size_t>(index))
+    m_dirty_blocks.resize(index + 1, false);
+  m_dirty_blocks[index] = true;
+}
+
 void GCIFile::DoState(PointerWrap& p)
 {
   p.DoPOD<DEntry>(m_gci_header);
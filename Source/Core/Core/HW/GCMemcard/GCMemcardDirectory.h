@@ -37,6 +37,26 @@ public:
   void DoState(PointerWrap& p) override;
 
 private:
+  // A snapshot of the pending changes to a single GCI file. The journal is built while holding
+  // m_write_mutex and written out afterwards, so emulated writes and savestates never wait on
+  // disk I/O.
+  struct JournalEntry
+  {
+    std::string filename;
+    bool remove = false;
+    bool full_write = false;
+    // The save belongs to another game, so its blocks are dropped from memory once written.
+    bool unload = false;
+    DEntry header;
+    std::vector<u16> block_indices;
+    std::vector<GCMBlock> blocks;
+  };
+
+  std::vector<JournalEntry> BuildJournal();
+  void CommitJournal(const std::vector<JournalEntry>& journal);
+  void RequestFullWrite(const std::string& filename);
+  void UnloadSaves(const std::vector<std::string>& filenames);
+
   int LoadGCI(const std::string& file_name, bool current_game_only);
   inline s32 SaveAreaRW(u32 block, bool writing = false);
   // s32 DirectoryRead(u32 offset, u32 length, u8* dest_address);
@@ -72,6 +72,8 @@ public:
   void WriteExitDestInRSCRATCH(bool bl = false, u32 after = 0);
   void WriteBLRExit();
   void WriteExceptionExit();
+  // Skips ahead to the next event, then continues at destination.
+  void WriteIdleExit(u32 destination);
   void WriteExternalExceptionExit();
   void WriteRfiExitDestInRSCRATCH();
   bool Cleanup();
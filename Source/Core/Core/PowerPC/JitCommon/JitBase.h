@@ -125,6 +125,8 @@ public:
 
   virtual bool HandleFault(uintptr_t access_address, SContext* ctx) = 0;
   virtual bool HandleStackFault() { return false; }
+
+  const std::set<u32>& GetIdleLoops() const { return analyzer.GetIdleLoops(); }
 };
 
 void JitTrampoline(JitBase& jit, u32 em_address);
@@ -19,6 +19,7 @@
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 
 #include "Core/Core.h"
@@ -101,6 +102,25 @@ void WriteProfileResults(const std::string& filename)
   }
 }
 
+void WriteIdleLoopReport(const std::string& filename)
+{
+  if (!g_jit)
+    return;
+
+  File::IOFile f(filename, "w");
+  if (!f)
+  {
+    ERROR_LOG(DYNA_REC, "Failed to open %s", filename.c_str());
+    return;
+  }
+  fprintf(f.GetHandle(), "loopAddr\tfunction\n");
+  for (u32 address : g_jit->GetIdleLoops())
+  {
+    std::string name = g_symbolDB.GetDescription(address);
+    fprintf(f.GetHandle(), "%08x\t%s\n", address, name.c_str());
+  }
+}
+
 void GetProfileResults(ProfileStats* prof_stats)
 {
   // Can't really do this with no g_jit core available
@@ -30,6 +30,7 @@ CPUCoreBase* GetCore();
 // Debugging
 void WriteProfileResults(const std::string& filename);
 void GetProfileResults(ProfileStats* prof_stats);
+void WriteIdleLoopReport(const std::string& filename);
 int GetHostCode(u32* address, const u8** code, u32* code_size);
 
 // Memory Utilities
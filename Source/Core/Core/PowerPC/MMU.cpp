@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cstddef>
 #include <cstring>
 #include <string>
@@ -163,6 +164,114 @@ static void EFB_Write(u32 data, u32 addr)
 BatTable ibat_table;
 BatTable dbat_table;
 
+// Software TLB
+//
+// A small direct-mapped cache of effective page -> host pointer translations for pages that are
+// backed by plain memory (RAM, EXRAM, locked L1 and fake VMEM). When fastmem isn't available
+// (interpreter, slow-path accesses from the JITs, MMU titles), this lets ReadFromHardware and
+// WriteToHardware skip TranslateAddress and the region checks for the common case.
+//
+// Entries are only filled by accesses that can raise exceptions, and a page table translated
+// entry is only kept for as long as the matching entry in ppcState.tlb, so a hit never skips
+// anything TranslatePageAddress would have done except the LRU update (which is replayed).
+// Writes use their own table, since the first write to a page has to go through the C bit update.
+constexpr u32 SOFT_TLB_BITS = 8;
+constexpr u32 SOFT_TLB_SIZE = 1 << SOFT_TLB_BITS;
+constexpr u32 SOFT_TLB_MASK = SOFT_TLB_SIZE - 1;
+
+struct SoftTLBEntry
+{
+  static constexpr u32 INVALID_TAG = 0xffffffff;
+
+  u32 tag = INVALID_TAG;
+  // Way of ppcState.tlb[0] backing this entry, or -1 if it was translated by a BAT.
+  s32 tlb_way = -1;
+  u8* host_page = nullptr;
+};
+
+using SoftTLB = std::array<SoftTLBEntry, SOFT_TLB_SIZE>;
+static std::array<SoftTLB, 2> s_soft_tlb;
+
+static void InvalidateSoftTLB()
+{
+  for (SoftTLB& table : s_soft_tlb)
+    table.fill({});
+}
+
+static void InvalidateSoftTLBTag(u32 tag)
+{
+  for (SoftTLB& table : s_soft_tlb)
+  {
+    SoftTLBEntry& entry = table[tag & SOFT_TLB_MASK];
+    if (entry.tag == tag)
+      entry = {};
+  }
+}
+
+template <bool write>
+static inline u8* LookupSoftTLB(u32 em_address, size_t size)
+{
+  const u32 tag = em_address >> HW_PAGE_INDEX_SHIFT;
+  const u32 offset = em_address & (HW_PAGE_SIZE - 1);
+  const SoftTLBEntry& entry = s_soft_tlb[write][tag & SOFT_TLB_MASK];
+  if (entry.tag != tag || offset > HW_PAGE_SIZE - size)
+    return nullptr;
+
+  if (entry.tlb_way >= 0)
+    ppcState.tlb[0][tag & HW_PAGE_INDEX_MASK].recent = static_cast<u8>(entry.tlb_way);
+
+  return entry.host_page + offset;
+}
+
+// Returns the host pointer backing the given physical page, or nullptr if it isn't plain memory.
+// This must agree with the region checks in ReadFromHardware and WriteToHardware.
+static u8* GetHostPage(u32 physical_page)
+{
+  if ((physical_page & 0xF8000000) == 0x00000000)
+    return &Memory::m_pRAM[physical_page & Memory::RAM_MASK];
+
+  if (Memory::m_pEXRAM && (physical_page >> 28) == 0x1 &&
+      (physical_page & 0x0FFFFFFF) < Memory::EXRAM_SIZE)
+  {
+    return &Memory::m_pEXRAM[physical_page & 0x0FFFFFFF];
+  }
+
+  if ((physical_page >> 28) == 0xE && (physical_page < (0xE0000000 + Memory::L1_CACHE_SIZE)))
+    return &Memory::m_pL1Cache[physical_page & 0x0FFFFFFF];
+
+  if (Memory::m_pFakeVMEM && ((physical_page & 0xFE000000) == 0x7E000000))
+    return &Memory::m_pFakeVMEM[physical_page & Memory::RAM_MASK];
+
+  return nullptr;
+}
+
+template <bool write>
+static void FillSoftTLB(u32 em_address, const TranslateAddressResult& translated_addr)
+{
+  const u32 tag = em_address >> HW_PAGE_INDEX_SHIFT;
+
+  s32 tlb_way = -1;
+  if (translated_addr.result == TranslateAddressResult::PAGE_TABLE_TRANSLATED)
+  {
+    const TLBEntry& tlbe = ppcState.tlb[0][tag & HW_PAGE_INDEX_MASK];
+    if (tlbe.tag[0] == tag)
+      tlb_way = 0;
+    else if (tlbe.tag[1] == tag)
+      tlb_way = 1;
+    else
+      return;
+  }
+
+  u8* host_page = GetHostPage(translated_addr.address & ~(HW_PAGE_SIZE - 1));
+  if (!host_page)
+    return;
+
+  SoftTLBEntry& entry = s_soft_tlb[write][tag & SOFT_TLB_MASK];
+  entry.tag = tag;
+  entry.tlb_way = tlb_way;
+  entry.host_page = host_page;
+}
+
 static void GenerateDSIException(u32 _EffectiveAddress, bool _bWrite);
 
 template <XCheckTLBFlag flag, typename T, bool never_translate = false>
@@ -170,6 +279,16 @@ static T ReadFromHardware(u32 em_address)
 {
   if (!never_translate && UReg_MSR(MSR).DR)
   {
+    if (flag == XCheckTLBFlag::Read)
+    {
+      if (const u8* host_ptr = LookupSoftTLB<false>(em_address, sizeof(T)))
+      {
+        T value;
+        std::memcpy(&value, host_ptr, sizeof(T));
+        return bswap(value);
+      }
+    }
+
     auto translated_addr = TranslateAddress<flag>(em_address);
     if (!translated_addr.Success())
     {
@@ -177,6 +296,8 @@ static T ReadFromHardware(u32 em_address)
         GenerateDSIException(em_address, false);
       return 0;
     }
+    if (flag == XCheckTLBFlag::Read)
+      FillSoftTLB<false>(em_address, translated_addr);
     if ((em_address & (HW_PAGE_SIZE - 1)) > HW_PAGE_SIZE - sizeof(T))
     {
       // This could be unaligned down to the byte level... hopefully this is rare, so doing it this
@@ -258,6 +379,16 @@ static void WriteToHardware(u32 em_address, const T data)
 {
   if (!never_translate && UReg_MSR(MSR).DR)
   {
+    if (flag == XCheckTLBFlag::Write)
+    {
+      if (u8* host_ptr = LookupSoftTLB<true>(em_address, sizeof(T)))
+      {
+        const T swapped_data = bswap(data);
+        std::memcpy(host_ptr, &swapped_data, sizeof(T));
+        return;
+      }
+    }
+
     auto translated_addr = TranslateAddress<flag>(em_address);
     if (!translated_addr.Success())
     {
@@ -265,6 +396,8 @@ static void WriteToHardware(u32 em_address, const T data)
         GenerateDSIException(em_address, true);
       return;
     }
+    if (flag == XCheckTLBFlag::Write)
+      FillSoftTLB<true>(em_address, translated_addr);
     if ((em_address & (sizeof(T) - 1)) &&
         (em_address & (HW_PAGE_SIZE - 1)) > HW_PAGE_SIZE - sizeof(T))
     {
@@ -959,6 +1092,12 @@ void SDRUpdated()
   }
   PowerPC::ppcState.pagetable_base = htaborg << 16;
   PowerPC::ppcState.pagetable_hashmask = ((htabmask << 10) | 0x3ff);
+  InvalidateSoftTLB();
+}
+
+void SRUpdated()
+{
+  InvalidateSoftTLB();
 }
 
 enum class TLBLookupResult
@@ -1028,6 +1167,8 @@ static void UpdateTLBEntry(const XCheckTLBFlag flag, UPTE2 PTE2, const u32 addre
   const int tag = address >> HW_PAGE_INDEX_SHIFT;
   TLBEntry& tlbe = ppcState.tlb[IsOpcodeFlag(flag)][tag & HW_PAGE_INDEX_MASK];
   const int index = tlbe.recent == 0 && tlbe.tag[0] != TLBEntry::INVALID_TAG;
+  if (tlbe.tag[index] != TLBEntry::INVALID_TAG)
+    InvalidateSoftTLBTag(tlbe.tag[index]);
   tlbe.recent = index;
   tlbe.paddr[index] = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
   tlbe.pte[index] = PTE2.Hex;
@@ -1045,6 +1186,13 @@ void InvalidateTLBEntry(u32 address)
   TLBEntry& tlbe_i = ppcState.tlb[1][entry_index];
   tlbe_i.tag[0] = TLBEntry::INVALID_TAG;
   tlbe_i.tag[1] = TLBEntry::INVALID_TAG;
+
+  // tlbie invalidates the whole congruence class, so drop every software TLB slot that maps to it.
+  for (u32 i = entry_index; i < SOFT_TLB_SIZE; i += HW_PAGE_INDEX_MASK + 1)
+  {
+    for (SoftTLB& table : s_soft_tlb)
+      table[i] = {};
+  }
 }
 
 // Page Address Translation
@@ -1233,6 +1381,7 @@ static void UpdateFakeMMUBat(BatTable& bat_table, u32 start_addr)
 void DBATUpdated()
 {
   dbat_table = {};
+  InvalidateSoftTLB();
   UpdateBATs(dbat_table, SPR_DBAT0U);
   bool extended_bats = SConfig::GetInstance().bWii && HID4.SBE;
   if (extended_bats)
@@ -41,6 +41,9 @@ constexpr u32 BRANCH_FOLLOWING_THRESHOLD = 2;
 
 constexpr u32 INVALID_BRANCH_TARGET = 0xFFFFFFFF;
 
+// Longest loop body (including the branch) that is considered for idle skipping.
+constexpr u32 MAX_IDLE_LOOP_INSTRUCTIONS = 16;
+
 CodeBuffer::CodeBuffer(int size)
 {
   codebuffer = new PPCAnalyst::CodeOp[size];
@@ -542,6 +545,38 @@ void PPCAnalyzer::ReorderInstructions(u32 instructions, CodeOp* code)
     ReorderInstructionsCore(instructions, code, false, REORDER_CMP);
 }
 
+// Checks whether code[0..branch_index] is a loop that, once it has run a single time, would do the
+// same thing on every further iteration until an external event (an interrupt, or some hardware
+// or another thread writing to memory) changes the value it is waiting on. Such a loop can skip
+// ahead to the next scheduled event instead of spinning.
+bool PPCAnalyzer::IsBusyWaitLoop(const CodeOp* code, u32 branch_index) const
+{
+  if (branch_index + 1 > MAX_IDLE_LOOP_INSTRUCTIONS)
+    return false;
+
+  // Registers that are read before the loop writes them. If the loop overwrites one of those
+  // later on, every iteration starts from a different state, so it isn't just polling.
+  BitSet32 loop_inputs;
+  BitSet32 written;
+  for (u32 i = 0; i < branch_index; ++i)
+  {
+    const GekkoOPInfo* opinfo = code[i].opinfo;
+
+    // Only plain integer arithmetic and loads; anything else may have side effects.
+    if (opinfo->type != OpType::Integer && opinfo->type != OpType::Load)
+      return false;
+    if (opinfo->flags & (FL_EVIL | FL_READ_CA | FL_ENDBLOCK))
+      return false;
+
+    loop_inputs |= code[i].regsIn & ~written;
+    if (code[i].regsOut & loop_inputs)
+      return false;
+    written |= code[i].regsOut;
+  }
+
+  return true;
+}
+
 void PPCAnalyzer::SetInstructionStats(CodeBlock* block, CodeOp* code, const GekkoOPInfo* opinfo,
                                       u32 index)
 {
@@ -739,6 +774,14 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
 
     SetInstructionStats(block, &code[i], opinfo, i);
 
+    if (!inst.LK && (inst.OPCD == 18 || (inst.OPCD == 16 && (inst.BO & BO_DONT_DECREMENT_FLAG))) &&
+        EvaluateBranchTarget(inst, address) == block->m_address && IsBusyWaitLoop(code, i))
+    {
+      code[i].branchIsIdleLoop = true;
+      if (m_idle_loops.insert(block->m_address).second)
+        INFO_LOG(DYNA_REC, "Idle loop detected at %08x (%u instructions)", block->m_address, i + 1);
+    }
+
     bool follow = false;
     u32 destination = 0;
 
@@ -748,7 +791,9 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
     //       If it is small, the performance will be down.
     //       If it is big, the size of generated code will be big and
     //       cache clearning will happen many times.
-    if (HasOption(OPTION_BRANCH_FOLLOW) && numFollows < BRANCH_FOLLOWING_THRESHOLD)
+    // Idle loops must stay the last instruction of the block, so never follow them.
+    if (HasOption(OPTION_BRANCH_FOLLOW) && numFollows < BRANCH_FOLLOWING_THRESHOLD &&
+        !code[i].branchIsIdleLoop)
     {
       if (inst.OPCD == 18 && blockSize > 1)
       {
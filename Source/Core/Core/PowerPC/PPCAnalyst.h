@@ -44,6 +44,8 @@ struct CodeOp  // 16B
   bool canEndBlock;
   bool skipLRStack;
   bool skip;  // followed BL-s for example
+  // branch back to the start of the block, which only polls memory without side effects
+  bool branchIsIdleLoop;
   // which registers are still needed after this instruction in this block
   BitSet32 fprInUse;
   BitSet32 gprInUse;
@@ -177,10 +179,14 @@ private:
   void ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse, ReorderType type);
   void ReorderInstructions(u32 instructions, CodeOp* code);
   void SetInstructionStats(CodeBlock* block, CodeOp* code, const GekkoOPInfo* opinfo, u32 index);
+  bool IsBusyWaitLoop(const CodeOp* code, u32 branch_index) const;
 
   // Options
   u32 m_options;
 
+  // Start addresses of all idle loops found so far
+  std::set<u32> m_idle_loops;
+
 public:
   enum AnalystOption
   {
@@ -226,6 +232,8 @@ public:
   void ClearOption(AnalystOption option) { m_options &= ~(option); }
   bool HasOption(AnalystOption option) const { return !!(m_options & option); }
   u32 Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32 blockSize);
+
+  const std::set<u32>& GetIdleLoops() const { return m_idle_loops; }
 };
 
 void LogFunctionCall(u32 addr);
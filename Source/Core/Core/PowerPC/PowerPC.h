@@ -277,6 +277,7 @@ void ClearCacheLine(u32 address);  // Zeroes 32 bytes; address should be 32-byte
 
 // TLB functions
 void SDRUpdated();
+void SRUpdated();
 void InvalidateTLBEntry(u32 address);
 void DBATUpdated();
 void IBATUpdated();
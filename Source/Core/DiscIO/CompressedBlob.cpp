@@ -8,6 +8,8 @@
 #endif
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
@@ -24,6 +26,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/TaskScheduler.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DiscScrubber.h"
@@ -87,23 +90,31 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
 
 bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 {
-  bool uncompressed = false;
+  u32 comp_block_size;
+  if (!ReadRawBlock(block_num, m_zlib_buffer.data(), &comp_block_size))
+    return false;
+
+  return DecodeBlock(block_num, m_zlib_buffer.data(), comp_block_size, out_ptr);
+}
+
+bool CompressedBlobReader::ReadRawBlock(u64 block_num, u8* buffer, u32* size)
+{
   u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
-  u64 offset = m_block_pointers[block_num] + m_data_offset;
+  u64 offset = (m_block_pointers[block_num] & ~(1ULL << 63)) + m_data_offset;
 
-  if (offset & (1ULL << 63))
+  if (comp_block_size > m_header.block_size)
   {
-    if (comp_block_size != m_header.block_size)
-      PanicAlert("Uncompressed block with wrong size");
-    uncompressed = true;
-    offset &= ~(1ULL << 63);
+    PanicAlertT("The disc image \"%s\" is corrupt.\n"
+                "Block %" PRIu64 " is larger than the block size.",
+                m_file_name.c_str(), block_num);
+    return false;
   }
 
   // clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-  memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
+  memset(buffer + comp_block_size, 0, m_zlib_buffer.size() - comp_block_size);
 
   m_file.Seek(offset, SEEK_SET);
-  if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
+  if (!m_file.ReadBytes(buffer, comp_block_size))
   {
     PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
                 m_file_name.c_str());
@@ -111,8 +122,18 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
     return false;
   }
 
+  *size = comp_block_size;
+  return true;
+}
+
+bool CompressedBlobReader::DecodeBlock(u64 block_num, const u8* data, u32 size, u8* out_ptr) const
+{
+  const bool uncompressed = (m_block_pointers[block_num] & (1ULL << 63)) != 0;
+  if (uncompressed && size != m_header.block_size)
+    PanicAlert("Uncompressed block with wrong size");
+
   // First, check hash.
-  u32 block_hash = HashAdler32(m_zlib_buffer.data(), comp_block_size);
+  u32 block_hash = HashAdler32(data, size);
   if (block_hash != m_hashes[block_num])
     PanicAlertT("The disc image \"%s\" is corrupt.\n"
                 "Hash of block %" PRIu64 " is %08x instead of %08x.",
@@ -120,17 +141,13 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 
   if (uncompressed)
   {
-    std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
+    std::copy(data, data + size, out_ptr);
   }
   else
   {
     z_stream z = {};
-    z.next_in = m_zlib_buffer.data();
-    z.avail_in = comp_block_size;
-    if (z.avail_in > m_header.block_size)
-    {
-      PanicAlert("We have a problem");
-    }
+    z.next_in = const_cast<u8*>(data);
+    z.avail_in = size;
     z.next_out = out_ptr;
     z.avail_out = m_header.block_size;
     inflateInit(&z);
@@ -152,6 +169,117 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
   return true;
 }
 
+// Number of blocks each compression or decompression batch holds per thread of the task pool.
+static constexpr u32 BATCH_BLOCKS_PER_THREAD = 8;
+
+static u32 GetBatchBlocks()
+{
+  return static_cast<u32>(Common::TaskScheduler::GetWorkerCount() + 1) * BATCH_BLOCKS_PER_THREAD;
+}
+
+namespace
+{
+// A batch of consecutive blocks. While one batch is compressed on the task pool, the other one
+// is written out and refilled from the input file.
+struct CompressionBatch
+{
+  u32 first_block = 0;
+  u32 num_blocks = 0;
+  std::vector<u8> in_buf;
+  std::vector<u8> out_buf;
+  // Blocks that only contain unused data. They aren't read from the input file.
+  std::vector<u8> scrubbed;
+  // Compressed size of each block, or 0 if the block is stored as-is
+  std::vector<u32> out_sizes;
+  std::vector<u32> hashes;
+  Common::TaskGroup tasks;
+};
+
+// Every scrubbed block is all zeroes, so it only has to be compressed once.
+struct ScrubbedBlock
+{
+  std::vector<u8> data;
+  u32 hash = 0;
+};
+}  // namespace
+
+// Returns the compressed size, or 0 if the block doesn't compress well enough to be worth it.
+static u32 CompressBlock(z_stream* z, u8* in, u8* out, u32 block_size)
+{
+  if (deflateReset(z) != Z_OK)
+  {
+    ERROR_LOG(DISCIO, "Deflate failed");
+    return 0;
+  }
+
+  z->next_in = in;
+  z->avail_in = block_size;
+  z->next_out = out;
+  z->avail_out = block_size;
+
+  int status = deflate(z, Z_FINISH);
+  if ((status != Z_STREAM_END) || (z->avail_out < 10))
+    return 0;
+
+  return block_size - z->avail_out;
+}
+
+static ScrubbedBlock CompressScrubbedBlock(u32 block_size)
+{
+  ScrubbedBlock scrubbed_block;
+  std::vector<u8> zeroes(block_size, 0);
+  scrubbed_block.data.resize(block_size);
+
+  z_stream z = {};
+  if (deflateInit(&z, 9) != Z_OK)
+    return {};
+  const u32 size = CompressBlock(&z, zeroes.data(), scrubbed_block.data.data(), block_size);
+  deflateEnd(&z);
+  if (size == 0)
+    return {};
+
+  scrubbed_block.data.resize(size);
+  scrubbed_block.hash = HashAdler32(scrubbed_block.data.data(), size);
+  return scrubbed_block;
+}
+
+static void CompressBatch(CompressionBatch* batch, u32 block_size,
+                          const ScrubbedBlock& scrubbed_block)
+{
+  // Every task compresses a few consecutive blocks with its own deflate state.
+  constexpr u32 BLOCKS_PER_TASK = 2;
+  for (u32 first = 0; first < batch->num_blocks; first += BLOCKS_PER_TASK)
+  {
+    const u32 last = std::min(first + BLOCKS_PER_TASK, batch->num_blocks);
+    batch->tasks.Run([batch, block_size, first, last, &scrubbed_block] {
+      z_stream z = {};
+      const bool deflate_ok = deflateInit(&z, 9) == Z_OK;
+      for (u32 i = first; i < last; i++)
+      {
+        u8* in = &batch->in_buf[i * block_size];
+        u8* out = &batch->out_buf[i * block_size];
+        if (batch->scrubbed[i])
+        {
+          if (!scrubbed_block.data.empty())
+          {
+            std::copy(scrubbed_block.data.begin(), scrubbed_block.data.end(), out);
+            batch->out_sizes[i] = static_cast<u32>(scrubbed_block.data.size());
+            batch->hashes[i] = scrubbed_block.hash;
+            continue;
+          }
+          std::fill(in, in + block_size, 0);
+        }
+
+        const u32 size = deflate_ok ? CompressBlock(&z, in, out, block_size) : 0;
+        batch->out_sizes[i] = size;
+        batch->hashes[i] = size ? HashAdler32(out, size) : HashAdler32(in, block_size);
+      }
+      if (deflate_ok)
+        deflateEnd(&z);
+    });
+  }
+}
+
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
                         u32 sub_type, int block_size, CompressCB callback, void* arg)
 {
@@ -193,10 +321,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     scrubbing = true;
   }
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
-    return false;
-
   callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
   CompressedBlobHeader header;
@@ -210,8 +334,46 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   std::vector<u64> offsets(header.num_blocks);
   std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
+
+  ScrubbedBlock scrubbed_block;
+  if (scrubbing)
+    scrubbed_block = CompressScrubbedBlock(block_size);
+
+  const u32 batch_blocks = GetBatchBlocks();
+  std::array<CompressionBatch, 2> batches;
+  for (CompressionBatch& batch : batches)
+  {
+    batch.in_buf.resize(static_cast<size_t>(batch_blocks) * block_size);
+    batch.out_buf.resize(static_cast<size_t>(batch_blocks) * block_size);
+    batch.scrubbed.resize(batch_blocks);
+    batch.out_sizes.resize(batch_blocks);
+    batch.hashes.resize(batch_blocks);
+  }
+
+  // Reads the next batch of blocks from the input file and starts compressing it.
+  u32 next_block = 0;
+  auto start_batch = [&](CompressionBatch* batch) {
+    batch->first_block = next_block;
+    batch->num_blocks = std::min(batch_blocks, header.num_blocks - next_block);
+    for (u32 i = 0; i < batch->num_blocks; i++)
+    {
+      const u64 offset = static_cast<u64>(next_block + i) * block_size;
+      batch->scrubbed[i] = disc_scrubber.CanBlockBeScrubbed(offset);
+      if (batch->scrubbed[i])
+      {
+        infile.Seek(offset + block_size, SEEK_SET);
+        continue;
+      }
+
+      u8* in = &batch->in_buf[i * block_size];
+      size_t read_bytes;
+      infile.ReadArray(in, header.block_size, &read_bytes);
+      if (read_bytes < header.block_size)
+        std::fill(in + read_bytes, in + header.block_size, 0);
+    }
+    next_block += batch->num_blocks;
+    CompressBatch(batch, block_size, scrubbed_block);
+  };
 
   // seek past the header (we will write it at the end)
   outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -227,86 +389,79 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
   bool success = true;
 
-  for (u32 i = 0; i < header.num_blocks; i++)
+  start_batch(&batches[0]);
+  for (size_t current = 0; success && batches[current].num_blocks != 0; current ^= 1)
   {
-    if (i % progress_monitor == 0)
-    {
-      const u64 inpos = infile.Tell();
-      int ratio = 0;
-      if (inpos != 0)
-        ratio = (int)(100 * position / inpos);
-
-      std::string temp =
-          StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
-                           header.num_blocks, ratio);
-      bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
-      if (was_cancelled)
-      {
-        success = false;
-        break;
-      }
-    }
+    CompressionBatch& batch = batches[current];
 
-    offsets[i] = position;
+    // Keep the pool busy with the next batch while this one is being written.
+    CompressionBatch& next_batch = batches[current ^ 1];
+    next_batch.num_blocks = 0;
+    if (next_block < header.num_blocks)
+      start_batch(&next_batch);
 
-    size_t read_bytes;
-    if (scrubbing)
-      read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
-    else
-      infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
-    if (read_bytes < header.block_size)
-      std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
+    batch.tasks.Wait();
 
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
-
-    if (retval != Z_OK)
+    for (u32 j = 0; j < batch.num_blocks; j++)
     {
-      ERROR_LOG(DISCIO, "Deflate failed");
-      success = false;
-      break;
-    }
+      const u32 i = batch.first_block + j;
+      if (i % progress_monitor == 0)
+      {
+        const u64 inpos = static_cast<u64>(i) * block_size;
+        int ratio = 0;
+        if (inpos != 0)
+          ratio = (int)(100 * position / inpos);
+
+        std::string temp =
+            StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
+                             header.num_blocks, ratio);
+        bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
+        if (was_cancelled)
+        {
+          success = false;
+          break;
+        }
+      }
 
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
+      offsets[i] = position;
 
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
-    {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-      // let's store uncompressed
-      write_buf = in_buf.data();
-      offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
-    }
-    else
-    {
-      // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
-    }
+      u8* write_buf;
+      int write_size;
+      if (batch.out_sizes[j] == 0)
+      {
+        // let's store uncompressed
+        write_buf = &batch.in_buf[j * block_size];
+        offsets[i] |= 0x8000000000000000ULL;
+        write_size = block_size;
+        num_stored++;
+      }
+      else
+      {
+        // let's store compressed
+        write_buf = &batch.out_buf[j * block_size];
+        write_size = batch.out_sizes[j];
+        num_compressed++;
+      }
 
-    if (!outfile.WriteBytes(write_buf, write_size))
-    {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
-      break;
-    }
+      if (!outfile.WriteBytes(write_buf, write_size))
+      {
+        PanicAlertT("Failed to write the output file \"%s\".\n"
+                    "Check that you have enough space available on the target drive.",
+                    outfile_path.c_str());
+        success = false;
+        break;
+      }
 
-    position += write_size;
+      position += write_size;
 
-    hashes[i] = HashAdler32(write_buf, write_size);
+      hashes[i] = batch.hashes[j];
+    }
   }
 
+  // Don't free the buffers while a batch is still being compressed.
+  for (CompressionBatch& batch : batches)
+    batch.tasks.Wait();
+
   header.compressed_data_size = position;
 
   if (!success)
@@ -324,9 +479,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     outfile.WriteArray(hashes.data(), header.num_blocks);
   }
 
-  // Cleanup
-  deflateEnd(&z);
-
   if (success)
   {
     callback(GetStringT("Done compressing disc image."), 1.0f, arg);
@@ -366,15 +518,16 @@ bool DecompressBlobToFile(const std::string& infile_path, const std::string& out
   }
 
   const CompressedBlobHeader& header = reader->GetHeader();
-  static const size_t BUFFER_BLOCKS = 32;
-  size_t buffer_size = header.block_size * BUFFER_BLOCKS;
-  size_t last_buffer_size = header.block_size * (header.num_blocks % BUFFER_BLOCKS);
-  std::vector<u8> buffer(buffer_size);
-  u32 num_buffers = (header.num_blocks + BUFFER_BLOCKS - 1) / BUFFER_BLOCKS;
+  const u32 batch_blocks = GetBatchBlocks();
+  const size_t raw_block_size = header.block_size + 64;
+  std::vector<u8> raw_buffer(batch_blocks * raw_block_size);
+  std::vector<u32> raw_sizes(batch_blocks);
+  std::vector<u8> buffer(static_cast<size_t>(batch_blocks) * header.block_size);
+  u32 num_buffers = (header.num_blocks + batch_blocks - 1) / batch_blocks;
   int progress_monitor = std::max<int>(1, num_buffers / 100);
   bool success = true;
 
-  for (u64 i = 0; i < num_buffers; i++)
+  for (u32 i = 0; i < num_buffers; i++)
   {
     if (i % progress_monitor == 0)
     {
@@ -385,9 +538,39 @@ bool DecompressBlobToFile(const std::string& infile_path, const std::string& out
         break;
       }
     }
-    const size_t sz = i == num_buffers - 1 ? last_buffer_size : buffer_size;
-    reader->Read(i * buffer_size, sz, buffer.data());
-    if (!outfile.WriteBytes(buffer.data(), sz))
+
+    // Reading happens here, the blocks are then decompressed in parallel.
+    const u32 first_block = i * batch_blocks;
+    const u32 num_blocks = std::min(batch_blocks, header.num_blocks - first_block);
+    for (u32 j = 0; j < num_blocks; j++)
+    {
+      if (!reader->ReadRawBlock(first_block + j, &raw_buffer[j * raw_block_size], &raw_sizes[j]))
+      {
+        success = false;
+        break;
+      }
+    }
+    if (!success)
+      break;
+
+    std::atomic<bool> decoded{true};
+    Common::ParallelFor(0u, num_blocks, [&](u32 begin, u32 end) {
+      for (u32 j = begin; j < end; j++)
+      {
+        if (!reader->DecodeBlock(first_block + j, &raw_buffer[j * raw_block_size], raw_sizes[j],
+                                 &buffer[static_cast<size_t>(j) * header.block_size]))
+        {
+          decoded = false;
+        }
+      }
+    });
+    if (!decoded)
+    {
+      success = false;
+      break;
+    }
+
+    if (!outfile.WriteBytes(buffer.data(), static_cast<size_t>(num_blocks) * header.block_size))
     {
       PanicAlertT("Failed to write the output file \"%s\".\n"
                   "Check that you have enough space available on the target drive.",
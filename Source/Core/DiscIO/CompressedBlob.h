@@ -54,6 +54,12 @@ public:
   u64 GetBlockCompressedSize(u64 block_num) const;
   bool GetBlock(u64 block_num, u8* out_ptr) override;
 
+  // Reads the stored data of a block into buffer, which must hold at least block_size + 64 bytes.
+  bool ReadRawBlock(u64 block_num, u8* buffer, u32* size);
+  // Checks the hash of data read by ReadRawBlock and decompresses it into out_ptr.
+  // Unlike the other functions, this can be called from several threads at once.
+  bool DecodeBlock(u64 block_num, const u8* data, u32 size, u8* out_ptr) const;
+
 private:
   CompressedBlobReader(File::IOFile file, const std::string& filename);
 
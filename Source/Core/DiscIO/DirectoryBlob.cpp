@@ -7,7 +7,9 @@
 #include <algorithm>
 #include <array>
 #include <cinttypes>
+#include <cstdio>
 #include <cstring>
+#include <list>
 #include <locale>
 #include <map>
 #include <memory>
@@ -58,6 +60,51 @@ constexpr u8 ENTRY_SIZE = 0x0c;
 constexpr u8 FILE_ENTRY = 0;
 constexpr u8 DIRECTORY_ENTRY = 1;
 
+// Small enough to stay well below the open file limit even with several partitions
+constexpr size_t MAX_OPEN_FILES = 16;
+// Larger than a typical DVD read, so that sequential reads are served from the stdio buffer
+constexpr size_t FILE_READ_AHEAD = 0x20000;
+
+bool FileHandleCache::Read(const std::string& path, u64 offset, u64 length, u8* buffer)
+{
+  auto it = std::find_if(m_handles.begin(), m_handles.end(),
+                         [&path](const Handle& handle) { return handle.path == path; });
+  if (it != m_handles.end())
+  {
+    // Move to the front so that the least recently used handle is the one that gets closed
+    m_handles.splice(m_handles.begin(), m_handles, it);
+  }
+  else
+  {
+    File::IOFile file(path, "rb");
+    if (!file)
+      return false;
+    std::setvbuf(file.GetHandle(), nullptr, _IOFBF, FILE_READ_AHEAD);
+
+    if (m_handles.size() >= MAX_OPEN_FILES)
+      m_handles.pop_back();
+    m_handles.push_front({path, std::move(file), 0});
+  }
+
+  Handle& handle = m_handles.front();
+
+  // Seeking discards the stdio buffer, so skip it when continuing a sequential read
+  if (handle.position != offset && !handle.file.Seek(offset, SEEK_SET))
+  {
+    m_handles.pop_front();
+    return false;
+  }
+
+  if (!handle.file.ReadBytes(buffer, length))
+  {
+    m_handles.pop_front();
+    return false;
+  }
+
+  handle.position = offset + length;
+  return true;
+}
+
 DiscContent::DiscContent(u64 offset, u64 size, const std::string& path)
     : m_offset(offset), m_size(size), m_content_source(path)
 {
@@ -87,7 +134,7 @@ u64 DiscContent::GetSize() const
   return m_size;
 }
 
-bool DiscContent::Read(u64* offset, u64* length, u8** buffer) const
+bool DiscContent::Read(u64* offset, u64* length, u8** buffer, FileHandleCache* file_cache) const
 {
   if (m_size == 0)
     return true;
@@ -101,10 +148,11 @@ bool DiscContent::Read(u64* offset, u64* length, u8** buffer) const
 
     if (std::holds_alternative<std::string>(m_content_source))
     {
-      File::IOFile file(std::get<std::string>(m_content_source), "rb");
-      file.Seek(offset_in_content, SEEK_SET);
-      if (!file.ReadBytes(*buffer, bytes_to_read))
+      if (!file_cache->Read(std::get<std::string>(m_content_source), offset_in_content,
+                            bytes_to_read, *buffer))
+      {
         return false;
+      }
     }
     else
     {
@@ -156,7 +204,7 @@ bool DiscContentContainer::Read(u64 offset, u64 length, u8* buffer) const
     // Zero fill to start of DiscContent data
     PadToAddress(it->GetOffset(), &offset, &length, &buffer);
 
-    if (!it->Read(&offset, &length, &buffer))
+    if (!it->Read(&offset, &length, &buffer, &m_file_cache))
       return false;
 
     ++it;
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstddef>
+#include <list>
 #include <map>
 #include <memory>
 #include <optional>
@@ -14,13 +15,13 @@
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "DiscIO/Blob.h"
 
 namespace File
 {
 struct FSTEntry;
-class IOFile;
 }
 
 namespace DiscIO
@@ -30,6 +31,24 @@ enum class PartitionType : u32;
 // Returns true if the path is inside a DirectoryBlob and doesn't represent the DirectoryBlob itself
 bool ShouldHideFromGameList(const std::string& volume_path);
 
+// Keeps the most recently used extracted files open, so that streaming from a DirectoryBlob
+// doesn't have to open, seek and close a file for every read
+class FileHandleCache
+{
+public:
+  bool Read(const std::string& path, u64 offset, u64 length, u8* buffer);
+
+private:
+  struct Handle
+  {
+    std::string path;
+    File::IOFile file;
+    u64 position;
+  };
+
+  std::list<Handle> m_handles;
+};
+
 class DiscContent
 {
 public:
@@ -44,7 +63,7 @@ public:
   u64 GetOffset() const;
   u64 GetEndOffset() const;
   u64 GetSize() const;
-  bool Read(u64* offset, u64* length, u8** buffer) const;
+  bool Read(u64* offset, u64* length, u8** buffer, FileHandleCache* file_cache) const;
 
   bool operator==(const DiscContent& other) const { return GetEndOffset() == other.GetEndOffset(); }
   bool operator!=(const DiscContent& other) const { return !(*this == other); }
@@ -75,6 +94,7 @@ public:
 
 private:
   std::set<DiscContent> m_contents;
+  mutable FileHandleCache m_file_cache;
 };
 
 class DirectoryBlobPartition
@@ -7,14 +7,13 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstddef>
-#include <cstdio>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "Common/Align.h"
 #include "Common/CommonTypes.h"
-#include "Common/File.h"
 #include "Common/Logging/Log.h"
 
 #include "DiscIO/DiscExtractor.h"
@@ -45,11 +44,14 @@ bool DiscScrubber::SetupScrub(const std::string& filename, int block_size)
     return false;
 
   m_file_size = m_disc->GetSize();
+  m_is_wii = m_disc->GetVolumeType() == Platform::WiiDisc;
 
-  const size_t num_clusters = static_cast<size_t>(m_file_size / CLUSTER_SIZE);
+  // GameCube discs don't end on a cluster boundary
+  const size_t num_clusters = static_cast<size_t>(Common::AlignUp(m_file_size, CLUSTER_SIZE) /
+                                                  CLUSTER_SIZE);
 
   // Warn if not DVD5 or DVD9 size
-  if (num_clusters != 0x23048 && num_clusters != 0x46090)
+  if (m_is_wii && num_clusters != 0x23048 && num_clusters != 0x46090)
   {
     WARN_LOG(DISCIO, "%s is not a standard sized Wii disc! (%zx blocks)", filename.c_str(),
              num_clusters);
@@ -63,39 +65,21 @@ bool DiscScrubber::SetupScrub(const std::string& filename, int block_size)
 
   // Done with it; need it closed for the next part
   m_disc.reset();
-  m_block_count = 0;
 
   m_is_scrubbing = success;
   return success;
 }
 
-size_t DiscScrubber::GetNextBlock(File::IOFile& in, u8* buffer)
+bool DiscScrubber::CanBlockBeScrubbed(u64 offset) const
 {
-  const u64 current_offset = m_block_count * m_block_size;
-  const u64 i = current_offset / CLUSTER_SIZE;
-
-  size_t read_bytes = 0;
-  if (m_is_scrubbing && m_free_table[i])
-  {
-    DEBUG_LOG(DISCIO, "Freeing 0x%016" PRIx64, current_offset);
-    std::fill(buffer, buffer + m_block_size, 0x00);
-    in.Seek(m_block_size, SEEK_CUR);
-    read_bytes = m_block_size;
-  }
-  else
-  {
-    DEBUG_LOG(DISCIO, "Used    0x%016" PRIx64, current_offset);
-    in.ReadArray(buffer, m_block_size, &read_bytes);
-  }
-
-  m_block_count++;
-  return read_bytes;
+  const u64 cluster = offset / CLUSTER_SIZE;
+  return m_is_scrubbing && cluster < m_free_table.size() && m_free_table[cluster];
 }
 
 void DiscScrubber::MarkAsUsed(u64 offset, u64 size)
 {
-  u64 current_offset = offset;
-  const u64 end_offset = current_offset + size;
+  u64 current_offset = Common::AlignDown(offset, CLUSTER_SIZE);
+  const u64 end_offset = offset + size;
 
   DEBUG_LOG(DISCIO, "Marking 0x%016" PRIx64 " - 0x%016" PRIx64 " as used", offset, end_offset);
 
@@ -109,6 +93,13 @@ void DiscScrubber::MarkAsUsed(u64 offset, u64 size)
 // Compensate for 0x400 (SHA-1) per 0x8000 (cluster), and round to whole clusters
 void DiscScrubber::MarkAsUsedE(u64 partition_data_offset, u64 offset, u64 size)
 {
+  // GameCube discs have no hashes, their file system offsets are disc offsets
+  if (!m_is_wii)
+  {
+    MarkAsUsed(partition_data_offset + offset, size);
+    return;
+  }
+
   u64 first_cluster_start = offset / 0x7c00 * CLUSTER_SIZE + partition_data_offset;
 
   u64 last_cluster_end;
@@ -147,6 +138,13 @@ bool DiscScrubber::ParseDisc()
   // Mark the header as used - it's mostly 0s anyways
   MarkAsUsed(0, 0x50000);
 
+  if (!m_is_wii)
+  {
+    // The whole disc is a single unencrypted partition
+    PartitionHeader header;
+    return ParsePartitionData(PARTITION_NONE, &header);
+  }
+
   for (const DiscIO::Partition& partition : m_disc->GetPartitions())
   {
     PartitionHeader header;
@@ -190,12 +188,13 @@ bool DiscScrubber::ParsePartitionData(const Partition& partition, PartitionHeade
     return false;
   }
 
-  const u64 partition_data_offset = partition.offset + header->data_offset;
+  const u64 partition_data_offset =
+      partition == PARTITION_NONE ? 0 : partition.offset + header->data_offset;
 
   // Mark things as used which are not in the filesystem
   // Header, Header Information, Apploader
   if (!ReadFromVolume(0x2440 + 0x14, header->apploader_size, partition) ||
-      !ReadFromVolume(0x2440 + 0x18, header->apploader_size, partition))
+      !ReadFromVolume(0x2440 + 0x18, header->apploader_trailer_size, partition))
   {
     return false;
   }
@@ -2,11 +2,12 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
-// DiscScrubber removes the garbage data from discs (currently Wii only) which
-// is on the disc due to encryption
+// DiscScrubber removes the garbage data from discs which is on the disc due to encryption
+// (Wii) or padding between files (GameCube). Neither kind of data compresses, and neither
+// is ever read by games.
 
-// It could be adapted to GameCube discs, but the gain is most likely negligible,
-// and having 1:1 backups of discs is always nice when they are reasonably sized
+// Scrubbing GameCube discs is supported, but not done by default, since having 1:1 backups
+// of discs is always nice when they are reasonably sized
 
 // Note: the technique is inspired by Wiiscrubber, but much simpler - intentionally :)
 
@@ -18,11 +19,6 @@
 #include <vector>
 #include "Common/CommonTypes.h"
 
-namespace File
-{
-class IOFile;
-}
-
 namespace DiscIO
 {
 class FileInfo;
@@ -36,7 +32,9 @@ public:
   ~DiscScrubber();
 
   bool SetupScrub(const std::string& filename, int block_size);
-  size_t GetNextBlock(File::IOFile& in, u8* buffer);
+  // Returns true if the block at the given offset only contains unused data.
+  // The caller can replace its contents with zeroes.
+  bool CanBlockBeScrubbed(u64 offset) const;
 
 private:
   struct PartitionHeader final
@@ -72,9 +70,9 @@ private:
 
   std::vector<u8> m_free_table;
   u64 m_file_size = 0;
-  u64 m_block_count = 0;
   u32 m_block_size = 0;
   bool m_is_scrubbing = false;
+  bool m_is_wii = false;
 };
 
 }  // namespace DiscIO
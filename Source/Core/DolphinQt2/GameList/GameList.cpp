@@ -277,6 +277,7 @@ void GameList::CompressISO()
   const auto original_path = file->GetFilePath();
 
   const bool compressed = (file->GetBlobType() == DiscIO::BlobType::GCZ);
+  bool scrub = file->GetPlatform() == DiscIO::Platform::WiiDisc;
 
   if (!compressed && file->GetPlatform() == DiscIO::Platform::WiiDisc)
   {
@@ -292,6 +293,19 @@ void GameList::CompressISO()
       return;
   }
 
+  if (!compressed && file->GetPlatform() == DiscIO::Platform::GameCubeDisc)
+  {
+    QMessageBox scrub_question(this);
+    scrub_question.setIcon(QMessageBox::Question);
+    scrub_question.setText(tr("Remove padding data?"));
+    scrub_question.setInformativeText(
+        tr("Removing padding data makes the compressed copy smaller, but it will no longer be "
+           "identical to the original disc. Your disc image will still work."));
+    scrub_question.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+
+    scrub = scrub_question.exec() == QMessageBox::Yes;
+  }
+
   QString dst_path = QFileDialog::getSaveFileName(
       this, compressed ? tr("Select where you want to save the decompressed image") :
                          tr("Select where you want to save the compressed image"),
@@ -318,9 +332,8 @@ void GameList::CompressISO()
   }
   else
   {
-    good = DiscIO::CompressFileToBlob(original_path, dst_path.toStdString(),
-                                      file->GetPlatform() == DiscIO::Platform::WiiDisc ? 1 : 0,
-                                      16384, &CompressCB, &progress_dialog);
+    good = DiscIO::CompressFileToBlob(original_path, dst_path.toStdString(), scrub ? 1 : 0, 16384,
+                                      &CompressCB, &progress_dialog);
   }
 
   if (good)
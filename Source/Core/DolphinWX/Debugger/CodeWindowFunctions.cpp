@@ -160,6 +160,20 @@ void CCodeWindow::OnProfilerMenu(wxCommandEvent& event)
         wxExecute(OpenCommand, wxEXEC_SYNC);
     }
     break;
+  case IDM_WRITE_IDLE_LOOPS:
+    if (Core::GetState() == Core::State::Running)
+      Core::SetState(Core::State::Paused);
+
+    if (Core::GetState() == Core::State::Paused && PowerPC::GetMode() == PowerPC::CoreMode::JIT)
+    {
+      // Kept per game, so that the loops which are skipped can be compared between revisions
+      std::string filename = File::GetUserPath(D_DUMP_IDX) + "IdleLoops/" +
+                             SConfig::GetInstance().GetGameID() + ".txt";
+      File::CreateFullPath(filename);
+      JitInterface::WriteIdleLoopReport(filename);
+      Parent->StatusBarMessage("Wrote idle loops to %s", filename.c_str());
+    }
+    break;
   }
 }
 
@@ -907,13 +907,8 @@ wxString FifoPlayerDlg::CreateRecordingFifoSizeLabel() const
   FifoDataFile* file = FifoRecorder::GetInstance().GetRecordedFile();
 
   if (file)
-  {
-    size_t fifoBytes = 0;
-    for (size_t i = 0; i < file->GetFrameCount(); ++i)
-      fifoBytes += file->GetFrame(i).fifoData.size();
-
-    return wxString::Format(_("%zu FIFO bytes"), fifoBytes);
-  }
+    return wxString::Format(_("%zu FIFO bytes"),
+                            static_cast<size_t>(file->GetRecordedFifoBytes()));
 
   return _("No recorded file");
 }
@@ -923,17 +918,8 @@ wxString FifoPlayerDlg::CreateRecordingMemSizeLabel() const
   FifoDataFile* file = FifoRecorder::GetInstance().GetRecordedFile();
 
   if (file)
-  {
-    size_t memBytes = 0;
-    for (size_t frameNum = 0; frameNum < file->GetFrameCount(); ++frameNum)
-    {
-      const std::vector<MemoryUpdate>& memUpdates = file->GetFrame(frameNum).memoryUpdates;
-      for (const auto& memUpdate : memUpdates)
-        memBytes += memUpdate.data.size();
-    }
-
-    return wxString::Format(_("%zu memory bytes"), memBytes);
-  }
+    return wxString::Format(_("%zu memory bytes"),
+                            static_cast<size_t>(file->GetRecordedMemoryBytes()));
 
   return wxEmptyString;
 }
@@ -943,7 +929,7 @@ wxString FifoPlayerDlg::CreateRecordingFrameCountLabel() const
   FifoDataFile* file = FifoRecorder::GetInstance().GetRecordedFile();
 
   if (file)
-    return wxString::Format(_("%u frames"), file->GetFrameCount());
+    return wxString::Format(_("%u frames"), file->GetRecordedFrameCount());
 
   return wxEmptyString;
 }
@@ -1196,6 +1196,8 @@ void GameListCtrl::CompressSelection(bool _compress)
 {
   std::vector<const UICommon::GameFile*> items_to_compress;
   bool wii_compression_warning_accepted = false;
+  bool gamecube_scrub_asked = false;
+  bool scrub_gamecube = false;
   for (const UICommon::GameFile* iso : GetAllSelectedISOs())
   {
     // Don't include items that we can't do anything with
@@ -1218,6 +1220,14 @@ void GameListCtrl::CompressSelection(bool _compress)
       else
         return;
     }
+
+    // Removing padding is optional for GameCube discs, so ask once for the whole selection
+    if (!gamecube_scrub_asked && _compress && iso->GetBlobType() != DiscIO::BlobType::GCZ &&
+      iso->GetPlatform() == DiscIO::Platform::GameCubeDisc)
+    {
+      scrub_gamecube = GameCubeScrubPrompt();
+      gamecube_scrub_asked = true;
+    }
   }
 
   wxString dirHome;
@@ -1258,9 +1268,9 @@ void GameListCtrl::CompressSelection(bool _compress)
             _("Confirm File Overwrite"), wxYES_NO) == wxNO)
           continue;
 
+        const bool scrub = iso->GetPlatform() == DiscIO::Platform::WiiDisc || scrub_gamecube;
         all_good &=
-          DiscIO::CompressFileToBlob(iso->GetFilePath(), OutputFileName,
-          (iso->GetPlatform() == DiscIO::Platform::WiiDisc) ? 1 : 0,
+          DiscIO::CompressFileToBlob(iso->GetFilePath(), OutputFileName, scrub ? 1 : 0,
             16384, &MultiCompressCB, &progress);
       }
       else if (iso->GetBlobType() == DiscIO::BlobType::GCZ && !_compress)
@@ -1309,6 +1319,7 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
     return;
 
   bool is_compressed = iso->GetBlobType() == DiscIO::BlobType::GCZ;
+  bool scrub = iso->GetPlatform() == DiscIO::Platform::WiiDisc;
   wxString path;
 
   std::string FileName, FilePath, FileExtension;
@@ -1332,6 +1343,8 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
     {
       if (iso->GetPlatform() == DiscIO::Platform::WiiDisc && !WiiCompressWarning())
         return;
+      if (iso->GetPlatform() == DiscIO::Platform::GameCubeDisc)
+        scrub = GameCubeScrubPrompt();
 
       path = wxFileSelector(_("Save compressed GCM/ISO"), StrToWxStr(FilePath),
         StrToWxStr(FileName) + ".gcz", wxEmptyString,
@@ -1359,9 +1372,8 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
       all_good =
       DiscIO::DecompressBlobToFile(iso->GetFilePath(), WxStrToStr(path), &CompressCB, &dialog);
     else
-      all_good = DiscIO::CompressFileToBlob(
-        iso->GetFilePath(), WxStrToStr(path),
-        (iso->GetPlatform() == DiscIO::Platform::WiiDisc) ? 1 : 0, 16384, &CompressCB, &dialog);
+      all_good = DiscIO::CompressFileToBlob(iso->GetFilePath(), WxStrToStr(path), scrub ? 1 : 0,
+        16384, &CompressCB, &dialog);
   }
 
   if (!all_good)
@@ -1436,6 +1448,14 @@ bool GameListCtrl::WiiCompressWarning()
     _("Warning"), wxYES_NO) == wxYES;
 }
 
+bool GameListCtrl::GameCubeScrubPrompt()
+{
+  return wxMessageBox(_("Remove padding data from GameCube disc images? The compressed copy will "
+    "be smaller, but it will no longer be identical to the original disc. Your disc image will "
+    "still work."),
+    _("Remove Padding"), wxYES_NO) == wxYES;
+}
+
 #ifdef __WXMSW__
 // Windows draws vertical rules between columns when using UXTheme (e.g. Aero, Win10)
 // This function paints over those lines which removes them.
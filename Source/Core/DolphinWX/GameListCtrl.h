@@ -118,6 +118,7 @@ private:
   static bool CompressCB(const std::string& text, float percent, void* arg);
   static bool MultiCompressCB(const std::string& text, float percent, void* arg);
   static bool WiiCompressWarning();
+  static bool GameCubeScrubPrompt();
 
   struct
   {
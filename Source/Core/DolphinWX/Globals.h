@@ -255,6 +255,7 @@ enum
   // Profiler
   IDM_PROFILE_BLOCKS,
   IDM_WRITE_PROFILE,
+  IDM_WRITE_IDLE_LOOPS,
   // --------------------------------------------------------------
 
   // --------------------------------------------------------------
@@ -513,6 +513,7 @@ wxMenu* MainMenuBar::CreateProfilerMenu() const
   profiler_menu->AppendCheckItem(IDM_PROFILE_BLOCKS, _("&Profile Blocks"));
   profiler_menu->AppendSeparator();
   profiler_menu->Append(IDM_WRITE_PROFILE, _("&Write to profile.txt, Show"));
+  profiler_menu->Append(IDM_WRITE_IDLE_LOOPS, _("Write &Idle Loop Report"));
 
   return profiler_menu;
 }
@@ -154,10 +154,9 @@ bool DXTexture::Save(const std::string& filename, u32 level)
   D3D12_RANGE read_range = { 0, required_readback_buffer_size };
   CheckHR(readback_buffer->Map(0, &read_range, &readback_texture_map));
 
-  bool saved = false;
   if (this->compressed)
   {
-    saved = TextureToDDS(
+    QueueTextureToDDS(
       static_cast<u8*>(readback_texture_map),
       dst_location.PlacedFootprint.Footprint.RowPitch,
       filename,
@@ -167,7 +166,7 @@ bool DXTexture::Save(const std::string& filename, u32 level)
   }
   else
   {
-    saved = TextureToPng(
+    QueueTextureToPng(
       static_cast<u8*>(readback_texture_map),
       dst_location.PlacedFootprint.Footprint.RowPitch,
       filename,
@@ -179,7 +178,7 @@ bool DXTexture::Save(const std::string& filename, u32 level)
   D3D12_RANGE write_range = {};
   readback_buffer->Unmap(0, &write_range);
   readback_buffer->Release();
-  return saved;
+  return true;
 }
 
 void DXTexture::CopyTexture(D3DTexture2D* source, D3DTexture2D* destination,
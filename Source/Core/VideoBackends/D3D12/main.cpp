@@ -120,6 +120,7 @@ void VideoBackend::InitBackendInfo()
   g_Config.backend_info.bSupportsDynamicSamplerIndexing = false;
   g_Config.backend_info.bSupportsUberShaders = true;
   g_Config.backend_info.bSupportsHighPrecisionFrameBuffer = true;
+  g_Config.backend_info.bSupportsPrimitiveRestart = false;
   IDXGIFactory* factory;
   IDXGIAdapter* ad;
   hr = create_dxgi_factory(__uuidof(IDXGIFactory), (void**)&factory);
@@ -153,21 +153,20 @@ bool DXTexture::Save(const std::string& filename, u32 level)
     return false;
   }
 
-  bool encode_result = false;
   if (this->compressed)
   {
-    encode_result = TextureToDDS(reinterpret_cast<u8*>(map.pData), map.RowPitch, filename,
-                                 mip_width, mip_height);
+    QueueTextureToDDS(reinterpret_cast<u8*>(map.pData), map.RowPitch, filename, mip_width,
+                      mip_height);
   }
   else
   {
-    encode_result = TextureToPng(reinterpret_cast<u8*>(map.pData), map.RowPitch, filename,
-                                 mip_width, mip_height);
+    QueueTextureToPng(reinterpret_cast<u8*>(map.pData), map.RowPitch, filename, mip_width,
+                      mip_height);
   }
   D3D::context->Unmap(staging_texture, 0);
   staging_texture->Release();
 
-  return encode_result;
+  return true;
 }
 
 void DXTexture::CopyTexture(D3DTexture2D* source, D3DTexture2D* destination, u32 srcwidth,
@@ -2,6 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <string>
 
 #include "Common/Align.h"
@@ -56,8 +59,16 @@ UBERSHADERUID ProgramShaderCache::last_uber_uid;
 std::condition_variable ProgramShaderCache::s_condition_var;
 std::mutex ProgramShaderCache::s_mutex;
 std::queue<std::unique_ptr<ProgramShaderCache::QueueEntry>> ProgramShaderCache::s_compilation_queue;
+std::queue<std::unique_ptr<ProgramShaderCache::QueueEntry>> ProgramShaderCache::s_background_queue;
+std::mutex ProgramShaderCache::s_busy_mutex;
 std::thread ProgramShaderCache::s_thread;
 
+// Background compilation numbers, collected into the statistics by the video thread
+static std::atomic<int> s_pending_compiles{0};
+static std::atomic<u32> s_finished_compiles{0};
+static std::atomic<u64> s_compile_latency_total_us{0};
+static std::atomic<u64> s_compile_latency_max_us{0};
+
 static char s_glsl_header[4096] = "";
 
 static std::string GetGLSLVersionString()
@@ -246,6 +257,13 @@ std::future<bool> ProgramShaderCache::CompileShader(const SHADERUID& uid, SHADER
   INCSTAT(stats.numPixelShadersCreated);
   SETSTAT(stats.numPixelShadersAlive, static_cast<int>(pshaders->size()));
 
+  if (g_ActiveConfig.bFullAsyncShaderCompilation || UsingHybridUberShaders())
+  {
+    auto queue_entry = std::make_unique<QueueEntry>(&shader, vcode.data(), pcode.data(),
+                                                    use_geometry ? gcode.data() : nullptr);
+    queue_entry->background = true;
+    return QueueCompilation(std::move(queue_entry));
+  }
   return CompileShader(shader, vcode.data(), pcode.data(), use_geometry ? gcode.data() : nullptr);
 }
 
@@ -284,6 +302,7 @@ SHADER* ProgramShaderCache::CompileUberShader(const UBERSHADERUID& uid)
 
 SHADER* ProgramShaderCache::SetShader(PIXEL_SHADER_RENDER_MODE render_mode, u32 components, PrimitiveType primitive_type, const GLVertexFormat* vertex_format)
 {
+  UpdateCompileStatistics();
   SHADERUID uid;
   GetShaderId(&uid, render_mode, components, primitive_type);
   if (UsingExclusiveUberShaders())
@@ -363,28 +382,65 @@ std::future<bool> ProgramShaderCache::CompileShader(
     SHADER& shader, const char* vcode, const char* pcode, const char* gcode)
 {
   if (g_ActiveConfig.bFullAsyncShaderCompilation || UsingHybridUberShaders())
+    return QueueCompilation(std::make_unique<QueueEntry>(&shader, vcode, pcode, gcode));
+
+  std::promise<bool> promise;
+  promise.set_value(CompileShaderWorker(shader, vcode, pcode, gcode));
+  return promise.get_future();
+}
+
+std::future<bool> ProgramShaderCache::QueueCompilation(std::unique_ptr<QueueEntry> entry)
+{
+  std::future<bool> future = entry->promise.get_future();
   {
-    auto queue_entry = std::make_unique<QueueEntry>(&shader, vcode, pcode, gcode);
-    std::future<bool> future = queue_entry->promise.get_future();
-    std::queue <int>::size_type size_before;
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (entry->background)
     {
-      std::lock_guard<std::mutex> lock(s_mutex);
-      size_before = s_compilation_queue.size();
-      s_compilation_queue.push(std::move(queue_entry));
+      s_pending_compiles++;
+      s_background_queue.push(std::move(entry));
     }
-    if (size_before == 0) {
-      s_condition_var.notify_all();
+    else
+    {
+      s_compilation_queue.push(std::move(entry));
     }
-    return future;
   }
+  s_condition_var.notify_one();
+  return future;
+}
 
-  std::promise<bool> promise;
-  promise.set_value(CompileShaderWorker(shader, vcode, pcode, gcode));
-  return promise.get_future();
+// Drops the specialized programs which haven't been started yet, and waits for the one the
+// compilation thread is working on, since they all point into the program cache.
+void ProgramShaderCache::CancelBackgroundCompilation()
+{
+  {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    while (!s_background_queue.empty())
+    {
+      s_background_queue.front()->promise.set_value(false);
+      s_background_queue.pop();
+      s_pending_compiles--;
+    }
+  }
+  std::lock_guard<std::mutex> busy_lock(s_busy_mutex);
 }
 
-bool ProgramShaderCache::CompileShaderWorker(
-    SHADER& shader, const char* vcode, const char* pcode, const char* gcode)
+void ProgramShaderCache::UpdateCompileStatistics()
+{
+  SETSTAT(stats.numPendingShaderCompiles, s_pending_compiles.load(std::memory_order_relaxed));
+  const u32 finished = s_finished_compiles.exchange(0, std::memory_order_relaxed);
+  if (!finished)
+    return;
+
+  ADDSTAT(stats.thisFrame.numShaderCompilesFinished, finished);
+  ADDSTAT(stats.thisFrame.shaderCompileLatencyTotal,
+          s_compile_latency_total_us.exchange(0, std::memory_order_relaxed) / 1000.0f);
+  stats.thisFrame.shaderCompileLatencyMax =
+      std::max(stats.thisFrame.shaderCompileLatencyMax,
+               s_compile_latency_max_us.exchange(0, std::memory_order_relaxed) / 1000.0f);
+}
+
+bool ProgramShaderCache::CompileShaderWorker(SHADER& shader, const char* vcode, const char* pcode,
+                                             const char* gcode, bool shared_context)
 {
   GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode);
   GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode);
@@ -459,6 +515,11 @@ bool ProgramShaderCache::CompileShaderWorker(
     return false;
   }
 
+  // The video thread only picks up the program through its own context once the link has
+  // actually completed.
+  if (shared_context)
+    glFinish();
+
   shader.SetProgramVariables();
   shader.glprogid = pid;
   return true;
@@ -467,20 +528,7 @@ bool ProgramShaderCache::CompileShaderWorker(
 bool ProgramShaderCache::CompileComputeShader(SHADER& shader, const std::string& code)
 {
   if (g_ActiveConfig.bFullAsyncShaderCompilation || UsingHybridUberShaders())
-  {
-    auto queue_entry = std::make_unique<QueueEntry>(&shader, code);
-    std::future<bool> future = queue_entry->promise.get_future();
-    std::queue <int>::size_type size_before;
-    {
-      std::lock_guard<std::mutex> lock(s_mutex);
-      size_before = s_compilation_queue.size();
-      s_compilation_queue.push(std::move(queue_entry));
-    }
-    if (size_before == 0) {
-      s_condition_var.notify_all();
-    }
-    return future.get();
-  }
+    return QueueCompilation(std::make_unique<QueueEntry>(&shader, code)).get();
   return CompileComputeShaderWorker(shader, code);
 }
 
@@ -629,21 +677,24 @@ void ProgramShaderCache::CompileThreadWorker(std::unique_ptr<cInterfaceBase> sha
         g_ogl_config.gl_vendor, g_ogl_config.gl_renderer, g_ogl_config.gl_version);
   }
 
-  std::unique_ptr<QueueEntry> entry;
-  while(true)
+  while (true)
   {
-    {
-      std::unique_lock<std::mutex> lock(s_mutex);
-      if (s_compilation_queue.empty())
-      {
-        s_condition_var.wait(lock, []{return !s_compilation_queue.empty();});
-      }
-      entry = std::move(s_compilation_queue.front());
-      s_compilation_queue.pop();
-    }
+    std::unique_lock<std::mutex> lock(s_mutex);
+    s_condition_var.wait(lock, [] {
+      return !s_compilation_queue.empty() || !s_background_queue.empty();
+    });
+    // Programs the video thread is waiting for go first
+    auto& queue = s_compilation_queue.empty() ? s_background_queue : s_compilation_queue;
+    std::unique_ptr<QueueEntry> entry = std::move(queue.front());
+    queue.pop();
+    std::lock_guard<std::mutex> busy_lock(s_busy_mutex);
+    lock.unlock();
+
     if (entry->kill_thread)
     {
-      break;
+      shared_context->Shutdown();
+      entry->promise.set_value(true);
+      return;
     }
     bool success;
     if (entry->compute_shader)
@@ -653,13 +704,26 @@ void ProgramShaderCache::CompileThreadWorker(std::unique_ptr<cInterfaceBase> sha
     else
     {
       const char* gcode = entry->gcode.empty() ? nullptr : entry->gcode.c_str();
-      success =
-          CompileShaderWorker(*entry->shader, entry->vcode.c_str(), entry->pcode.c_str(), gcode);
+      success = CompileShaderWorker(*entry->shader, entry->vcode.c_str(), entry->pcode.c_str(),
+                                    gcode, true);
+    }
+    if (entry->background)
+    {
+      const u64 latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - entry->queue_time)
+                              .count();
+      u64 max_latency = s_compile_latency_max_us.load(std::memory_order_relaxed);
+      while (latency > max_latency &&
+             !s_compile_latency_max_us.compare_exchange_weak(max_latency, latency,
+                                                             std::memory_order_relaxed))
+      {
+      }
+      s_compile_latency_total_us.fetch_add(latency, std::memory_order_relaxed);
+      s_finished_compiles.fetch_add(1, std::memory_order_relaxed);
+      s_pending_compiles--;
     }
     entry->promise.set_value(success);
   }
-  shared_context->Shutdown();
-  entry->promise.set_value(true);
 }
 
 void ProgramShaderCache::GetShaderId(SHADERUID* uid, PIXEL_SHADER_RENDER_MODE render_mode, u32 components, PrimitiveType primitive_type)
@@ -884,18 +948,11 @@ void ProgramShaderCache::CompileShaders()
 
 void ProgramShaderCache::Shutdown(bool shadersonly)
 {
-  if (!shadersonly && (g_ActiveConfig.bFullAsyncShaderCompilation || UsingHybridUberShaders()))
+  if (s_thread.joinable())
   {
-    auto queue_entry = std::make_unique<QueueEntry>();
-    std::queue <int>::size_type size_before;
-    {
-      std::lock_guard<std::mutex> lock(s_mutex);
-      size_before = s_compilation_queue.size();
-      s_compilation_queue.push(std::move(queue_entry));
-    }
-    if (size_before == 0) {
-      s_condition_var.notify_all();
-    }
+    CancelBackgroundCompilation();
+    if (!shadersonly)
+      QueueCompilation(std::make_unique<QueueEntry>());
   }
 
   InvalidateVertexFormat();
@@ -984,7 +1041,7 @@ void ProgramShaderCache::Shutdown(bool shadersonly)
   if (!shadersonly)
   {
     s_buffer.reset();
-    if (g_ActiveConfig.bFullAsyncShaderCompilation || UsingHybridUberShaders())
+    if (s_thread.joinable())
     {
       s_thread.join();
     }
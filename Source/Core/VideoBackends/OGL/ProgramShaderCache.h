@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <future>
 #include <memory>
@@ -177,6 +178,9 @@ private:
     std::string ccode;
     bool compute_shader = false;
     bool kill_thread = false;
+    // Specialized programs nobody waits for are compiled after everything else.
+    bool background = false;
+    std::chrono::steady_clock::time_point queue_time = std::chrono::steady_clock::now();
   };
 
   typedef ObjectUsageProfiler<SHADERUID, pKey_t, PCacheEntry, SHADERUID::ShaderUidHasher> PCache;
@@ -184,10 +188,13 @@ private:
 
   static void LoadFromDisk();
   static void CompileShaders();
-  static bool CompileShaderWorker(
-      SHADER& shader, const char* vcode, const char* pcode, const char* gcode);
+  static bool CompileShaderWorker(SHADER& shader, const char* vcode, const char* pcode,
+                                  const char* gcode, bool shared_context = false);
   static bool CompileComputeShaderWorker(SHADER& shader, const std::string& code);
   static void CompileThreadWorker(std::unique_ptr<cInterfaceBase> shared_context);
+  static std::future<bool> QueueCompilation(std::unique_ptr<QueueEntry> entry);
+  static void CancelBackgroundCompilation();
+  static void UpdateCompileStatistics();
   static void CompileUberShaders();
 
   class ProgramShaderCacheInserter : public LinearDiskCacheReader<SHADERUID, u8>
@@ -220,6 +227,9 @@ private:
   static std::condition_variable s_condition_var;
   static std::mutex s_mutex;
   static std::queue<std::unique_ptr<QueueEntry>> s_compilation_queue;
+  static std::queue<std::unique_ptr<QueueEntry>> s_background_queue;
+  // Held by the compilation thread while it works on an entry.
+  static std::mutex s_busy_mutex;
   static std::thread s_thread;
 };
 
@@ -511,6 +511,12 @@ Renderer::Renderer()
   g_Config.backend_info.bSupportsDynamicSamplerIndexing =
       GLExtensions::Supports("GL_ARB_gpu_shader5");
 
+  // Primitive restart is core in OpenGL 3.1 and OpenGL ES 3.0
+  g_Config.backend_info.bSupportsPrimitiveRestart =
+      !DriverDetails::HasBug(DriverDetails::BUG_PRIMITIVE_RESTART) &&
+      (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3 ||
+       GLExtensions::Version() >= 310 || GLExtensions::Supports("GL_NV_primitive_restart"));
+
   g_ogl_config.bSupportsGLSLCache = GLExtensions::Supports("GL_ARB_get_program_binary");
   g_ogl_config.bSupportsGLPinnedMemory = GLExtensions::Supports("GL_AMD_pinned_memory");
   g_ogl_config.bSupportsGLSync = GLExtensions::Supports("GL_ARB_sync");
@@ -737,6 +743,25 @@ Renderer::Renderer()
     return;
   }
 
+  if (g_Config.backend_info.bSupportsPrimitiveRestart)
+  {
+    // OpenGL ES always restarts on the maximum index value.
+    if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
+    {
+      glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+    }
+    else if (GLExtensions::Version() >= 310)
+    {
+      glEnable(GL_PRIMITIVE_RESTART);
+      glPrimitiveRestartIndex(IndexGenerator::RESTART_INDEX);
+    }
+    else
+    {
+      glEnableClientState(GL_PRIMITIVE_RESTART_NV);
+      glPrimitiveRestartIndexNV(IndexGenerator::RESTART_INDEX);
+    }
+  }
+
   glGetIntegerv(GL_MAX_SAMPLES, &g_ogl_config.max_samples);
   if (g_ogl_config.max_samples < 1 || !g_ogl_config.bSupportsMSAA)
     g_ogl_config.max_samples = 1;
@@ -95,6 +95,9 @@ void VertexManager::Draw(u32 stride)
       GL_TRIANGLES
   };
   primitive_mode = modes[static_cast<u32>(m_current_primitive_type)];
+  // Triangles are emitted as restart-separated strips in that case.
+  if (primitive_mode == GL_TRIANGLES && IndexGenerator::UsesPrimitiveRestart())
+    primitive_mode = GL_TRIANGLE_STRIP;
   if (g_ogl_config.bSupportsGLBaseVertex)
   {
     glDrawRangeElementsBaseVertex(primitive_mode, 0, max_index, index_size, GL_UNSIGNED_SHORT, (u8*)nullptr + m_index_offset, (GLint)m_baseVertex);
@@ -64,7 +64,7 @@ static void SaveTexture(const std::string& filename, u32 texmap, s32 mip)
 
   GetTextureRGBA(data, texmap, mip, width, height);
 
-  TextureToPng(data, width * 4, filename, width, height, true);
+  QueueTextureToPng(data, width * 4, filename, width, height, true);
   delete[] data;
 
 }
@@ -148,7 +148,7 @@ static void DumpEfb(const std::string& filename)
     }
   }
 
-  TextureToPng(data, EFB_WIDTH * 4, filename, EFB_WIDTH, EFB_HEIGHT, true);
+  QueueTextureToPng(data, EFB_WIDTH * 4, filename, EFB_WIDTH, EFB_HEIGHT, true);
   delete[] data;
 }
 
@@ -211,7 +211,8 @@ void OnObjectEnd()
         File::GetUserPath(D_DUMPFRAMES_IDX).c_str(),
         stats.thisFrame.numDrawnObjects, ObjectBufferName[i], i - BufferBase[i]);
 
-      TextureToPng((u8*)ObjectBuffer[i], EFB_WIDTH * 4, filename, EFB_WIDTH, EFB_HEIGHT, true);
+      QueueTextureToPng((u8*)ObjectBuffer[i], EFB_WIDTH * 4, filename, EFB_WIDTH, EFB_HEIGHT,
+                        true);
       memset(ObjectBuffer[i], 0, EFB_WIDTH * EFB_HEIGHT * sizeof(u32));
 
     }
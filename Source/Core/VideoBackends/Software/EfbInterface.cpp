@@ -20,6 +20,23 @@ namespace EfbInterface
 {
 u32 perf_values[PQ_NUM_MEMBERS];
 
+// Coarse depth range of each DEPTH_TILE_SIZE x DEPTH_TILE_SIZE tile of the depth buffer.
+// Tiles are flagged stale when one of their pixels is written and rescanned on the next query,
+// which keeps the ranges exact without paying for a rescan on every depth write.
+struct DepthTile
+{
+  u32 min;
+  u32 max;
+  bool valid;
+};
+
+constexpr int DEPTH_TILES_WIDE = EFB_WIDTH / DEPTH_TILE_SIZE;
+constexpr int DEPTH_TILES_HIGH = EFB_HEIGHT / DEPTH_TILE_SIZE;
+static_assert(EFB_WIDTH % DEPTH_TILE_SIZE == 0 && EFB_HEIGHT % DEPTH_TILE_SIZE == 0,
+              "depth tiles must evenly cover the EFB");
+
+static DepthTile depth_tiles[DEPTH_TILES_WIDE * DEPTH_TILES_HIGH];
+
 static inline u32 GetColorOffset(u16 x, u16 y)
 {
   return (x + y * EFB_WIDTH) * 3;
@@ -170,8 +187,18 @@ static void GetPixelColor(u32 offset, u8 *color)
   }
 }
 
+static inline void InvalidateDepthTile(u32 offset)
+{
+  const u32 pixel = (offset - DEPTH_BUFFER_START) / 3;
+  const u32 x = pixel % EFB_WIDTH;
+  const u32 y = pixel / EFB_WIDTH;
+  depth_tiles[(y / DEPTH_TILE_SIZE) * DEPTH_TILES_WIDE + x / DEPTH_TILE_SIZE].valid = false;
+}
+
 static void SetPixelDepth(u32 offset, u32 depth)
 {
+  InvalidateDepthTile(offset);
+
   switch (bpmem.zcontrol.pixel_format)
   {
   case PEControl::RGB8_Z24:
@@ -574,6 +601,45 @@ void BypassXFB(u8* texture, u32 fbWidth, u32 fbHeight, const EFBRectangle& sourc
   }
 }
 
+bool GetDepthTileRange(u16 tile_x, u16 tile_y, u32* min, u32* max)
+{
+  switch (bpmem.zcontrol.pixel_format)
+  {
+  case PEControl::RGB8_Z24:
+  case PEControl::RGBA6_Z24:
+  case PEControl::Z24:
+  case PEControl::RGB565_Z16:
+    break;
+  default:
+    return false;
+  }
+
+  DepthTile& tile = depth_tiles[tile_y * DEPTH_TILES_WIDE + tile_x];
+  if (!tile.valid)
+  {
+    u32 tile_min = 0x00ffffff;
+    u32 tile_max = 0;
+    for (int y = 0; y < DEPTH_TILE_SIZE; y++)
+    {
+      u32 offset = GetDepthOffset(tile_x * DEPTH_TILE_SIZE, tile_y * DEPTH_TILE_SIZE + y);
+      for (int x = 0; x < DEPTH_TILE_SIZE; x++, offset += 3)
+      {
+        const u32 depth = GetPixelDepth(offset);
+        tile_min = std::min(tile_min, depth);
+        tile_max = std::max(tile_max, depth);
+      }
+    }
+
+    tile.min = tile_min;
+    tile.max = tile_max;
+    tile.valid = true;
+  }
+
+  *min = tile.min;
+  *max = tile.max;
+  return true;
+}
+
 bool ZCompare(u16 x, u16 y, u32 z)
 {
   u32 offset = GetDepthOffset(x, y);
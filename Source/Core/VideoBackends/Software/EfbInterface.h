@@ -12,6 +12,9 @@ namespace EfbInterface
 {
 const int DEPTH_BUFFER_START = EFB_WIDTH * EFB_HEIGHT * 3;
 
+// size in pixels of the square tiles the depth buffer keeps min/max ranges for
+const int DEPTH_TILE_SIZE = 8;
+
 // xfb color format - packed so the compiler doesn't mess with alignment
 #pragma pack(push,1)
 struct yuv422_packed
@@ -47,6 +50,10 @@ void BlendTev(u16 x, u16 y, u8 *color);
 // returns result of compare.
 bool ZCompare(u16 x, u16 y, u32 z);
 
+// gets the smallest and largest depth stored in the given tile
+// returns false if the current pixel format has no usable depth values.
+bool GetDepthTileRange(u16 tile_x, u16 tile_y, u32* min, u32* max);
+
 // sets the color and alpha
 void SetColor(u16 x, u16 y, u8 *color);
 void SetDepth(u16 x, u16 y, u32 depth);
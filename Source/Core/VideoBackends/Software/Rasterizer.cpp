@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstring>
 
 #include "Common/CommonTypes.h"
@@ -19,6 +21,16 @@
 namespace Rasterizer
 {
 static constexpr int BLOCK_SIZE = 2;
+static_assert(EfbInterface::DEPTH_TILE_SIZE % BLOCK_SIZE == 0, "blocks must not straddle depth tiles");
+
+// Outcome of testing a triangle against the coarse depth range of a depth tile
+enum class DepthTileTest
+{
+  Unknown,   // not tested yet
+  PerPixel,  // depth ranges overlap, every pixel needs to be compared
+  Fail,      // no pixel of the triangle inside the tile can pass the depth test
+  Pass,      // every pixel of the triangle inside the tile passes the depth test
+};
 
 static Slope ZSlope;
 static Slope WSlope;
@@ -97,7 +109,7 @@ void SetTevReg(int reg, int comp, bool konst, s16 color)
   tev.SetRegColor(reg, comp, konst, color);
 }
 
-static void Draw(s32 x, s32 y, s32 xi, s32 yi)
+static void Draw(s32 x, s32 y, s32 xi, s32 yi, bool depth_passes)
 {
   INCSTAT(stats.thisFrame.rasterizedPixels);
 
@@ -113,7 +125,9 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
     if (bpmem.zmode.testenable)
     {
       // early z
-      if (!EfbInterface::ZCompare(x, y, z))
+      if (depth_passes)
+        EfbInterface::SetDepth(x, y, z);
+      else if (!EfbInterface::ZCompare(x, y, z))
         return;
     }
     EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
@@ -162,6 +176,95 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
   tev.Draw();
 }
 
+// Accounts for a pixel whose early depth test is known to fail without interpolating anything.
+static void DiscardOccluded()
+{
+  INCSTAT(stats.thisFrame.rasterizedPixels);
+  EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT_ZCOMPLOC);
+}
+
+// Compares the depths the triangle takes on inside the given pixel rectangle against the range
+// stored for the depth tile, so that whole blocks can skip or shortcut the early depth test.
+static DepthTileTest TestDepthTile(s32 tileX, s32 tileY, s32 left, s32 top, s32 right, s32 bottom)
+{
+  u32 tileMin, tileMax;
+  if (!EfbInterface::GetDepthTileRange(tileX, tileY, &tileMin, &tileMax))
+    return DepthTileTest::PerPixel;
+
+  // z is planar, so its extremes over the rectangle are found at the corners
+  float dx0 = vertexOffsetX + (float)(left - vertex0X);
+  float dx1 = vertexOffsetX + (float)(right - 1 - vertex0X);
+  float dy0 = vertexOffsetY + (float)(top - vertex0Y);
+  float dy1 = vertexOffsetY + (float)(bottom - 1 - vertex0Y);
+
+  float z00 = ZSlope.GetValue(dx0, dy0);
+  float z10 = ZSlope.GetValue(dx1, dy0);
+  float z01 = ZSlope.GetValue(dx0, dy1);
+  float z11 = ZSlope.GetValue(dx1, dy1);
+
+  float zMinF = std::min(std::min(z00, z10), std::min(z01, z11));
+  float zMaxF = std::max(std::max(z00, z10), std::max(z01, z11));
+  if (!std::isfinite(zMinF) || !std::isfinite(zMaxF))
+    return DepthTileTest::PerPixel;
+
+  // Draw() rounds differently when evaluating the plane per pixel, widen the range to cover that
+  float magnitude = std::fabs(ZSlope.f0) +
+                    std::fabs(ZSlope.dfdx) * std::max(std::fabs(dx0), std::fabs(dx1)) +
+                    std::fabs(ZSlope.dfdy) * std::max(std::fabs(dy0), std::fabs(dy1));
+  float error = magnitude * (1.0f / (1 << 20)) + 1.0f;
+
+  u32 zMin = (s32)MathUtil::Clamp<float>(zMinF - error, 0.0f, 16777215.0f);
+  u32 zMax = (s32)MathUtil::Clamp<float>(zMaxF + error, 0.0f, 16777215.0f);
+
+  switch (bpmem.zmode.func)
+  {
+  case ZMode::NEVER:
+    return DepthTileTest::Fail;
+  case ZMode::LESS:
+    if (zMin >= tileMax)
+      return DepthTileTest::Fail;
+    if (zMax < tileMin)
+      return DepthTileTest::Pass;
+    break;
+  case ZMode::EQUAL:
+    if (zMax < tileMin || zMin > tileMax)
+      return DepthTileTest::Fail;
+    if (zMin == zMax && tileMin == tileMax && zMin == tileMin)
+      return DepthTileTest::Pass;
+    break;
+  case ZMode::LEQUAL:
+    if (zMin > tileMax)
+      return DepthTileTest::Fail;
+    if (zMax <= tileMin)
+      return DepthTileTest::Pass;
+    break;
+  case ZMode::GREATER:
+    if (zMax <= tileMin)
+      return DepthTileTest::Fail;
+    if (zMin > tileMax)
+      return DepthTileTest::Pass;
+    break;
+  case ZMode::NEQUAL:
+    if (zMin == zMax && tileMin == tileMax && zMin == tileMin)
+      return DepthTileTest::Fail;
+    if (zMax < tileMin || zMin > tileMax)
+      return DepthTileTest::Pass;
+    break;
+  case ZMode::GEQUAL:
+    if (zMax < tileMin)
+      return DepthTileTest::Fail;
+    if (zMin >= tileMax)
+      return DepthTileTest::Pass;
+    break;
+  case ZMode::ALWAYS:
+    return DepthTileTest::Pass;
+  default:
+    break;
+  }
+
+  return DepthTileTest::PerPixel;
+}
+
 static void InitTriangle(float X1, float Y1, s32 xi, s32 yi)
 {
   vertex0X = xi;
@@ -402,9 +505,27 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
     // Start in corner of 8x8 block
     minx &= ~(BLOCK_SIZE - 1);
     miny &= ~(BLOCK_SIZE - 1);
+    const s32 blockMaxX = (maxx + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1);
+    const s32 blockMaxY = (maxy + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1);
+
+    // With early depth testing, whole blocks can be rejected or accepted by comparing against the
+    // depth range of the surrounding tile. Late depth testing happens after the alpha test and
+    // z textures have been applied, so it always has to be done per pixel.
+    // Blocks only ever test against depth written by earlier primitives, as each pixel is
+    // touched once per triangle, so a tile needs to be tested only once per triangle.
+    const bool hierarchicalZ = bpmem.UseEarlyDepthTest() && g_ActiveConfig.bZComploc;
+    std::array<DepthTileTest, EFB_WIDTH / EfbInterface::DEPTH_TILE_SIZE> tileTests;
+    s32 tileY = -1;
+
     // Loop through blocks
     for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
     {
+      if (hierarchicalZ && y / EfbInterface::DEPTH_TILE_SIZE != tileY)
+      {
+        tileY = y / EfbInterface::DEPTH_TILE_SIZE;
+        tileTests.fill(DepthTileTest::Unknown);
+      }
+
       for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
       {
         // Corners of block
@@ -436,21 +557,12 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
         if (a == 0x0 || b == 0x0 || c == 0x0)
           continue;
 
-        BuildBlock(x, y);
-
         // Accept whole block when totally covered
-        if (a == 0xF && b == 0xF && c == 0xF)
-        {
-          for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-          {
-            for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-            {
-              Draw(x + ix, y + iy, ix, iy);
-            }
-          }
-        }
-        else // Partially covered block
+        int coverage = (1 << (BLOCK_SIZE * BLOCK_SIZE)) - 1;
+        if (a != 0xF || b != 0xF || c != 0xF) // Partially covered block
         {
+          coverage = 0;
+
           s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
           s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
           s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
@@ -464,9 +576,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
             for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
             {
               if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-              {
-                Draw(x + ix, y + iy, ix, iy);
-              }
+                coverage |= 1 << (iy * BLOCK_SIZE + ix);
 
               CX1 -= FDY12;
               CX2 -= FDY23;
@@ -478,6 +588,44 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
             CY3 += FDX31;
           }
         }
+
+        DepthTileTest depthTest = DepthTileTest::PerPixel;
+        if (hierarchicalZ)
+        {
+          const s32 tileX = x / EfbInterface::DEPTH_TILE_SIZE;
+          DepthTileTest& tileTest = tileTests[tileX];
+          if (tileTest == DepthTileTest::Unknown)
+          {
+            const s32 tileLeft = tileX * EfbInterface::DEPTH_TILE_SIZE;
+            const s32 tileTop = tileY * EfbInterface::DEPTH_TILE_SIZE;
+            tileTest = TestDepthTile(
+                tileX, tileY, std::max(tileLeft, minx), std::max(tileTop, miny),
+                std::min(tileLeft + EfbInterface::DEPTH_TILE_SIZE, blockMaxX),
+                std::min(tileTop + EfbInterface::DEPTH_TILE_SIZE, blockMaxY));
+          }
+          depthTest = tileTest;
+        }
+
+        if (depthTest == DepthTileTest::Fail)
+        {
+          for (int i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++)
+          {
+            if (coverage & (1 << i))
+              DiscardOccluded();
+          }
+          continue;
+        }
+
+        BuildBlock(x, y);
+
+        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+        {
+          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+          {
+            if (coverage & (1 << (iy * BLOCK_SIZE + ix)))
+              Draw(x + ix, y + iy, ix, iy, depthTest == DepthTileTest::Pass);
+          }
+        }
       }
     }
   }
@@ -533,7 +681,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
         {
           // Build the new raster block every other pixel
           PrepareBlock(x, y);
-          Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+          Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1), false);
 
           if (y >= BoundingBox::coords[BoundingBox::TOP])
             break;
@@ -573,7 +721,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
         if (CY1 > 0 && CY2 > 0 && CY3 > 0)
         {
           PrepareBlock(x, y);
-          Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+          Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1), false);
 
           if (x >= BoundingBox::coords[BoundingBox::LEFT])
             break;
@@ -613,7 +761,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
         {
           // Build the new raster block every other pixel
           PrepareBlock(x, y);
-          Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+          Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1), false);
 
           if (y <= BoundingBox::coords[BoundingBox::BOTTOM])
             break;
@@ -654,7 +802,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
         {
           // Build the new raster block every other pixel
           PrepareBlock(x, y);
-          Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+          Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1), false);
 
           if (x <= BoundingBox::coords[BoundingBox::RIGHT])
             break;
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <limits>
 
 #include "Common/ChunkFile.h"
@@ -98,46 +99,61 @@ void SWVertexLoader::vFlush(bool useDstAlpha)
     Rasterizer::SetTevReg(i, Tev::ALP_C, true, kcolors[i * 4 + 3]);
   }
 
-  for (u32 i = 0; i < IndexGenerator::GetIndexLen(); i++)
-  {
-    u16 index = LocalIBuffer[i];
+  const PortableVertexDeclaration& vdec =
+      VertexLoaderManager::GetCurrentVertexFormat()->GetVertexDeclaration();
+  const bool has_normal = (VertexLoaderManager::g_current_components & VB_HAS_NRM0) != 0;
+  const bool has_nbt = (VertexLoaderManager::g_current_components & VB_HAS_NRM2) != 0;
+  const u32 index_count = IndexGenerator::GetIndexLen();
 
-    if (index == 0xffff)
+  for (u32 i = 0; i < index_count;)
+  {
+    if (LocalIBuffer[i] == 0xffff)
     {
       // primitive restart
       m_SetupUnit->Init(primitiveType);
+      i++;
       continue;
     }
-    memset(&m_Vertex, 0, sizeof(m_Vertex));
-
-    // Super Mario Sunshine requires those to be zero for those debug boxes.
-    memset(&m_Vertex.color, 0, sizeof(m_Vertex.color));
-
-    // parse the videocommon format to our own struct format (m_Vertex)
-    SetFormat(g_main_cp_state.last_id, primitiveType);
-    ParseVertex(VertexLoaderManager::GetCurrentVertexFormat()->GetVertexDeclaration(), index);
 
-    // transform this vertex so that it can be used for rasterization (outVertex)
-    OutputVertexData* outVertex = m_SetupUnit->GetVertex();
-    TransformUnit::TransformPosition(&m_Vertex, outVertex);
-    memset(&outVertex->normal, 0, sizeof(outVertex->normal));
-    if (VertexLoaderManager::g_current_components & VB_HAS_NRM0)
+    // parse the videocommon format to our own struct format, up to the next primitive restart
+    int count = 0;
+    for (; count < TransformUnit::VERTEX_BATCH_SIZE && i < index_count; count++, i++)
     {
-      TransformUnit::TransformNormal(&m_Vertex, (VertexLoaderManager::g_current_components & VB_HAS_NRM2) != 0, outVertex);
+      u16 index = LocalIBuffer[i];
+      if (index == 0xffff)
+        break;
+
+      // Super Mario Sunshine requires the colors to be zero for those debug boxes.
+      InputVertexData* vertex = &m_Vertices[count];
+      *vertex = InputVertexData{};
+      SetFormat(g_main_cp_state.last_id, primitiveType, vertex);
+      ParseVertex(vdec, index, vertex);
     }
-    TransformUnit::TransformColor(&m_Vertex, outVertex);
-    TransformUnit::TransformTexCoord(&m_Vertex, outVertex, m_TexGenSpecialCase);
 
-    // assemble and rasterize the primitive
-    m_SetupUnit->SetupVertex();
+    // transform the batch so that it can be used for rasterization
+    InputVertexData* src = m_Vertices.data();
+    OutputVertexData* dst = m_TransformedVertices.data();
+    std::fill(dst, dst + count, OutputVertexData{});
+    TransformUnit::TransformPositionBatch(src, dst, count);
+    if (has_normal)
+      TransformUnit::TransformNormalBatch(src, has_nbt, dst, count);
+    TransformUnit::TransformColorBatch(src, dst, count);
+    TransformUnit::TransformTexCoordBatch(src, dst, m_TexGenSpecialCase, count);
+
+    // assemble and rasterize the primitives
+    for (int j = 0; j < count; j++)
+    {
+      *m_SetupUnit->GetVertex() = dst[j];
+      m_SetupUnit->SetupVertex();
 
-    INCSTAT(stats.thisFrame.numVerticesLoaded)
+      INCSTAT(stats.thisFrame.numVerticesLoaded)
+    }
   }
 
   DebugUtil::OnObjectEnd();
 }
 
-void SWVertexLoader::SetFormat(u8 attributeIndex, u8 primitiveType)
+void SWVertexLoader::SetFormat(u8 attributeIndex, u8 primitiveType, InputVertexData* vertex)
 {
   // matrix index from xf regs or cp memory?
   if (xfmem.MatrixIndexA.PosNormalMtxIdx != g_main_cp_state.matrix_index_a.PosNormalMtxIdx ||
@@ -153,15 +169,15 @@ void SWVertexLoader::SetFormat(u8 attributeIndex, u8 primitiveType)
     ERROR_LOG(VIDEO, "Matrix indices don't match");
   }
 
-  m_Vertex.posMtx = xfmem.MatrixIndexA.PosNormalMtxIdx;
-  m_Vertex.texMtx[0] = xfmem.MatrixIndexA.Tex0MtxIdx;
-  m_Vertex.texMtx[1] = xfmem.MatrixIndexA.Tex1MtxIdx;
-  m_Vertex.texMtx[2] = xfmem.MatrixIndexA.Tex2MtxIdx;
-  m_Vertex.texMtx[3] = xfmem.MatrixIndexA.Tex3MtxIdx;
-  m_Vertex.texMtx[4] = xfmem.MatrixIndexB.Tex4MtxIdx;
-  m_Vertex.texMtx[5] = xfmem.MatrixIndexB.Tex5MtxIdx;
-  m_Vertex.texMtx[6] = xfmem.MatrixIndexB.Tex6MtxIdx;
-  m_Vertex.texMtx[7] = xfmem.MatrixIndexB.Tex7MtxIdx;
+  vertex->posMtx = xfmem.MatrixIndexA.PosNormalMtxIdx;
+  vertex->texMtx[0] = xfmem.MatrixIndexA.Tex0MtxIdx;
+  vertex->texMtx[1] = xfmem.MatrixIndexA.Tex1MtxIdx;
+  vertex->texMtx[2] = xfmem.MatrixIndexA.Tex2MtxIdx;
+  vertex->texMtx[3] = xfmem.MatrixIndexA.Tex3MtxIdx;
+  vertex->texMtx[4] = xfmem.MatrixIndexB.Tex4MtxIdx;
+  vertex->texMtx[5] = xfmem.MatrixIndexB.Tex5MtxIdx;
+  vertex->texMtx[6] = xfmem.MatrixIndexB.Tex6MtxIdx;
+  vertex->texMtx[7] = xfmem.MatrixIndexB.Tex7MtxIdx;
 
 
   // special case if only pos and tex coord 0 and tex coord input is AB11
@@ -224,33 +240,33 @@ static void ReadVertexAttribute(T* dst, DataReader src, const AttributeFormat& f
   }
 }
 
-void SWVertexLoader::ParseVertex(const PortableVertexDeclaration& vdec, int index)
+void SWVertexLoader::ParseVertex(const PortableVertexDeclaration& vdec, int index, InputVertexData* vertex)
 {
   DataReader src(LocalVBuffer.data(), LocalVBuffer.data() + LocalVBuffer.size());
   src.ReadSkip(index * vdec.stride);
 
-  ReadVertexAttribute<float>(&m_Vertex.position[0], src, vdec.position, 0, 3, false);
+  ReadVertexAttribute<float>(&vertex->position[0], src, vdec.position, 0, 3, false);
 
   for (int i = 0; i < 3; i++)
   {
-    ReadVertexAttribute<float>(&m_Vertex.normal[i][0], src, vdec.normals[i], 0, 3, false);
+    ReadVertexAttribute<float>(&vertex->normal[i][0], src, vdec.normals[i], 0, 3, false);
   }
 
   for (int i = 0; i < 2; i++)
   {
-    ReadVertexAttribute<u8>(m_Vertex.color[i], src, vdec.colors[i], 0, 4, true);
+    ReadVertexAttribute<u8>(vertex->color[i], src, vdec.colors[i], 0, 4, true);
   }
 
   for (int i = 0; i < 8; i++)
   {
-    ReadVertexAttribute<float>(m_Vertex.texCoords[i], src, vdec.texcoords[i], 0, 2, false);
+    ReadVertexAttribute<float>(vertex->texCoords[i], src, vdec.texcoords[i], 0, 2, false);
 
     // the texmtr is stored as third component of the texCoord
     if (vdec.texcoords[i].components >= 3)
     {
-      ReadVertexAttribute<u8>(&m_Vertex.texMtx[i], src, vdec.texcoords[i], 2, 1, false);
+      ReadVertexAttribute<u8>(&vertex->texMtx[i], src, vdec.texcoords[i], 2, 1, false);
     }
   }
 
-  ReadVertexAttribute<u8>(&m_Vertex.posMtx, src, vdec.posmtx, 0, 1, false);
+  ReadVertexAttribute<u8>(&vertex->posMtx, src, vdec.posmtx, 0, 1, false);
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -11,6 +12,7 @@
 #include "Common/CommonTypes.h"
 
 #include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/TransformUnit.h"
 
 #include "VideoCommon/VertexLoaderBase.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -37,9 +39,11 @@ private:
   std::vector<u8> LocalVBuffer;
   std::vector<u16> LocalIBuffer;
 
-  InputVertexData m_Vertex;
+  // Vertices are parsed and transformed in batches before being handed to the setup unit.
+  std::array<InputVertexData, TransformUnit::VERTEX_BATCH_SIZE> m_Vertices;
+  std::array<OutputVertexData, TransformUnit::VERTEX_BATCH_SIZE> m_TransformedVertices;
 
-  void ParseVertex(const PortableVertexDeclaration& vdec, int index);
+  void ParseVertex(const PortableVertexDeclaration& vdec, int index, InputVertexData* vertex);
 
   SetupUnit *m_SetupUnit;
 
@@ -47,5 +51,5 @@ private:
 
 public:
 
-  void SetFormat(u8 attributeIndex, u8 primitiveType);
+  void SetFormat(u8 attributeIndex, u8 primitiveType, InputVertexData* vertex);
 };
@@ -27,6 +27,7 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/FramebufferManagerBase.h"
+#include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/OpcodeDecoding.h"
@@ -148,6 +149,8 @@ void VideoSoftware::InitBackendInfo()
   g_Config.backend_info.bSupportsDualSourceBlend = true;
   g_Config.backend_info.bSupportsEarlyZ = true;
   g_Config.backend_info.bSupportsOversizedViewports = true;
+  // SWVertexLoader walks the index buffer as a triangle list.
+  g_Config.backend_info.bSupportsPrimitiveRestart = false;
 
   // aamodes
   g_Config.backend_info.AAModes = { 1 };
@@ -195,6 +198,7 @@ void VideoSoftware::Video_Cleanup()
     Fifo::Shutdown();
     g_renderer->Shutdown();
     DebugUtil::Shutdown();
+    ShutdownImageQueue();
     // The following calls are NOT Thread Safe
     // And need to be called from the video thread
     g_renderer->Shutdown();
@@ -220,7 +224,6 @@ void VideoSoftware::Video_Prepare()
   g_perf_query = std::make_unique<PerfQuery>();
   Fifo::Init(); // must be done before OpcodeDecoder_Init()
   OpcodeDecoder::Init();
-  IndexGenerator::Init();
   VertexShaderManager::Init();
   PixelShaderManager::Init(true);
   g_texture_cache = std::make_unique<TextureCache>();
@@ -2,7 +2,10 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cstring>
+
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
 
@@ -1388,10 +1391,9 @@ static void EncodeZ24halfscale(u8 *dst, u8 *src, u32 format)
   }
 }
 
-void Encode(u8 *dest_ptr)
+static u32 GetCopyFormat()
 {
-  auto pixelformat = bpmem.zcontrol.pixel_format;
-  bool bFromZBuffer = pixelformat == PEControl::Z24;
+  bool bFromZBuffer = bpmem.zcontrol.pixel_format == PEControl::Z24;
   bool bIsIntensityFmt = bpmem.triggerEFBCopy.intensity_fmt > 0;
   u32 copyfmt = ((bpmem.triggerEFBCopy.target_pixel_format / 2) + ((bpmem.triggerEFBCopy.target_pixel_format & 1) * 8));
 
@@ -1409,6 +1411,505 @@ void Encode(u8 *dest_ptr)
     if (copyfmt > GX_TF_RGBA8 || (copyfmt < GX_TF_RGB565 && !bIsIntensityFmt))
       format |= _GX_TF_CTF;
 
+  return format;
+}
+
+#ifdef _M_X86
+
+// The vectorized encoders split every copy into two steps: all texels of a destination block are
+// fetched (and box filtered) into 8 bit channels first, which are then packed into the texture
+// format. The results are bit-exact with the per-texel encoders above, including their quirks.
+
+// Channels of the texels of one destination block, in the order they are stored in the block
+struct BlockTexels
+{
+  alignas(16) u8 r[64];
+  alignas(16) u8 g[64];
+  alignas(16) u8 b[64];
+  alignas(16) u8 a[64];
+};
+
+using TexelChannel = u8 (BlockTexels::*)[64];
+using FetchFunction = void (*)(const u8* src, int width, int height, BlockTexels* texels);
+using PackFunction = void (*)(const BlockTexels& texels, u8* dst);
+
+static inline __m128i LoadPixels(const u8* src, int step)
+{
+  alignas(16) u32 pixels[4];
+  for (int i = 0; i < 4; i++)
+    std::memcpy(&pixels[i], src + i * step, sizeof(u32));
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(pixels));
+}
+
+static inline __m128i Field(__m128i pixels, int shift, int mask)
+{
+  return _mm_and_si128(_mm_srli_epi32(pixels, shift), _mm_set1_epi32(mask));
+}
+
+// Decoders turn four consecutive texels into one 8 bit channel value per 32 bit lane
+
+struct RGBA6Decoder
+{
+  static constexpr int READ_STRIDE = 3;
+
+  static inline __m128i Expand(__m128i c6)
+  {
+    // Convert6To8
+    return _mm_or_si128(_mm_slli_epi32(c6, 2), _mm_srli_epi32(c6, 4));
+  }
+
+  static void Decode(const u8* src, __m128i* r, __m128i* g, __m128i* b, __m128i* a)
+  {
+    __m128i pixels = LoadPixels(src, READ_STRIDE);
+    *a = Expand(Field(pixels, 0, 0x3f));
+    *b = Expand(Field(pixels, 6, 0x3f));
+    *g = Expand(Field(pixels, 12, 0x3f));
+    *r = Expand(Field(pixels, 18, 0x3f));
+  }
+};
+
+struct RGBA6HalfscaleDecoder
+{
+  static constexpr int READ_STRIDE = 6;
+
+  static inline __m128i Boxfilter(const __m128i pixels[4], int shift)
+  {
+    __m128i sum = Field(pixels[0], shift, 0x3f);
+    for (int i = 1; i < 4; i++)
+      sum = _mm_add_epi32(sum, Field(pixels[i], shift, 0x3f));
+    return _mm_add_epi32(sum, _mm_srli_epi32(sum, 6));
+  }
+
+  static void Decode(const u8* src, __m128i* r, __m128i* g, __m128i* b, __m128i* a)
+  {
+    const __m128i pixels[4] = {
+        LoadPixels(src, READ_STRIDE), LoadPixels(src + 3, READ_STRIDE),
+        LoadPixels(src + EFB_WIDTH * 3, READ_STRIDE),
+        LoadPixels(src + EFB_WIDTH * 3 + 3, READ_STRIDE),
+    };
+    *a = Boxfilter(pixels, 0);
+    *b = Boxfilter(pixels, 6);
+    *g = Boxfilter(pixels, 12);
+    *r = Boxfilter(pixels, 18);
+  }
+};
+
+struct RGB8Decoder
+{
+  static constexpr int READ_STRIDE = 3;
+
+  static void Decode(const u8* src, __m128i* r, __m128i* g, __m128i* b, __m128i* a)
+  {
+    __m128i pixels = LoadPixels(src, READ_STRIDE);
+    *b = Field(pixels, 0, 0xff);
+    *g = Field(pixels, 8, 0xff);
+    *r = Field(pixels, 16, 0xff);
+    *a = _mm_set1_epi32(0xff);
+  }
+};
+
+// The halfscale depth copies to Z16, Z24X8 and Z16L store their bytes in the opposite order of
+// the full scale ones, SwapRB reproduces that by exchanging the outer bytes.
+template <bool SwapRB>
+struct RGB8HalfscaleDecoder
+{
+  static constexpr int READ_STRIDE = 6;
+
+  static inline __m128i Boxfilter(const __m128i pixels[4], int shift)
+  {
+    __m128i sum = Field(pixels[0], shift, 0xff);
+    for (int i = 1; i < 4; i++)
+      sum = _mm_add_epi32(sum, Field(pixels[i], shift, 0xff));
+    return _mm_srli_epi32(sum, 2);
+  }
+
+  static void Decode(const u8* src, __m128i* r, __m128i* g, __m128i* b, __m128i* a)
+  {
+    const __m128i pixels[4] = {
+        LoadPixels(src, READ_STRIDE), LoadPixels(src + 3, READ_STRIDE),
+        LoadPixels(src + EFB_WIDTH * 3, READ_STRIDE),
+        LoadPixels(src + EFB_WIDTH * 3 + 3, READ_STRIDE),
+    };
+    *b = Boxfilter(pixels, SwapRB ? 16 : 0);
+    *g = Boxfilter(pixels, 8);
+    *r = Boxfilter(pixels, SwapRB ? 0 : 16);
+    *a = _mm_set1_epi32(0xff);
+  }
+};
+
+static inline void StoreChannel(u8* dst, const __m128i channel[4])
+{
+  __m128i lo = _mm_packs_epi32(channel[0], channel[1]);
+  __m128i hi = _mm_packs_epi32(channel[2], channel[3]);
+  _mm_store_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(lo, hi));
+}
+
+template <typename Decoder>
+static void FetchBlock(const u8* src, int width, int height, BlockTexels* texels)
+{
+  const int count = width * height;
+  for (int i = 0; i < count; i += 16)
+  {
+    __m128i r[4], g[4], b[4], a[4];
+    for (int j = 0; j < 4; j++)
+    {
+      // width is a multiple of four, so these never cross a row
+      const int texel = i + j * 4;
+      const int s = texel % width;
+      const int t = texel / width;
+      Decoder::Decode(src + (t * EFB_WIDTH + s) * Decoder::READ_STRIDE, &r[j], &g[j], &b[j], &a[j]);
+    }
+
+    StoreChannel(texels->r + i, r);
+    StoreChannel(texels->g + i, g);
+    StoreChannel(texels->b + i, b);
+    StoreChannel(texels->a + i, a);
+  }
+}
+
+static inline __m128i Load16(const u8* channel)
+{
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(channel));
+}
+
+static inline void Store16(u8* dst, __m128i value)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), value);
+}
+
+// Same as RGB8_to_I for 16 texels
+static inline __m128i Intensity(const BlockTexels& texels, int i)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i r = Load16(texels.r + i);
+  const __m128i g = Load16(texels.g + i);
+  const __m128i b = Load16(texels.b + i);
+
+  auto intensity = [](__m128i r16, __m128i g16, __m128i b16) {
+    __m128i val = _mm_add_epi16(_mm_set1_epi16(4096), _mm_mullo_epi16(r16, _mm_set1_epi16(66)));
+    val = _mm_add_epi16(val, _mm_mullo_epi16(g16, _mm_set1_epi16(129)));
+    val = _mm_add_epi16(val, _mm_mullo_epi16(b16, _mm_set1_epi16(25)));
+    return _mm_srli_epi16(val, 8);
+  };
+
+  __m128i lo = intensity(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero),
+                         _mm_unpacklo_epi8(b, zero));
+  __m128i hi = intensity(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero),
+                         _mm_unpackhi_epi8(b, zero));
+  return _mm_packus_epi16(lo, hi);
+}
+
+// Packs the upper nibbles of 32 texels into 16 bytes, the first texel of each pair in the high nibble
+static inline __m128i PackNibblePairs(__m128i x0, __m128i x1)
+{
+  const __m128i mask = _mm_set1_epi16(0x00f0);
+  __m128i lo = _mm_or_si128(_mm_and_si128(x0, mask), _mm_srli_epi16(x0, 12));
+  __m128i hi = _mm_or_si128(_mm_and_si128(x1, mask), _mm_srli_epi16(x1, 12));
+  return _mm_packus_epi16(lo, hi);
+}
+
+// (hi & 0xf0) | (lo >> 4) for 16 texels
+static inline __m128i PackNibbles(__m128i hi, __m128i lo)
+{
+  return _mm_or_si128(_mm_and_si128(hi, _mm_set1_epi8(static_cast<s8>(0xf0))),
+                      _mm_and_si128(_mm_srli_epi16(lo, 4), _mm_set1_epi8(0x0f)));
+}
+
+static inline void StoreInterleaved(u8* dst, __m128i first, __m128i second)
+{
+  Store16(dst, _mm_unpacklo_epi8(first, second));
+  Store16(dst + 16, _mm_unpackhi_epi8(first, second));
+}
+
+static inline __m128i SwapBytes16(__m128i value)
+{
+  return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+}
+
+// 8x8 blocks of 4 bit texels
+
+static void PackI4(const BlockTexels& texels, u8* dst)
+{
+  for (int i = 0; i < 64; i += 32)
+    Store16(dst + i / 2, PackNibblePairs(Intensity(texels, i), Intensity(texels, i + 16)));
+}
+
+static void PackR4(const BlockTexels& texels, u8* dst)
+{
+  for (int i = 0; i < 64; i += 32)
+    Store16(dst + i / 2, PackNibblePairs(Load16(texels.r + i), Load16(texels.r + i + 16)));
+}
+
+// 8x4 blocks of 8 bit texels
+
+static void PackI8(const BlockTexels& texels, u8* dst)
+{
+  for (int i = 0; i < 32; i += 16)
+    Store16(dst + i, Intensity(texels, i));
+}
+
+static void PackIA4(const BlockTexels& texels, u8* dst)
+{
+  for (int i = 0; i < 32; i += 16)
+    Store16(dst + i, PackNibbles(Load16(texels.a + i), Intensity(texels, i)));
+}
+
+static void PackRA4(const BlockTexels& texels, u8* dst)
+{
+  for (int i = 0; i < 32; i += 16)
+    Store16(dst + i, PackNibbles(Load16(texels.a + i), Load16(texels.r + i)));
+}
+
+template <TexelChannel Channel>
+static void PackChannel8(const BlockTexels& texels, u8* dst)
+{
+  std::memcpy(dst, texels.*Channel, 32);
+}
+
+// 4x4 blocks of 16 bit texels
+
+static void PackIA8(const BlockTexels& texels, u8* dst)
+{
+  StoreInterleaved(dst, Load16(texels.a), Intensity(texels, 0));
+}
+
+template <TexelChannel First, TexelChannel Second>
+static void PackChannels16(const BlockTexels& texels, u8* dst)
+{
+  StoreInterleaved(dst, Load16(texels.*First), Load16(texels.*Second));
+}
+
+static void PackRGB565(const BlockTexels& texels, u8* dst)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i r = Load16(texels.r);
+  const __m128i g = Load16(texels.g);
+  const __m128i b = Load16(texels.b);
+
+  auto rgb565 = [](__m128i r16, __m128i g16, __m128i b16) {
+    __m128i val = _mm_and_si128(_mm_slli_epi16(r16, 8), _mm_set1_epi16(static_cast<s16>(0xf800)));
+    val = _mm_or_si128(val, _mm_and_si128(_mm_slli_epi16(g16, 3), _mm_set1_epi16(0x07e0)));
+    val = _mm_or_si128(val, _mm_and_si128(_mm_srli_epi16(b16, 3), _mm_set1_epi16(0x001e)));
+    return SwapBytes16(val);
+  };
+
+  Store16(dst, rgb565(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero),
+                      _mm_unpacklo_epi8(b, zero)));
+  Store16(dst + 16, rgb565(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero),
+                           _mm_unpackhi_epi8(b, zero)));
+}
+
+static void PackRGB5A3(const BlockTexels& texels, u8* dst)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i r = Load16(texels.r);
+  const __m128i g = Load16(texels.g);
+  const __m128i b = Load16(texels.b);
+  const __m128i a = Load16(texels.a);
+
+  auto rgb5a3 = [](__m128i r16, __m128i g16, __m128i b16, __m128i a16) {
+    // 5551
+    __m128i rgb5 = _mm_set1_epi16(static_cast<s16>(0x8000));
+    rgb5 = _mm_or_si128(rgb5, _mm_and_si128(_mm_slli_epi16(r16, 7), _mm_set1_epi16(0x7c00)));
+    rgb5 = _mm_or_si128(rgb5, _mm_and_si128(_mm_slli_epi16(g16, 2), _mm_set1_epi16(0x03e0)));
+    rgb5 = _mm_or_si128(rgb5, _mm_and_si128(_mm_srli_epi16(b16, 3), _mm_set1_epi16(0x001e)));
+
+    // 4443
+    __m128i rgb4 = _mm_and_si128(_mm_slli_epi16(a16, 7), _mm_set1_epi16(0x7000));
+    rgb4 = _mm_or_si128(rgb4, _mm_and_si128(_mm_slli_epi16(r16, 4), _mm_set1_epi16(0x0f00)));
+    rgb4 = _mm_or_si128(rgb4, _mm_and_si128(g16, _mm_set1_epi16(0x00f0)));
+    rgb4 = _mm_or_si128(rgb4, _mm_and_si128(_mm_srli_epi16(b16, 4), _mm_set1_epi16(0x000f)));
+
+    // a >= 224
+    const __m128i opaque = _mm_cmpeq_epi16(_mm_and_si128(a16, _mm_set1_epi16(0xe0)),
+                                           _mm_set1_epi16(0xe0));
+    return SwapBytes16(_mm_or_si128(_mm_and_si128(opaque, rgb5), _mm_andnot_si128(opaque, rgb4)));
+  };
+
+  Store16(dst, rgb5a3(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero),
+                      _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(a, zero)));
+  Store16(dst + 16, rgb5a3(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero),
+                           _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(a, zero)));
+}
+
+// RGBA8 blocks hold the AR pairs of 4x4 texels followed by their GB pairs
+static void PackRGBA8(const BlockTexels& texels, u8* dst)
+{
+  StoreInterleaved(dst, Load16(texels.a), Load16(texels.r));
+  StoreInterleaved(dst + 32, Load16(texels.g), Load16(texels.b));
+}
+
+// Returns false if the format isn't handled here, the generic encoders take care of those.
+static bool EncodeBlocks(u8* dst, const u8* src, u32 format, PEControl::PixelFormat pixelformat,
+                         bool halfscale)
+{
+  FetchFunction fetch;
+  switch (pixelformat)
+  {
+  case PEControl::RGBA6_Z24:
+    fetch = halfscale ? FetchBlock<RGBA6HalfscaleDecoder> : FetchBlock<RGBA6Decoder>;
+    break;
+  case PEControl::RGB8_Z24:
+  case PEControl::RGB565_Z16:  // not supported
+  case PEControl::Z24:
+    fetch = halfscale ? FetchBlock<RGB8HalfscaleDecoder<false>> : FetchBlock<RGB8Decoder>;
+    break;
+  default:
+    return false;
+  }
+
+  // Depth formats store the same bytes as one of the color formats does for RGB8
+  if (pixelformat == PEControl::Z24)
+  {
+    switch (format)
+    {
+    case GX_TF_Z8:
+      format = GX_CTF_R8;
+      break;
+    case GX_TF_Z16:
+      format = halfscale ? GX_CTF_GB8 : GX_CTF_RG8;
+      break;
+    case GX_TF_Z24X8:
+      format = GX_TF_RGBA8;
+      break;
+    case GX_CTF_Z4:
+      format = GX_CTF_R4;
+      break;
+    case GX_CTF_Z8M:
+      format = GX_CTF_G8;
+      break;
+    case GX_CTF_Z8L:
+      format = GX_CTF_B8;
+      break;
+    case GX_CTF_Z16L:
+      format = halfscale ? GX_CTF_RG8 : GX_CTF_GB8;
+      break;
+    default:
+      return false;
+    }
+
+    if (halfscale && format != GX_CTF_R8 && format != GX_CTF_R4 && format != GX_CTF_G8 &&
+        format != GX_CTF_B8)
+    {
+      fetch = FetchBlock<RGB8HalfscaleDecoder<true>>;
+    }
+  }
+  else if (format & _GX_TF_ZTF)
+  {
+    return false;
+  }
+
+  PackFunction pack;
+  int blkWidthLog2 = 2;
+  int blkHeightLog2 = 2;
+  u32 blockBytes = 32;
+  switch (format)
+  {
+  case GX_TF_I4:
+    pack = PackI4;
+    blkWidthLog2 = blkHeightLog2 = 3;
+    break;
+  case GX_CTF_R4:
+    pack = PackR4;
+    blkWidthLog2 = blkHeightLog2 = 3;
+    break;
+  case GX_TF_I8:
+    pack = PackI8;
+    blkWidthLog2 = 3;
+    break;
+  case GX_TF_IA4:
+    pack = PackIA4;
+    blkWidthLog2 = 3;
+    break;
+  case GX_CTF_RA4:
+    pack = PackRA4;
+    blkWidthLog2 = 3;
+    break;
+  case GX_CTF_A8:
+    pack = PackChannel8<&BlockTexels::a>;
+    blkWidthLog2 = 3;
+    break;
+  case GX_CTF_R8:
+    pack = PackChannel8<&BlockTexels::r>;
+    blkWidthLog2 = 3;
+    break;
+  case GX_CTF_G8:
+    pack = PackChannel8<&BlockTexels::g>;
+    blkWidthLog2 = 3;
+    break;
+  case GX_CTF_B8:
+    pack = PackChannel8<&BlockTexels::b>;
+    blkWidthLog2 = 3;
+    break;
+  case GX_TF_IA8:
+    pack = PackIA8;
+    break;
+  case GX_CTF_RA8:
+    pack = PackChannels16<&BlockTexels::a, &BlockTexels::r>;
+    break;
+  case GX_CTF_RG8:
+    pack = PackChannels16<&BlockTexels::g, &BlockTexels::r>;
+    break;
+  case GX_CTF_GB8:
+    pack = PackChannels16<&BlockTexels::b, &BlockTexels::g>;
+    break;
+  case GX_TF_RGB565:
+    pack = PackRGB565;
+    break;
+  case GX_TF_RGB5A3:
+    pack = PackRGB5A3;
+    break;
+  case GX_TF_RGBA8:
+    pack = PackRGBA8;
+    blockBytes = 64;
+    break;
+  default:
+    return false;
+  }
+
+  u16 sBlkCount, tBlkCount, sBlkSize, tBlkSize;
+  SetBlockDimensions(blkWidthLog2, blkHeightLog2, &sBlkCount, &tBlkCount, &sBlkSize, &tBlkSize);
+
+  const u32 readStride = 3 << halfscale;
+  const s32 writeStride = bpmem.copyMipMapStrideChannels * 32;
+
+  BlockTexels texels;
+  for (int tBlk = 0; tBlk < tBlkCount; tBlk++)
+  {
+    const u8* blockSrc = src + tBlk * tBlkSize * EFB_WIDTH * readStride;
+    for (int sBlk = 0; sBlk < sBlkCount; sBlk++)
+    {
+      fetch(blockSrc + sBlk * sBlkSize * readStride, sBlkSize, tBlkSize, &texels);
+      pack(texels, dst + sBlk * blockBytes);
+    }
+    dst += writeStride;
+  }
+
+  return true;
+}
+
+#endif
+
+void Encode(u8* dest_ptr)
+{
+#ifdef _M_X86
+  auto pixelformat = bpmem.zcontrol.pixel_format;
+  bool bFromZBuffer = pixelformat == PEControl::Z24;
+  const u8* src = EfbInterface::GetPixelPointer(bpmem.copyTexSrcXY.x, bpmem.copyTexSrcXY.y, bFromZBuffer);
+
+  if (EncodeBlocks(dest_ptr, src, GetCopyFormat(), pixelformat, bpmem.triggerEFBCopy.half_scale))
+    return;
+#endif
+
+  EncodeGeneric(dest_ptr);
+}
+
+void EncodeGeneric(u8 *dest_ptr)
+{
+  auto pixelformat = bpmem.zcontrol.pixel_format;
+  bool bFromZBuffer = pixelformat == PEControl::Z24;
+  u32 format = GetCopyFormat();
+
   u8 *src = EfbInterface::GetPixelPointer(bpmem.copyTexSrcXY.x, bpmem.copyTexSrcXY.y, bFromZBuffer);
 
   if (bpmem.triggerEFBCopy.half_scale)
@@ -9,4 +9,7 @@
 namespace TextureEncoder
 {
 void Encode(u8 *dest_ptr);
+
+// Encodes one texel at a time, Encode() falls back to this for formats without vectorized encoders
+void EncodeGeneric(u8 *dest_ptr);
 }
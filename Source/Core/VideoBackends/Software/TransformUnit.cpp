@@ -4,8 +4,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/MathUtil.h"
 #include "Common/Swap.h"
 
@@ -104,28 +106,27 @@ void TransformNormal(const InputVertexData *src, bool nbt, OutputVertexData *dst
   }
 }
 
-static void TransformTexCoordRegular(const TexMtxInfo &texinfo, int coordNum, bool specialCase, const InputVertexData *srcVertex, OutputVertexData *dstVertex)
+static const Vec3 *GetTexCoordSource(const TexMtxInfo &texinfo, const InputVertexData *srcVertex)
 {
-  const Vec3 *src;
   switch (texinfo.sourcerow)
   {
   case XF_SRCGEOM_INROW:
-    src = &srcVertex->position;
-    break;
+    return &srcVertex->position;
   case XF_SRCNORMAL_INROW:
-    src = &srcVertex->normal[0];
-    break;
+    return &srcVertex->normal[0];
   case XF_SRCBINORMAL_T_INROW:
-    src = &srcVertex->normal[1];
-    break;
+    return &srcVertex->normal[1];
   case XF_SRCBINORMAL_B_INROW:
-    src = &srcVertex->normal[2];
-    break;
+    return &srcVertex->normal[2];
   default:
     ASSERT(texinfo.sourcerow >= XF_SRCTEX0_INROW && texinfo.sourcerow <= XF_SRCTEX7_INROW);
-    src = (Vec3*)srcVertex->texCoords[texinfo.sourcerow - XF_SRCTEX0_INROW];
-    break;
+    return (const Vec3*)srcVertex->texCoords[texinfo.sourcerow - XF_SRCTEX0_INROW];
   }
+}
+
+static void TransformTexCoordRegular(const TexMtxInfo &texinfo, int coordNum, bool specialCase, const InputVertexData *srcVertex, OutputVertexData *dstVertex)
+{
+  const Vec3 *src = GetTexCoordSource(texinfo, srcVertex);
 
   const float* mat = &xfmem.posMatrices[srcVertex->texMtx[coordNum] * 4];
   Vec3* dst = &dstVertex->texCoords[coordNum];
@@ -296,6 +297,12 @@ static void LightAlpha(const Vec3 &pos, const Vec3 &normal, u8 lightNum, const L
   }
 }
 
+static u8 ModulateColor(u8 matColor, float lightColor)
+{
+  int light = MathUtil::Clamp(static_cast<int>(lightColor), 0, 255);
+  return (matColor * (light + (light >> 7))) >> 8;
+}
+
 void TransformColor(const InputVertexData *src, OutputVertexData *dst)
 {
   for (u32 chan = 0; chan < xfmem.numChan.numColorChans; chan++)
@@ -336,12 +343,9 @@ void TransformColor(const InputVertexData *src, OutputVertexData *dst)
           LightColor(dst->mvPosition, dst->normal[0], i, colorchan, lightCol);
       }
 
-      int light_x = MathUtil::Clamp(static_cast<int>(lightCol.x), 0, 255);
-      int light_y = MathUtil::Clamp(static_cast<int>(lightCol.y), 0, 255);
-      int light_z = MathUtil::Clamp(static_cast<int>(lightCol.z), 0, 255);
-      chancolor[1] = (matcolor[1] * (light_x + (light_x >> 7))) >> 8;
-      chancolor[2] = (matcolor[2] * (light_y + (light_y >> 7))) >> 8;
-      chancolor[3] = (matcolor[3] * (light_z + (light_z >> 7))) >> 8;
+      chancolor[1] = ModulateColor(matcolor[1], lightCol.x);
+      chancolor[2] = ModulateColor(matcolor[2], lightCol.y);
+      chancolor[3] = ModulateColor(matcolor[3], lightCol.z);
     }
     else
     {
@@ -370,8 +374,7 @@ void TransformColor(const InputVertexData *src, OutputVertexData *dst)
           LightAlpha(dst->mvPosition, dst->normal[0], i, alphachan, lightCol);
       }
 
-      int light_a = MathUtil::Clamp(static_cast<int>(lightCol), 0, 255);
-      chancolor[0] = (matcolor[0] * (light_a + (light_a >> 7))) >> 8;
+      chancolor[0] = ModulateColor(matcolor[0], lightCol);
     }
     else
     {
@@ -383,54 +386,568 @@ void TransformColor(const InputVertexData *src, OutputVertexData *dst)
   }
 }
 
+static void TransformTexCoordGenerated(const TexMtxInfo &texinfo, u32 coordNum, OutputVertexData *dst)
+{
+  switch (texinfo.texgentype)
+  {
+  case XF_TEXGEN_EMBOSS_MAP:
+  {
+    const LightPointer *light = (const LightPointer*)&xfmem.lights[texinfo.embosslightshift];
+
+    Vec3 ldir = (light->pos - dst->mvPosition).Normalized();
+    float d1 = ldir * dst->normal[1];
+    float d2 = ldir * dst->normal[2];
+
+    dst->texCoords[coordNum].x = dst->texCoords[texinfo.embosssourceshift].x + d1;
+    dst->texCoords[coordNum].y = dst->texCoords[texinfo.embosssourceshift].y + d2;
+    dst->texCoords[coordNum].z = dst->texCoords[texinfo.embosssourceshift].z;
+  }
+  break;
+  case XF_TEXGEN_COLOR_STRGBC0:
+    ASSERT(texinfo.sourcerow == XF_SRCCOLORS_INROW);
+    ASSERT(texinfo.inputform == XF_TEXINPUT_AB11);
+    dst->texCoords[coordNum].x = (float)dst->color[0][0] / 255.0f;
+    dst->texCoords[coordNum].y = (float)dst->color[0][1] / 255.0f;
+    dst->texCoords[coordNum].z = 1.0f;
+    break;
+  case XF_TEXGEN_COLOR_STRGBC1:
+    ASSERT(texinfo.sourcerow == XF_SRCCOLORS_INROW);
+    ASSERT(texinfo.inputform == XF_TEXINPUT_AB11);
+    dst->texCoords[coordNum].x = (float)dst->color[1][0] / 255.0f;
+    dst->texCoords[coordNum].y = (float)dst->color[1][1] / 255.0f;
+    dst->texCoords[coordNum].z = 1.0f;
+    break;
+  default:
+    ERROR_LOG(VIDEO, "Bad tex gen type %i", texinfo.texgentype.Value());
+  }
+}
+
+static void ScaleTexCoords(OutputVertexData *dst)
+{
+  for (u32 coordNum = 0; coordNum < xfmem.numTexGen.numTexGens; coordNum++)
+  {
+    dst->texCoords[coordNum][0] *= (bpmem.texcoords[coordNum].s.scale_minus_1 + 1);
+    dst->texCoords[coordNum][1] *= (bpmem.texcoords[coordNum].t.scale_minus_1 + 1);
+  }
+}
+
 void TransformTexCoord(const InputVertexData *src, OutputVertexData *dst, bool specialCase)
 {
   for (u32 coordNum = 0; coordNum < xfmem.numTexGen.numTexGens; coordNum++)
   {
     const TexMtxInfo &texinfo = xfmem.texMtxInfo[coordNum];
 
-    switch (texinfo.texgentype)
-    {
-    case XF_TEXGEN_REGULAR:
+    if (texinfo.texgentype == XF_TEXGEN_REGULAR)
       TransformTexCoordRegular(texinfo, coordNum, specialCase, src, dst);
-      break;
-    case XF_TEXGEN_EMBOSS_MAP:
+    else
+      TransformTexCoordGenerated(texinfo, coordNum, dst);
+  }
+
+  ScaleTexCoords(dst);
+}
+
+#ifdef _M_X86
+
+// Four vertices in structure-of-arrays form, one per lane. The batched functions repeat the
+// arithmetic of the scalar ones operation for operation, so both paths round identically.
+// Batches of fewer than four vertices repeat the last vertex in the unused lanes.
+struct Vec3x4
+{
+  __m128 x, y, z;
+};
+
+template <typename GetVector>
+static Vec3x4 GatherVec3(int count, GetVector get)
+{
+  const Vec3 a = get(0);
+  const Vec3 b = get(std::min(1, count - 1));
+  const Vec3 c = get(std::min(2, count - 1));
+  const Vec3 d = get(std::min(3, count - 1));
+  return {_mm_setr_ps(a.x, b.x, c.x, d.x), _mm_setr_ps(a.y, b.y, c.y, d.y),
+          _mm_setr_ps(a.z, b.z, c.z, d.z)};
+}
+
+template <typename GetVector>
+static void ScatterVec3(const Vec3x4 &vec, int count, GetVector get)
+{
+  alignas(16) float x[4], y[4], z[4];
+  _mm_store_ps(x, vec.x);
+  _mm_store_ps(y, vec.y);
+  _mm_store_ps(z, vec.z);
+  for (int i = 0; i < count; ++i)
+    get(i) = Vec3(x[i], y[i], z[i]);
+}
+
+static Vec3x4 Broadcast(const Vec3 &vec)
+{
+  return {_mm_set1_ps(vec.x), _mm_set1_ps(vec.y), _mm_set1_ps(vec.z)};
+}
+
+// Element index of each lane's matrix.
+static __m128 GatherMatrix(const float *const mat[4], int index)
+{
+  return _mm_setr_ps(mat[0][index], mat[1][index], mat[2][index], mat[3][index]);
+}
+
+static __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static __m128 Dot(const Vec3x4 &a, const Vec3x4 &b)
+{
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+}
+
+static Vec3x4 Subtract(const Vec3x4 &a, const Vec3x4 &b)
+{
+  return {_mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z)};
+}
+
+// Like Vec3::operator/, multiplies by the reciprocal.
+static Vec3x4 Divide(const Vec3x4 &vec, __m128 f)
+{
+  const __m128 invf = _mm_div_ps(_mm_set1_ps(1.0f), f);
+  return {_mm_mul_ps(vec.x, invf), _mm_mul_ps(vec.y, invf), _mm_mul_ps(vec.z, invf)};
+}
+
+static Vec3x4 Normalized(const Vec3x4 &vec)
+{
+  return Divide(vec, _mm_sqrt_ps(Dot(vec, vec)));
+}
+
+// std::max(0.0f, value), including its handling of NaN and negative zero.
+static __m128 MaxZero(__m128 value)
+{
+  return _mm_max_ps(value, _mm_setzero_ps());
+}
+
+static __m128 SafeDivide(__m128 n, __m128 d)
+{
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 sign = _mm_and_ps(_mm_cmpgt_ps(n, zero), _mm_set1_ps(1.0f));
+  return Select(_mm_cmpeq_ps(d, zero), sign, _mm_div_ps(n, d));
+}
+
+static __m128 MultiplyRow2(const Vec3x4 &vec, const float *const mat[4], int row)
+{
+  return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(GatherMatrix(mat, row), vec.x),
+                                          _mm_mul_ps(GatherMatrix(mat, row + 1), vec.y)),
+                               GatherMatrix(mat, row + 2)),
+                    GatherMatrix(mat, row + 3));
+}
+
+static __m128 MultiplyRow3(const Vec3x4 &vec, const float *const mat[4], int row)
+{
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(GatherMatrix(mat, row), vec.x),
+                               _mm_mul_ps(GatherMatrix(mat, row + 1), vec.y)),
+                    _mm_mul_ps(GatherMatrix(mat, row + 2), vec.z));
+}
+
+static __m128 MultiplyRow3Translate(const Vec3x4 &vec, const float *const mat[4], int row)
+{
+  return _mm_add_ps(MultiplyRow3(vec, mat, row), GatherMatrix(mat, row + 3));
+}
+
+static Vec3x4 MultiplyVec2Mat24(const Vec3x4 &vec, const float *const mat[4])
+{
+  return {MultiplyRow2(vec, mat, 0), MultiplyRow2(vec, mat, 4), _mm_set1_ps(1.0f)};
+}
+
+static Vec3x4 MultiplyVec2Mat34(const Vec3x4 &vec, const float *const mat[4])
+{
+  return {MultiplyRow2(vec, mat, 0), MultiplyRow2(vec, mat, 4), MultiplyRow2(vec, mat, 8)};
+}
+
+static Vec3x4 MultiplyVec3Mat33(const Vec3x4 &vec, const float *const mat[4])
+{
+  return {MultiplyRow3(vec, mat, 0), MultiplyRow3(vec, mat, 3), MultiplyRow3(vec, mat, 6)};
+}
+
+static Vec3x4 MultiplyVec3Mat24(const Vec3x4 &vec, const float *const mat[4])
+{
+  return {MultiplyRow3Translate(vec, mat, 0), MultiplyRow3Translate(vec, mat, 4),
+          _mm_set1_ps(1.0f)};
+}
+
+static Vec3x4 MultiplyVec3Mat34(const Vec3x4 &vec, const float *const mat[4])
+{
+  return {MultiplyRow3Translate(vec, mat, 0), MultiplyRow3Translate(vec, mat, 4),
+          MultiplyRow3Translate(vec, mat, 8)};
+}
+
+void TransformPositionBatch(const InputVertexData *src, OutputVertexData *dst, int count)
+{
+  const float *mat[4];
+  for (int i = 0; i < 4; ++i)
+    mat[i] = &xfmem.posMatrices[src[std::min(i, count - 1)].posMtx * 4];
+
+  const Vec3x4 position = GatherVec3(count, [&](int i) { return src[i].position; });
+  const Vec3x4 mv = MultiplyVec3Mat34(position, mat);
+  ScatterVec3(mv, count, [&](int i) -> Vec3 & { return dst[i].mvPosition; });
+
+  const float *proj = xfmem.projection.rawProjection;
+  __m128 projected[4];
+  if (xfmem.projection.type == GX_PERSPECTIVE)
+  {
+    projected[0] =
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), mv.x), _mm_mul_ps(_mm_set1_ps(proj[1]), mv.z));
+    projected[1] =
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), mv.y), _mm_mul_ps(_mm_set1_ps(proj[3]), mv.z));
+    projected[2] = _mm_mul_ps(
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), mv.z), _mm_set1_ps(proj[5])),
+        _mm_set1_ps(1.0f - (float)1e-7));
+    projected[3] = _mm_xor_ps(mv.z, _mm_set1_ps(-0.0f));
+  }
+  else
+  {
+    projected[0] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), mv.x), _mm_set1_ps(proj[1]));
+    projected[1] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), mv.y), _mm_set1_ps(proj[3]));
+    projected[2] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), mv.z), _mm_set1_ps(proj[5]));
+    projected[3] = _mm_set1_ps(1.0f);
+  }
+
+  alignas(16) float out[4][4];
+  for (int component = 0; component < 4; ++component)
+    _mm_store_ps(out[component], projected[component]);
+  for (int i = 0; i < count; ++i)
+    dst[i].projectedPosition = {out[0][i], out[1][i], out[2][i], out[3][i]};
+}
+
+void TransformNormalBatch(const InputVertexData *src, bool nbt, OutputVertexData *dst, int count)
+{
+  const float *mat[4];
+  for (int i = 0; i < 4; ++i)
+    mat[i] = &xfmem.normalMatrices[(src[std::min(i, count - 1)].posMtx & 31) * 3];
+
+  for (int n = 0; n < (nbt ? 3 : 1); ++n)
+  {
+    const Vec3x4 normal = GatherVec3(count, [&](int i) { return src[i].normal[n]; });
+    Vec3x4 result = MultiplyVec3Mat33(normal, mat);
+    if (n == 0)
+      result = Normalized(result);
+    ScatterVec3(result, count, [&](int i) -> Vec3 & { return dst[i].normal[n]; });
+  }
+}
+
+static __m128 CalculateLightAttnBatch(const LightPointer *light, Vec3x4 *ldir,
+                                      const Vec3x4 &normal, const LitChannel &chan)
+{
+  __m128 attn = _mm_set1_ps(1.0f);
+
+  switch (chan.attnfunc)
+  {
+  case LIGHTATTN_NONE:
+  case LIGHTATTN_DIR:
+  {
+    *ldir = Normalized(*ldir);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 is_zero = _mm_and_ps(_mm_and_ps(_mm_cmpeq_ps(ldir->x, zero),
+                                                 _mm_cmpeq_ps(ldir->y, zero)),
+                                      _mm_cmpeq_ps(ldir->z, zero));
+    ldir->x = Select(is_zero, normal.x, ldir->x);
+    ldir->y = Select(is_zero, normal.y, ldir->y);
+    ldir->z = Select(is_zero, normal.z, ldir->z);
+    break;
+  }
+  case LIGHTATTN_SPEC:
+  {
+    *ldir = Normalized(*ldir);
+    const __m128 facing = _mm_cmpge_ps(Dot(*ldir, normal), _mm_setzero_ps());
+    attn = _mm_and_ps(facing, MaxZero(Dot(Broadcast(light->dir), normal)));
+    const __m128 attn2 = _mm_mul_ps(attn, attn);
+    const Vec3 cosAttn = light->cosatt;
+    Vec3 distAttn = light->distatt;
+    if (chan.diffusefunc != LIGHTDIF_NONE)
+      distAttn = distAttn.Normalized();
+
+    // Dot products with (1, attn, attn * attn).
+    const __m128 cosDot =
+        _mm_add_ps(_mm_add_ps(_mm_set1_ps(cosAttn.x), _mm_mul_ps(attn, _mm_set1_ps(cosAttn.y))),
+                   _mm_mul_ps(attn2, _mm_set1_ps(cosAttn.z)));
+    const __m128 distDot =
+        _mm_add_ps(_mm_add_ps(_mm_set1_ps(distAttn.x), _mm_mul_ps(attn, _mm_set1_ps(distAttn.y))),
+                   _mm_mul_ps(attn2, _mm_set1_ps(distAttn.z)));
+    attn = SafeDivide(MaxZero(cosDot), distDot);
+    break;
+  }
+  case LIGHTATTN_SPOT:
+  {
+    const __m128 dist2 = Dot(*ldir, *ldir);
+    const __m128 dist = _mm_sqrt_ps(dist2);
+    *ldir = Divide(*ldir, dist);
+    attn = MaxZero(Dot(*ldir, Broadcast(light->dir)));
+
+    const __m128 cosAtt = _mm_add_ps(
+        _mm_add_ps(_mm_set1_ps(light->cosatt.x), _mm_mul_ps(_mm_set1_ps(light->cosatt.y), attn)),
+        _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(light->cosatt.z), attn), attn));
+    const __m128 distAtt = _mm_add_ps(
+        _mm_add_ps(_mm_set1_ps(light->distatt.x), _mm_mul_ps(_mm_set1_ps(light->distatt.y), dist)),
+        _mm_mul_ps(_mm_set1_ps(light->distatt.z), dist2));
+    attn = SafeDivide(MaxZero(cosAtt), distAtt);
+    break;
+  }
+  default:
+    PanicAlert("LightColor");
+  }
+
+  return attn;
+}
+
+static void AddScaledIntegerColor(const u8 *src, __m128 scale, Vec3x4 &dst)
+{
+  dst.x = _mm_add_ps(dst.x, _mm_mul_ps(_mm_set1_ps(src[1]), scale));
+  dst.y = _mm_add_ps(dst.y, _mm_mul_ps(_mm_set1_ps(src[2]), scale));
+  dst.z = _mm_add_ps(dst.z, _mm_mul_ps(_mm_set1_ps(src[3]), scale));
+}
+
+static void LightColorBatch(const Vec3x4 &pos, const Vec3x4 &normal, u8 lightNum,
+                            const LitChannel &chan, Vec3x4 &lightCol)
+{
+  const LightPointer *light = (const LightPointer*)&xfmem.lights[lightNum];
+
+  Vec3x4 ldir = Subtract(Broadcast(light->pos), pos);
+  __m128 attn = CalculateLightAttnBatch(light, &ldir, normal, chan);
+
+  __m128 difAttn = Dot(ldir, normal);
+  switch (chan.diffusefunc)
+  {
+  case LIGHTDIF_NONE:
+    AddScaledIntegerColor(light->color, attn, lightCol);
+    break;
+  case LIGHTDIF_SIGN:
+    AddScaledIntegerColor(light->color, _mm_mul_ps(attn, difAttn), lightCol);
+    break;
+  case LIGHTDIF_CLAMP:
+    difAttn = MaxZero(difAttn);
+    AddScaledIntegerColor(light->color, _mm_mul_ps(attn, difAttn), lightCol);
+    break;
+  default: ASSERT(0);
+  }
+}
+
+static void LightAlphaBatch(const Vec3x4 &pos, const Vec3x4 &normal, u8 lightNum,
+                            const LitChannel &chan, __m128 &lightCol)
+{
+  const LightPointer *light = (const LightPointer*)&xfmem.lights[lightNum];
+
+  Vec3x4 ldir = Subtract(Broadcast(light->pos), pos);
+  __m128 attn = CalculateLightAttnBatch(light, &ldir, normal, chan);
+
+  __m128 difAttn = Dot(ldir, normal);
+  const __m128 color = _mm_set1_ps(light->color[0]);
+  switch (chan.diffusefunc)
+  {
+  case LIGHTDIF_NONE:
+    lightCol = _mm_add_ps(lightCol, _mm_mul_ps(color, attn));
+    break;
+  case LIGHTDIF_SIGN:
+    lightCol = _mm_add_ps(lightCol, _mm_mul_ps(_mm_mul_ps(color, attn), difAttn));
+    break;
+  case LIGHTDIF_CLAMP:
+    difAttn = MaxZero(difAttn);
+    lightCol = _mm_add_ps(lightCol, _mm_mul_ps(_mm_mul_ps(color, attn), difAttn));
+    break;
+  default: ASSERT(0);
+  }
+}
+
+void TransformColorBatch(const InputVertexData *src, OutputVertexData *dst, int count)
+{
+  const Vec3x4 pos = GatherVec3(count, [&](int i) { return dst[i].mvPosition; });
+  const Vec3x4 normal = GatherVec3(count, [&](int i) { return dst[i].normal[0]; });
+
+  for (u32 chan = 0; chan < xfmem.numChan.numColorChans; chan++)
+  {
+    // abgr, one per lane
+    u8 matcolor[4][4];
+    u8 chancolor[4][4];
+
+    // color
+    const LitChannel &colorchan = xfmem.color[chan];
+    for (int i = 0; i < 4; ++i)
     {
-      const LightPointer *light = (const LightPointer*)&xfmem.lights[texinfo.embosslightshift];
+      const InputVertexData &vertex = src[std::min(i, count - 1)];
+      if (colorchan.matsource)
+        std::memcpy(matcolor[i], vertex.color[chan], 4);  // vertex
+      else
+        std::memcpy(matcolor[i], &xfmem.matColor[chan], 4);
+    }
 
-      Vec3 ldir = (light->pos - dst->mvPosition).Normalized();
-      float d1 = ldir * dst->normal[1];
-      float d2 = ldir * dst->normal[2];
+    if (colorchan.enablelighting)
+    {
+      alignas(16) float ambient[3][4];
+      for (int i = 0; i < 4; ++i)
+      {
+        const u8 *ambColor = colorchan.ambsource ? src[std::min(i, count - 1)].color[chan] :
+                                                   (const u8*)&xfmem.ambColor[chan];
+        ambient[0][i] = ambColor[1];
+        ambient[1][i] = ambColor[2];
+        ambient[2][i] = ambColor[3];
+      }
+      Vec3x4 lightCol = {_mm_load_ps(ambient[0]), _mm_load_ps(ambient[1]),
+                         _mm_load_ps(ambient[2])};
 
-      dst->texCoords[coordNum].x = dst->texCoords[texinfo.embosssourceshift].x + d1;
-      dst->texCoords[coordNum].y = dst->texCoords[texinfo.embosssourceshift].y + d2;
-      dst->texCoords[coordNum].z = dst->texCoords[texinfo.embosssourceshift].z;
+      u8 mask = colorchan.GetFullLightMask();
+      for (int i = 0; i < 8; ++i)
+      {
+        if (mask&(1 << i))
+          LightColorBatch(pos, normal, i, colorchan, lightCol);
+      }
+
+      _mm_store_ps(ambient[0], lightCol.x);
+      _mm_store_ps(ambient[1], lightCol.y);
+      _mm_store_ps(ambient[2], lightCol.z);
+      for (int i = 0; i < count; ++i)
+      {
+        chancolor[i][1] = ModulateColor(matcolor[i][1], ambient[0][i]);
+        chancolor[i][2] = ModulateColor(matcolor[i][2], ambient[1][i]);
+        chancolor[i][3] = ModulateColor(matcolor[i][3], ambient[2][i]);
+      }
     }
-    break;
-    case XF_TEXGEN_COLOR_STRGBC0:
-      ASSERT(texinfo.sourcerow == XF_SRCCOLORS_INROW);
-      ASSERT(texinfo.inputform == XF_TEXINPUT_AB11);
-      dst->texCoords[coordNum].x = (float)dst->color[0][0] / 255.0f;
-      dst->texCoords[coordNum].y = (float)dst->color[0][1] / 255.0f;
-      dst->texCoords[coordNum].z = 1.0f;
-      break;
-    case XF_TEXGEN_COLOR_STRGBC1:
-      ASSERT(texinfo.sourcerow == XF_SRCCOLORS_INROW);
-      ASSERT(texinfo.inputform == XF_TEXINPUT_AB11);
-      dst->texCoords[coordNum].x = (float)dst->color[1][0] / 255.0f;
-      dst->texCoords[coordNum].y = (float)dst->color[1][1] / 255.0f;
-      dst->texCoords[coordNum].z = 1.0f;
-      break;
-    default:
-      ERROR_LOG(VIDEO, "Bad tex gen type %i", texinfo.texgentype.Value());
+    else
+    {
+      std::memcpy(chancolor, matcolor, sizeof(chancolor));
+    }
+
+    // alpha
+    const LitChannel &alphachan = xfmem.alpha[chan];
+    for (int i = 0; i < 4; ++i)
+    {
+      if (alphachan.matsource)
+        matcolor[i][0] = src[std::min(i, count - 1)].color[chan][0];  // vertex
+      else
+        matcolor[i][0] = xfmem.matColor[chan] & 0xff;
     }
+
+    if (alphachan.enablelighting)
+    {
+      alignas(16) float ambient[4];
+      for (int i = 0; i < 4; ++i)
+      {
+        if (alphachan.ambsource)
+          ambient[i] = src[std::min(i, count - 1)].color[chan][0];  // vertex
+        else
+          ambient[i] = (float)(xfmem.ambColor[chan] & 0xff);
+      }
+      __m128 lightCol = _mm_load_ps(ambient);
+
+      u8 mask = alphachan.GetFullLightMask();
+      for (int i = 0; i < 8; ++i)
+      {
+        if (mask&(1 << i))
+          LightAlphaBatch(pos, normal, i, alphachan, lightCol);
+      }
+
+      _mm_store_ps(ambient, lightCol);
+      for (int i = 0; i < count; ++i)
+        chancolor[i][0] = ModulateColor(matcolor[i][0], ambient[i]);
+    }
+    else
+    {
+      for (int i = 0; i < count; ++i)
+        chancolor[i][0] = matcolor[i][0];
+    }
+
+    // abgr -> rgba
+    for (int i = 0; i < count; ++i)
+      *(u32*)dst[i].color[chan] = Common::swap32(*(u32*)chancolor[i]);
   }
+}
 
+static void TransformTexCoordRegularBatch(const TexMtxInfo &texinfo, int coordNum,
+                                          bool specialCase, const InputVertexData *srcVertex,
+                                          OutputVertexData *dstVertex, int count)
+{
+  const Vec3x4 src =
+      GatherVec3(count, [&](int i) { return *GetTexCoordSource(texinfo, &srcVertex[i]); });
+
+  const float *mat[4];
+  for (int i = 0; i < 4; ++i)
+    mat[i] = &xfmem.posMatrices[srcVertex[std::min(i, count - 1)].texMtx[coordNum] * 4];
+
+  Vec3x4 dst;
+  if (texinfo.projection == XF_TEXPROJ_ST)
+  {
+    if (texinfo.inputform == XF_TEXINPUT_AB11 || specialCase)
+      dst = MultiplyVec2Mat24(src, mat);
+    else
+      dst = MultiplyVec3Mat24(src, mat);
+  }
+  else // texinfo.projection == XF_TEXPROJ_STQ
+  {
+    ASSERT(!specialCase);
+
+    if (texinfo.inputform == XF_TEXINPUT_AB11)
+      dst = MultiplyVec2Mat34(src, mat);
+    else
+      dst = MultiplyVec3Mat34(src, mat);
+  }
+
+  if (xfmem.dualTexTrans.enabled)
+  {
+    const PostMtxInfo &postInfo = xfmem.postMtxInfo[coordNum];
+    const float *postMat = &xfmem.postMatrices[postInfo.index * 4];
+    const float *const postMats[4] = {postMat, postMat, postMat, postMat};
+
+    if (specialCase)
+      dst = MultiplyVec2Mat24(dst, postMats);
+    else
+      dst = MultiplyVec3Mat34(postInfo.normalize ? Normalized(dst) : dst, postMats);
+  }
+
+  ScatterVec3(dst, count, [&](int i) -> Vec3 & { return dstVertex[i].texCoords[coordNum]; });
+}
+
+void TransformTexCoordBatch(const InputVertexData *src, OutputVertexData *dst, bool specialCase,
+                            int count)
+{
   for (u32 coordNum = 0; coordNum < xfmem.numTexGen.numTexGens; coordNum++)
   {
-    dst->texCoords[coordNum][0] *= (bpmem.texcoords[coordNum].s.scale_minus_1 + 1);
-    dst->texCoords[coordNum][1] *= (bpmem.texcoords[coordNum].t.scale_minus_1 + 1);
+    const TexMtxInfo &texinfo = xfmem.texMtxInfo[coordNum];
+
+    if (texinfo.texgentype == XF_TEXGEN_REGULAR)
+    {
+      TransformTexCoordRegularBatch(texinfo, coordNum, specialCase, src, dst, count);
+    }
+    else
+    {
+      for (int i = 0; i < count; ++i)
+        TransformTexCoordGenerated(texinfo, coordNum, &dst[i]);
+    }
   }
+
+  for (int i = 0; i < count; ++i)
+    ScaleTexCoords(&dst[i]);
 }
 
+#else
+
+void TransformPositionBatch(const InputVertexData *src, OutputVertexData *dst, int count)
+{
+  for (int i = 0; i < count; ++i)
+    TransformPosition(&src[i], &dst[i]);
+}
+
+void TransformNormalBatch(const InputVertexData *src, bool nbt, OutputVertexData *dst, int count)
+{
+  for (int i = 0; i < count; ++i)
+    TransformNormal(&src[i], nbt, &dst[i]);
+}
+
+void TransformColorBatch(const InputVertexData *src, OutputVertexData *dst, int count)
+{
+  for (int i = 0; i < count; ++i)
+    TransformColor(&src[i], &dst[i]);
+}
+
+void TransformTexCoordBatch(const InputVertexData *src, OutputVertexData *dst, bool specialCase,
+                            int count)
+{
+  for (int i = 0; i < count; ++i)
+    TransformTexCoord(&src[i], &dst[i], specialCase);
+}
+
+#endif
+
 }
@@ -9,8 +9,19 @@ struct OutputVertexData;
 
 namespace TransformUnit
 {
+// Number of vertices the batched functions transform at once.
+constexpr int VERTEX_BATCH_SIZE = 4;
+
 void TransformPosition(const InputVertexData *src, OutputVertexData *dst);
 void TransformNormal(const InputVertexData *src, bool nbt, OutputVertexData *dst);
 void TransformColor(const InputVertexData *src, OutputVertexData *dst);
 void TransformTexCoord(const InputVertexData *src, OutputVertexData *dst, bool specialCase);
+
+// Transform the first count (at most VERTEX_BATCH_SIZE) vertices of src into dst. The results are
+// bit-identical to calling the functions above on every vertex.
+void TransformPositionBatch(const InputVertexData *src, OutputVertexData *dst, int count);
+void TransformNormalBatch(const InputVertexData *src, bool nbt, OutputVertexData *dst, int count);
+void TransformColorBatch(const InputVertexData *src, OutputVertexData *dst, int count);
+void TransformTexCoordBatch(const InputVertexData *src, OutputVertexData *dst, bool specialCase,
+                            int count);
 }
@@ -14,6 +14,7 @@
 #include "Common/CommonFuncs.h"
 #include "Common/LinearDiskCache.h"
 #include "Common/MsgHandler.h"
+#include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Host.h"
@@ -605,29 +606,24 @@ void ShaderCache::SavePipelineCache()
   disk_cache.Close();
 }
 
-/// Cache inserter that is called back when reading from the file
-template <typename Uid, typename UidHasher>
-struct ShaderUsageCacheReader : public LinearDiskCacheReader<Uid, u32>
+/// Cache inserter that is called back when reading from the file. The modules are only created
+/// once the shaders are loaded in order of use, see CompileShaders.
+template <typename T>
+struct ShaderUsageCacheReader : public LinearDiskCacheReader<typename T::uid_type, u32>
 {
-  ShaderUsageCacheReader(ObjectUsageProfiler<Uid, pKey_t, ShaderCache::vkShaderItem, UidHasher>* shader_map) : m_shader_map(shader_map) {}
+  using Uid = typename T::uid_type;
+  ShaderUsageCacheReader(T& cache) : m_cache(cache) {}
   void Read(const Uid& key, const u32* value, u32 value_size) override
   {
-    // We don't insert null modules into the shader map since creation could succeed later on.
-    // e.g. we're generating bad code, but fix this in a later version, and for some reason
-    // the cache is not invalidated.
-    VkShaderModule module = Util::CreateShaderModule(value, value_size);
-    if (module == VK_NULL_HANDLE)
-      return;
     Uid item = key;
     item.ClearHASH();
     item.CalculateUIDHash();
-    ShaderCache::vkShaderItem& it = m_shader_map->GetOrAdd(key);
-    it.initialized.test_and_set();
-    it.compiled = true;
-    it.module = module;
+    ShaderCache::vkShaderItem& it = m_cache.shader_map->GetOrAddUncounted(item);
+    it.spirv.assign(value, value + value_size);
+    m_cache.cached_uids.push_back(item);
   }
 
-  ObjectUsageProfiler<Uid, pKey_t, ShaderCache::vkShaderItem, UidHasher>* m_shader_map;
+  T& m_cache;
 };
 
 template <typename Uid, typename UidHasher>
@@ -671,10 +667,10 @@ void ShaderCache::LoadShaderCaches(bool forcecompile)
     StringFromFormat("%s.ps", SConfig::GetInstance().GetGameID().c_str())
   ));
 
-  ShaderUsageCacheReader<VertexShaderUid, VertexShaderUid::ShaderUidHasher> vs_reader(m_vs_cache.shader_map.get());
+  ShaderUsageCacheReader<VShaderCache> vs_reader(m_vs_cache);
   m_vs_cache.disk_cache.OpenAndRead(GetDiskShaderCacheFileName(API_VULKAN, "vs", true, true), vs_reader);
 
-  ShaderUsageCacheReader<PixelShaderUid, PixelShaderUid::ShaderUidHasher> ps_reader(m_ps_cache.shader_map.get());
+  ShaderUsageCacheReader<PShaderCache> ps_reader(m_ps_cache);
   m_ps_cache.disk_cache.OpenAndRead(GetDiskShaderCacheFileName(API_VULKAN, "ps", true, true), ps_reader);
 
   if (g_vulkan_context->SupportsGeometryShaders())
@@ -693,10 +689,8 @@ void ShaderCache::LoadShaderCaches(bool forcecompile)
   {
     CompileUberShaders();
   }
-  if ((g_ActiveConfig.bCompileShaderOnStartup || forcecompile) && !g_ActiveConfig.bDisableSpecializedShaders)
-  {
-    CompileShaders();
-  }
+  CompileShaders(g_ActiveConfig.bCompileShaderOnStartup || forcecompile);
+  StartShaderLoaderThreads();
 
   SETSTAT(stats.numVertexShadersCreated, static_cast<int>(m_vs_cache.shader_map->size()));
   SETSTAT(stats.numVertexShadersAlive, static_cast<int>(m_vs_cache.shader_map->size()));
@@ -732,53 +726,87 @@ void ShaderCache::CompileUberShaders()
   Host_UpdateProgressDialog("", -1, -1);
 }
 
-void ShaderCache::CompileShaders()
+// How many of the game's most used vertex and pixel shaders are loaded before the first frame.
+constexpr size_t SYNCHRONOUS_SHADER_COUNT = 256;
+
+// Loads the shaders of a usage cache in the order of how often the current game used them. The
+// most used ones are loaded, or compiled if they aren't cached yet, before returning. The rest is
+// queued for the loader threads, followed by the cached shaders the game hasn't used so far.
+template <typename T, typename F>
+static void QueueShadersByUsage(T& cache, pKey_t gameid, bool synchronous, bool compile,
+                                const std::string& message, F load,
+                                std::vector<std::function<void()>>* background_loads)
 {
-  pKey_t gameid = (pKey_t)GetMurmurHash3(reinterpret_cast<const u8*>(SConfig::GetInstance().GetGameID().data()), (u32)SConfig::GetInstance().GetGameID().size(), 0);
-  int shader_count = 0;
-  m_vs_cache.shader_map->ForEachMostUsedByCategory(gameid,
-    [&](const VertexShaderUid& uid, size_t total)
+  using Uid = typename T::uid_type;
+  std::vector<Uid> ranked;
+  cache.shader_map->ForEachMostUsedByCategory(gameid,
+    [&](const Uid& uid, size_t)
   {
-    VertexShaderUid item = uid;
+    Uid item = uid;
     item.ClearHASH();
     item.CalculateUIDHash();
-    vkShaderItem& it = m_vs_cache.shader_map->GetOrAdd(item);
-    if (!it.initialized.test_and_set())
-    {
-      CompileVertexShaderForUid(item, it);
-      Host_UpdateProgressDialog(GetStringT("Compiling Vertex shaders...").c_str(),
-        static_cast<int>(shader_count), static_cast<int>(total));
-    }
+    ranked.push_back(item);
   },
-    [](vkShaderItem& entry)
+    [](ShaderCache::vkShaderItem& entry)
   {
     return !entry.compiled;
   }
   , true);
-  shader_count = 0;
-  m_ps_cache.shader_map->ForEachMostUsedByCategory(gameid,
-    [&](const PixelShaderUid& uid, size_t total)
+
+  const size_t sync_count = synchronous ? ranked.size() :
+                                          std::min(ranked.size(), SYNCHRONOUS_SHADER_COUNT);
+  size_t shader_count = 0;
+  for (const Uid& uid : ranked)
   {
-    PixelShaderUid item = uid;
-    item.ClearHASH();
-    item.CalculateUIDHash();
-    vkShaderItem& it = m_ps_cache.shader_map->GetOrAdd(item);
-    if (!it.initialized.test_and_set())
+    ShaderCache::vkShaderItem& it = cache.shader_map->GetOrAddUncounted(uid);
+    if (!compile && it.spirv.empty())
+      continue;
+
+    if (shader_count < sync_count)
     {
-      CompilePixelShaderForUid(item, it);
-      Host_UpdateProgressDialog(GetStringT("Compiling Pixel shaders...").c_str(),
-        static_cast<int>(shader_count), static_cast<int>(total));
+      if (!it.initialized.test_and_set())
+        load(uid, it);
+      Host_UpdateProgressDialog(message.c_str(), static_cast<int>(++shader_count),
+                                static_cast<int>(sync_count));
+      continue;
     }
-  },
-    [](vkShaderItem& entry)
+    background_loads->push_back([load, uid, &it] {
+      if (!it.initialized.test_and_set())
+        load(uid, it);
+    });
+  }
+
+  for (const Uid& uid : cache.cached_uids)
   {
-    return !entry.compiled;
+    ShaderCache::vkShaderItem& it = cache.shader_map->GetOrAddUncounted(uid);
+    background_loads->push_back([load, uid, &it] {
+      if (!it.initialized.test_and_set())
+        load(uid, it);
+    });
   }
-  , true);
+  cache.cached_uids.clear();
+}
 
-  if (g_vulkan_context->SupportsGeometryShaders())
+void ShaderCache::CompileShaders(bool synchronous)
+{
+  pKey_t gameid = (pKey_t)GetMurmurHash3(reinterpret_cast<const u8*>(SConfig::GetInstance().GetGameID().data()), (u32)SConfig::GetInstance().GetGameID().size(), 0);
+  const bool compile = !g_ActiveConfig.bDisableSpecializedShaders;
+  QueueShadersByUsage(m_vs_cache, gameid, synchronous, compile,
+                      GetStringT("Compiling Vertex shaders..."),
+                      [this](const VertexShaderUid& uid, vkShaderItem& it) {
+                        CompileVertexShaderForUid(uid, it);
+                      },
+                      &m_background_loads);
+  QueueShadersByUsage(m_ps_cache, gameid, synchronous, compile,
+                      GetStringT("Compiling Pixel shaders..."),
+                      [this](const PixelShaderUid& uid, vkShaderItem& it) {
+                        CompilePixelShaderForUid(uid, it);
+                      },
+                      &m_background_loads);
+
+  if (synchronous && compile && g_vulkan_context->SupportsGeometryShaders())
   {
-    shader_count = 0;
+    int shader_count = 0;
     EnumerateGeometryShaderUids([&](const GeometryShaderUid& uid, size_t total)
     {
       GeometryShaderUid item = uid;
@@ -834,8 +862,42 @@ static void DestroyShaderCache(T& cache)
 
 
 
+void ShaderCache::StartShaderLoaderThreads()
+{
+  if (m_background_loads.empty())
+    return;
+
+  // Loading is CPU bound, but shouldn't take over the machine while the game is running.
+  const u32 count = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+  m_next_background_load = 0;
+  for (u32 i = 0; i < count; ++i)
+  {
+    m_loader_threads.emplace_back([this] {
+      Common::SetCurrentThreadName("Shader loader");
+      while (!m_loader_exit.load(std::memory_order_relaxed))
+      {
+        const size_t index = m_next_background_load++;
+        if (index >= m_background_loads.size())
+          break;
+        m_background_loads[index]();
+      }
+    });
+  }
+}
+
+void ShaderCache::StopShaderLoaderThreads()
+{
+  m_loader_exit = true;
+  for (std::thread& thread : m_loader_threads)
+    thread.join();
+  m_loader_threads.clear();
+  m_background_loads.clear();
+  m_loader_exit = false;
+}
+
 void ShaderCache::DestroyShaderCaches()
 {
+  StopShaderLoaderThreads();
   m_vs_cache.shader_map->Persist([](VertexShaderUid &uid) {
     uid.ClearHASH();
     uid.CalculateUIDHash();
@@ -859,8 +921,28 @@ void ShaderCache::DestroyShaderCaches()
   SETSTAT(stats.numVertexShadersAlive, 0);
 }
 
+// Creates the module from the code read from the disk cache, if there is any.
+static bool CreateModuleFromCachedCode(ShaderCache::vkShaderItem& it)
+{
+  if (it.spirv.empty())
+    return false;
+
+  // Compile the shader again if creation fails, the cached code could be bad.
+  VkShaderModule module = Util::CreateShaderModule(it.spirv.data(), it.spirv.size());
+  std::vector<u32>().swap(it.spirv);
+  if (module == VK_NULL_HANDLE)
+    return false;
+
+  it.module = module;
+  it.compiled = true;
+  return true;
+}
+
 void ShaderCache::CompileVertexShaderForUid(const VertexShaderUid& uid, ShaderCache::vkShaderItem& it)
 {
+  if (CreateModuleFromCachedCode(it))
+    return;
+
   // Not in the cache, so compile the shader.
   ShaderCompiler::SPIRVCodeVector spv;
   VkShaderModule module = VK_NULL_HANDLE;
@@ -874,14 +956,15 @@ void ShaderCache::CompileVertexShaderForUid(const VertexShaderUid& uid, ShaderCa
     // Append to shader cache if it created successfully.
     if (module != VK_NULL_HANDLE)
     {
+      std::lock_guard<std::mutex> lock(m_vs_cache.disk_cache_lock);
       m_vs_cache.disk_cache.Append(uid, spv.data(), static_cast<u32>(spv.size()));
       INCSTAT(stats.numVertexShadersCreated);
       INCSTAT(stats.numVertexShadersAlive);
     }
   }
-  it.compiled = true;
   // We still insert null entries to prevent further compilation attempts.
   it.module = module;
+  it.compiled = true;
 }
 
 void ShaderCache::CompileVertexUberShaderForUid(const UberShader::VertexUberShaderUid& uid, ShaderCache::vkShaderItem& it)
@@ -902,9 +985,9 @@ void ShaderCache::CompileVertexUberShaderForUid(const UberShader::VertexUberShad
       m_vus_cache.disk_cache.Append(uid, spv.data(), static_cast<u32>(spv.size()));
     }
   }
-  it.compiled = true;
   // We still insert null entries to prevent further compilation attempts.
   it.module = module;
+  it.compiled = true;
 }
 
 void ShaderCache::CompileGeometryShaderForUid(const GeometryShaderUid& uid, ShaderCache::vkShaderItem& it)
@@ -923,13 +1006,16 @@ void ShaderCache::CompileGeometryShaderForUid(const GeometryShaderUid& uid, Shad
     if (module != VK_NULL_HANDLE)
       m_gs_cache.disk_cache.Append(uid, spv.data(), static_cast<u32>(spv.size()));
   }
-  it.compiled = true;
   // We still insert null entries to prevent further compilation attempts.
   it.module = module;
+  it.compiled = true;
 }
 
 void ShaderCache::CompilePixelShaderForUid(const PixelShaderUid& uid, ShaderCache::vkShaderItem& it)
 {
+  if (CreateModuleFromCachedCode(it))
+    return;
+
   // Not in the cache, so compile the shader.
   ShaderCompiler::SPIRVCodeVector spv;
   VkShaderModule module = VK_NULL_HANDLE;
@@ -943,14 +1029,15 @@ void ShaderCache::CompilePixelShaderForUid(const PixelShaderUid& uid, ShaderCach
     // Append to shader cache if it created successfully.
     if (module != VK_NULL_HANDLE)
     {
+      std::lock_guard<std::mutex> lock(m_ps_cache.disk_cache_lock);
       m_ps_cache.disk_cache.Append(uid, spv.data(), static_cast<u32>(spv.size()));
       INCSTAT(stats.numPixelShadersCreated);
       INCSTAT(stats.numPixelShadersAlive);
     }
   }
-  it.compiled = true;
   // We still insert null entries to prevent further compilation attempts.
   it.module = module;
+  it.compiled = true;
 }
 
 void ShaderCache::CompilePixelUberShaderForUid(const UberShader::PixelUberShaderUid& uid, ShaderCache::vkShaderItem& it)
@@ -973,16 +1060,24 @@ void ShaderCache::CompilePixelUberShaderForUid(const UberShader::PixelUberShader
       INCSTAT(stats.numPixelShadersAlive);
     }
   }
-  it.compiled = true;
   // We still insert null entries to prevent further compilation attempts.
   it.module = module;
+  it.compiled = true;
+}
+
+// A shader claimed by one of the loader threads may not be ready yet.
+static VkShaderModule WaitForModule(const ShaderCache::vkShaderItem& it)
+{
+  while (!it.compiled)
+    std::this_thread::yield();
+  return it.module;
 }
 
 VkShaderModule ShaderCache::GetVertexShaderForUid(const VertexShaderUid& uid)
 {
   vkShaderItem& it = m_vs_cache.shader_map->GetOrAdd(uid);
   if (it.initialized.test_and_set())
-    return it.module;
+    return WaitForModule(it);
 
   CompileVertexShaderForUid(uid, it);
   return it.module;
@@ -1003,7 +1098,7 @@ VkShaderModule ShaderCache::GetPixelShaderForUid(const PixelShaderUid& uid)
 {
   vkShaderItem& it = m_ps_cache.shader_map->GetOrAdd(uid);
   if (it.initialized.test_and_set())
-    return it.module;
+    return WaitForModule(it);
 
   CompilePixelShaderForUid(uid, it);
   return it.module;
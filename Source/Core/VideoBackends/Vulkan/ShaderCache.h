@@ -5,12 +5,17 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/LinearDiskCache.h"
@@ -188,15 +193,19 @@ public:
   class vkShaderItem
   {
   public:
-    bool compiled{};
+    std::atomic<bool> compiled{};
     std::atomic_flag initialized{};
     VkShaderModule module = VK_NULL_HANDLE;
+    // Code read from the disk cache which hasn't been turned into a module yet.
+    std::vector<u32> spirv;
     vkShaderItem() {}
   };
 
 private:
-  void CompileShaders();
+  void CompileShaders(bool synchronous);
   void CompileUberShaders();
+  void StartShaderLoaderThreads();
+  void StopShaderLoaderThreads();
   bool CreatePipelineCache(bool load_from_disk);
   bool ValidatePipelineCache(const u8* data, size_t data_length);
   void DestroyPipelineCache();
@@ -205,15 +214,18 @@ private:
   bool CompileSharedShaders();
   void DestroySharedShaders();
 
-  
-
   template <typename Uid, typename UidHasher>
   class ShaderUsageModuleCache
   {
   public:
+    typedef Uid uid_type;
     typedef ObjectUsageProfiler<Uid, pKey_t, vkShaderItem, UidHasher> cache_type;
     std::unique_ptr<cache_type> shader_map{};
     LinearDiskCache<Uid, u32> disk_cache{};
+    // Shaders are appended from the loader threads as well.
+    std::mutex disk_cache_lock;
+    // Uids read from the disk cache, in file order.
+    std::vector<Uid> cached_uids;
     ShaderUsageModuleCache() {}
   };
 
@@ -245,7 +257,13 @@ private:
   void CompilePixelShaderForUid(const PixelShaderUid& uid, vkShaderItem& it);
   void CompileVertexUberShaderForUid(const UberShader::VertexUberShaderUid& uid, vkShaderItem& it);
   void CompilePixelUberShaderForUid(const UberShader::PixelUberShaderUid& uid, vkShaderItem& it);
-  
+
+  // Shaders which are loaded after the first frame, most used first.
+  std::vector<std::function<void()>> m_background_loads;
+  std::atomic<size_t> m_next_background_load{};
+  std::atomic<bool> m_loader_exit{};
+  std::vector<std::thread> m_loader_threads;
+
 
   std::unordered_map<PipelineInfo, std::pair<VkPipeline, bool>, PipelineInfoHash>
       m_pipeline_objects;
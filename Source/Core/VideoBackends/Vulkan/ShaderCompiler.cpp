@@ -5,6 +5,7 @@
 #include "VideoBackends/Vulkan/ShaderCompiler.h"
 #include "VideoBackends/Vulkan/VulkanContext.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdlib>
 #include <fstream>
@@ -33,6 +34,12 @@ bool InitializeGlslang();
 // Resource limits used when compiling shaders
 static const TBuiltInResource* GetCompilerResourceLimits();
 
+// Settings used for every shader. glslang builds its built-in symbol tables for each combination.
+constexpr int DEFAULT_VERSION = 450;
+constexpr EProfile PROFILE = ECoreProfile;
+constexpr EShMessages MESSAGES =
+  static_cast<EShMessages>(EShMsgDefault | EShMsgSpvRules | EShMsgVulkanRules);
+
 // Compile a shader to SPIR-V via glslang
 static bool CompileShaderToSPV(SPIRVCodeVector* out_code, EShLanguage stage,
   const char* stage_filename, const char* source_code,
@@ -144,10 +151,6 @@ bool CompileShaderToSPV(SPIRVCodeVector* out_code, EShLanguage stage, const char
   std::unique_ptr<glslang::TShader> shader = std::make_unique<glslang::TShader>(stage);
   std::unique_ptr<glslang::TProgram> program;
   glslang::TShader::ForbidInclude includer;
-  EProfile profile = ECoreProfile;
-  EShMessages messages =
-    static_cast<EShMessages>(EShMsgDefault | EShMsgSpvRules | EShMsgVulkanRules);
-  int default_version = 450;
 
   std::string full_source_code;
   const char* pass_source_code = source_code;
@@ -164,7 +167,7 @@ bool CompileShaderToSPV(SPIRVCodeVector* out_code, EShLanguage stage, const char
   shader->setStringsWithLengths(&pass_source_code, &pass_source_code_length, 1);
 
   auto DumpBadShader = [&](const char* msg) {
-    static int counter = 0;
+    static std::atomic<int> counter{0};
     std::string filename = StringFromFormat(
       "%sbad_%s_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(), stage_filename, counter++);
 
@@ -188,7 +191,7 @@ bool CompileShaderToSPV(SPIRVCodeVector* out_code, EShLanguage stage, const char
     PanicAlert("%s (written to %s)", msg, filename.c_str());
   };
 
-  if (!shader->parse(GetCompilerResourceLimits(), default_version, profile, false, true, messages,
+  if (!shader->parse(GetCompilerResourceLimits(), DEFAULT_VERSION, PROFILE, false, true, MESSAGES,
     includer))
   {
     DumpBadShader("Failed to parse shader");
@@ -198,7 +201,7 @@ bool CompileShaderToSPV(SPIRVCodeVector* out_code, EShLanguage stage, const char
   // Even though there's only a single shader, we still need to link it to generate SPV
   program = std::make_unique<glslang::TProgram>();
   program->addShader(shader.get());
-  if (!program->link(messages))
+  if (!program->link(MESSAGES))
   {
     DumpBadShader("Failed to link program");
     return false;
@@ -232,7 +235,7 @@ bool CompileShaderToSPV(SPIRVCodeVector* out_code, EShLanguage stage, const char
   // Dump source code of shaders out to file if enabled.
   if (g_ActiveConfig.iLog & CONF_SAVESHADERS)
   {
-    static int counter = 0;
+    static std::atomic<int> counter{0};
     std::string filename = StringFromFormat("%s%s_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(),
       stage_filename, counter++);
 
@@ -275,7 +278,7 @@ void CopyGLSLToSPVVector(SPIRVCodeVector* out_code, const char* stage_filename,
 
   if (g_ActiveConfig.iLog & CONF_SAVESHADERS)
   {
-    static int counter = 0;
+    static std::atomic<int> counter{0};
     std::string filename = StringFromFormat("%s%s_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(),
       stage_filename, counter++);
 
@@ -295,20 +298,28 @@ void CopyGLSLToSPVVector(SPIRVCodeVector* out_code, const char* stage_filename,
 
 bool InitializeGlslang()
 {
-  static bool glslang_initialized = false;
-  if (glslang_initialized)
-    return true;
-
-  if (!glslang::InitializeProcess())
-  {
-    PanicAlert("Failed to initialize glslang shader compiler");
-    return false;
-  }
+  // Shaders may be compiled from several threads at once, glslang itself is thread-safe once the
+  // process has been initialized.
+  static const bool glslang_initialized = []() {
+    if (!glslang::InitializeProcess())
+    {
+      PanicAlert("Failed to initialize glslang shader compiler");
+      return false;
+    }
 
-  std::atexit([]() { glslang::FinalizeProcess(); });
+    std::atexit([]() { glslang::FinalizeProcess(); });
 
-  glslang_initialized = true;
-  return true;
+    // Building the built-in symbol tables on first use races with other threads compiling at the
+    // same time, so build them now by parsing an empty shader.
+    glslang::TShader shader(EShLangVertex);
+    glslang::TShader::ForbidInclude includer;
+    const char* source = "void main() {}\n";
+    shader.setStrings(&source, 1);
+    shader.parse(GetCompilerResourceLimits(), DEFAULT_VERSION, PROFILE, false, true, MESSAGES,
+      includer);
+    return true;
+  }();
+  return glslang_initialized;
 }
 
 const TBuiltInResource* GetCompilerResourceLimits()
@@ -414,7 +425,7 @@ const TBuiltInResource* GetCompilerResourceLimits()
 bool CompileVertexShader(SPIRVCodeVector* out_code, const char* source_code,
   size_t source_code_length)
 {
-  if (g_vulkan_context->SupportsNVGLSLExtension())
+  if (g_vulkan_context && g_vulkan_context->SupportsNVGLSLExtension())
   {
     CopyGLSLToSPVVector(out_code, "vs", source_code, source_code_length, SHADER_HEADER,
       sizeof(SHADER_HEADER) - 1);
@@ -428,7 +439,7 @@ bool CompileVertexShader(SPIRVCodeVector* out_code, const char* source_code,
 bool CompileGeometryShader(SPIRVCodeVector* out_code, const char* source_code,
   size_t source_code_length)
 {
-  if (g_vulkan_context->SupportsNVGLSLExtension())
+  if (g_vulkan_context && g_vulkan_context->SupportsNVGLSLExtension())
   {
     CopyGLSLToSPVVector(out_code, "gs", source_code, source_code_length, SHADER_HEADER,
       sizeof(SHADER_HEADER) - 1);
@@ -442,7 +453,7 @@ bool CompileGeometryShader(SPIRVCodeVector* out_code, const char* source_code,
 bool CompileFragmentShader(SPIRVCodeVector* out_code, const char* source_code,
   size_t source_code_length)
 {
-  if (g_vulkan_context->SupportsNVGLSLExtension())
+  if (g_vulkan_context && g_vulkan_context->SupportsNVGLSLExtension())
   {
     CopyGLSLToSPVVector(out_code, "ps", source_code, source_code_length, SHADER_HEADER,
       sizeof(SHADER_HEADER) - 1);
@@ -456,7 +467,7 @@ bool CompileFragmentShader(SPIRVCodeVector* out_code, const char* source_code,
 bool CompileComputeShader(SPIRVCodeVector* out_code, const char* source_code,
   size_t source_code_length)
 {
-  if (g_vulkan_context->SupportsNVGLSLExtension())
+  if (g_vulkan_context && g_vulkan_context->SupportsNVGLSLExtension())
   {
     CopyGLSLToSPVVector(out_code, "cs", source_code, source_code_length, COMPUTE_SHADER_HEADER,
       sizeof(COMPUTE_SHADER_HEADER) - 1);
@@ -17,6 +17,9 @@ namespace ShaderCompiler
 using SPIRVCodeType = u32;
 using SPIRVCodeVector = std::vector<SPIRVCodeType>;
 
+// The compile functions may be called from any thread. Without a device context, shaders are
+// always compiled to SPIR-V rather than passed through as GLSL.
+
 // Compile a vertex shader to SPIR-V.
 bool CompileVertexShader(SPIRVCodeVector* out_code, const char* source_code,
   size_t source_code_length);
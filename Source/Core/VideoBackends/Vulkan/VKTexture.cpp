@@ -135,12 +135,12 @@ bool VKTexture::Save(const std::string& filename, u32 level)
   // Write texture out to file.
   // It's okay to throw this texture away immediately, since we're done with it, and
   // we blocked until the copy completed on the GPU anyway.
-  bool result = TextureToPng(reinterpret_cast<u8*>(staging_texture->GetMapPointer()),
+  QueueTextureToPng(reinterpret_cast<u8*>(staging_texture->GetMapPointer()),
     static_cast<u32>(staging_texture->GetRowStride()), filename,
     level_width, level_height);
 
   staging_texture->Unmap();
-  return result;
+  return true;
 }
 
 void VKTexture::CopyTextureRectangle(const MathUtil::Rectangle<int>& dst_rect,
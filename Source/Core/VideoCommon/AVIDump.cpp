@@ -6,13 +6,23 @@
 #define __STDC_CONSTANT_MACROS 1
 #endif
 
+#include <algorithm>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
 #include <libavutil/mathematics.h>
+#include <libavutil/pixdesc.h>
 #include <libswscale/swscale.h>
 }
 
@@ -20,6 +30,8 @@ extern "C" {
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/TaskScheduler.h"
+#include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/SystemTimers.h"
@@ -48,7 +60,8 @@ static AVCodecContext* s_codec_context = nullptr;
 static AVFrame* s_src_frame = nullptr;
 static AVFrame* s_scaled_frame = nullptr;
 static AVPixelFormat s_pix_fmt = AV_PIX_FMT_BGR24;
-static SwsContext* s_sws_context = nullptr;
+// One context per horizontal band of the frame, so the colour conversion can run in parallel.
+static std::vector<SwsContext*> s_sws_contexts;
 static int s_width;
 static int s_height;
 static u64 s_last_frame;
@@ -59,6 +72,33 @@ static int s_file_index = 0;
 static int s_savestate_index = 0;
 static int s_last_savestate_index = 0;
 
+// Frames are copied into recycled buffers by AddFrame() and consumed by the encoder thread.
+struct QueuedFrame
+{
+  std::vector<u8> data;
+  int width = 0;
+  int height = 0;
+  AVIDump::Frame state;
+};
+
+static std::thread s_encoder_thread;
+static std::mutex s_queue_lock;
+static std::condition_variable s_queue_changed;
+static std::deque<QueuedFrame> s_pending_frames;
+static std::vector<std::vector<u8>> s_free_buffers;
+static bool s_stop_encoder = false;
+static bool s_drop_frames = false;
+static u32 s_queue_capacity = 0;
+static u32 s_peak_queue_depth = 0;
+static u64 s_frames_dropped = 0;
+static u64 s_frames_encoded = 0;
+
+// Bands smaller than this are not worth a task of their own.
+constexpr int MIN_CONVERSION_BAND_HEIGHT = 64;
+constexpr size_t MAX_CONVERSION_BANDS = 8;
+// ffv1 threads over slices; 16 is one of the slice layouts it accepts (4x4).
+constexpr int FFV1_SLICES = 16;
+
 static void InitAVCodec()
 {
   static bool first_run = true;
@@ -88,8 +128,23 @@ bool AVIDump::Start(int w, int h, bool fromBGRA)
 {
   s_pix_fmt = fromBGRA ? AV_PIX_FMT_BGRA : AV_PIX_FMT_RGBA;
 
-  s_width = w;
-  s_height = h;
+  if (!OpenVideoFile(w, h))
+    return false;
+
+  s_stop_encoder = false;
+  s_drop_frames = g_Config.bFrameDumpDropFrames;
+  s_queue_capacity = static_cast<u32>(g_Config.iFrameDumpQueueSize);
+  s_peak_queue_depth = 0;
+  s_frames_dropped = 0;
+  s_frames_encoded = 0;
+  s_encoder_thread = std::thread(EncoderThread);
+  return true;
+}
+
+bool AVIDump::OpenVideoFile(int width, int height)
+{
+  s_width = width;
+  s_height = height;
 
   s_last_frame_is_valid = false;
   s_last_pts = 0;
@@ -193,6 +248,18 @@ bool AVIDump::CreateVideoFile()
   s_codec_context->gop_size = 12;
   s_codec_context->pix_fmt = g_Config.bUseFFV1 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_YUV420P;
 
+  // Let the encoder use every core. Frame threading delays packets by a few frames, which
+  // HandleDelayedPackets() collects when the file is finished.
+  s_codec_context->thread_count = 0;
+  s_codec_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+  if (g_Config.bUseFFV1)
+  {
+    // Version 3 is the first to code slices independently, which is what ffv1 threads over. With
+    // a BGRA source the frame also reaches the encoder without any conversion.
+    s_codec_context->level = 3;
+    s_codec_context->slices = FFV1_SLICES;
+  }
+
   if (output_format->flags & AVFMT_GLOBALHEADER)
     s_codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
@@ -202,6 +269,11 @@ bool AVIDump::CreateVideoFile()
     return false;
   }
 
+  const size_t band_count = std::min<size_t>(
+      {Common::TaskScheduler::GetWorkerCount() + 1, MAX_CONVERSION_BANDS,
+       static_cast<size_t>(std::max(s_height / MIN_CONVERSION_BAND_HEIGHT, 1))});
+  s_sws_contexts.assign(band_count, nullptr);
+
   s_src_frame = av_frame_alloc();
   s_scaled_frame = av_frame_alloc();
 
@@ -298,6 +370,97 @@ static void WritePacket(AVPacket& pkt)
 
 void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const Frame& state)
 {
+  // The VI is able to be set to a zero value for height/width to disable output. Such frames are
+  // not dumped; the timestamps of the following frames still cover the time they were shown.
+  if (width <= 0 || height <= 0)
+    return;
+
+  std::vector<u8> buffer;
+  {
+    std::unique_lock<std::mutex> lk(s_queue_lock);
+    if (s_pending_frames.size() >= s_queue_capacity)
+    {
+      // Dropping keeps the emulation at full speed and the previous frame stays on screen for
+      // longer in the video. Otherwise the renderer waits for the encoder to catch up.
+      if (s_drop_frames)
+      {
+        ++s_frames_dropped;
+        return;
+      }
+      s_queue_changed.wait(lk, [] { return s_pending_frames.size() < s_queue_capacity; });
+    }
+    if (!s_free_buffers.empty())
+    {
+      buffer = std::move(s_free_buffers.back());
+      s_free_buffers.pop_back();
+    }
+  }
+
+  // The copy also flips upside-down sources (negative stride) into top-down rows.
+  const size_t row_size = static_cast<size_t>(width) * 4;
+  buffer.resize(row_size * height);
+  for (int y = 0; y < height; ++y)
+    std::memcpy(&buffer[y * row_size], data + static_cast<ptrdiff_t>(y) * stride, row_size);
+
+  {
+    std::lock_guard<std::mutex> lk(s_queue_lock);
+    s_pending_frames.push_back({std::move(buffer), width, height, state});
+    s_peak_queue_depth = std::max(s_peak_queue_depth, static_cast<u32>(s_pending_frames.size()));
+  }
+  s_queue_changed.notify_all();
+}
+
+// Converts the frame into s_scaled_frame, one horizontal band per task.
+static bool ConvertFrame(const QueuedFrame& frame)
+{
+#if LIBAVCODEC_VERSION_MAJOR >= 55
+  // The encoder may still hold a reference to the previous picture.
+  if (av_frame_make_writable(s_scaled_frame) < 0)
+    return false;
+#endif
+
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(s_codec_context->pix_fmt);
+  const int row_alignment = 1 << desc->log2_chroma_h;
+  const int band_count = static_cast<int>(s_sws_contexts.size());
+  const int band_height =
+      ((frame.height + band_count - 1) / band_count + row_alignment - 1) & ~(row_alignment - 1);
+  const int src_stride = frame.width * 4;
+
+  Common::ParallelFor(0, band_count, [&](int first_band, int last_band) {
+    for (int band = first_band; band < last_band; ++band)
+    {
+      const int y = band * band_height;
+      const int height = std::min(band_height, frame.height - y);
+      if (height <= 0)
+        continue;
+
+      SwsContext*& context = s_sws_contexts[band];
+      context = sws_getCachedContext(context, frame.width, height, s_pix_fmt, s_width, height,
+                                     s_codec_context->pix_fmt, SWS_BICUBIC, nullptr, nullptr,
+                                     nullptr);
+      if (!context)
+        continue;
+
+      const u8* src[4] = {frame.data.data() + static_cast<size_t>(y) * src_stride};
+      const int src_linesize[4] = {src_stride};
+      u8* dst[4] = {};
+      for (int plane = 0; plane < 4 && s_scaled_frame->data[plane]; ++plane)
+      {
+        const int shift = (plane == 1 || plane == 2) ? desc->log2_chroma_h : 0;
+        dst[plane] = s_scaled_frame->data[plane] + (y >> shift) * s_scaled_frame->linesize[plane];
+      }
+      sws_scale(context, src, src_linesize, 0, height, dst, s_scaled_frame->linesize);
+    }
+  });
+
+  return std::all_of(s_sws_contexts.begin(), s_sws_contexts.end(),
+                     [](const SwsContext* context) { return context != nullptr; });
+}
+
+static void EncodeFrame(const QueuedFrame& frame)
+{
+  const AVIDump::Frame& state = frame.state;
+
   // Assume that the timing is valid, if the savestate id of the new frame
   // doesn't match the last one.
   if (state.savestate_index != s_last_savestate_index)
@@ -306,21 +469,21 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
     s_last_frame_is_valid = false;
   }
 
-  CheckResolution(width, height);
-  s_src_frame->data[0] = const_cast<u8*>(data);
-  s_src_frame->linesize[0] = stride;
-  s_src_frame->format = s_pix_fmt;
-  s_src_frame->width = s_width;
-  s_src_frame->height = s_height;
-
-  // Convert image from {BGR24, RGBA} to desired pixel format
-  s_sws_context =
-    sws_getCachedContext(s_sws_context, width, height, s_pix_fmt, s_width, s_height,
-      s_codec_context->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr);
-  if (s_sws_context)
+  AVFrame* picture = s_scaled_frame;
+  if (s_codec_context->pix_fmt == s_pix_fmt)
+  {
+    // The encoder takes the source format as is. It copies the data if it has to keep it.
+    s_src_frame->data[0] = const_cast<u8*>(frame.data.data());
+    s_src_frame->linesize[0] = frame.width * 4;
+    s_src_frame->format = s_pix_fmt;
+    s_src_frame->width = s_width;
+    s_src_frame->height = s_height;
+    picture = s_src_frame;
+  }
+  else if (!ConvertFrame(frame))
   {
-    sws_scale(s_sws_context, s_src_frame->data, s_src_frame->linesize, 0, height,
-      s_scaled_frame->data, s_scaled_frame->linesize);
+    ERROR_LOG(VIDEO, "Could not convert frame for dumping");
+    return;
   }
 
   // Encode and write the image.
@@ -350,12 +513,13 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
     last_pts = (s_last_pts * s_codec_context->time_base.den) / state.ticks_per_second;
   }
   u64 pts_in_ticks = s_last_pts + delta;
-  s_scaled_frame->pts = (pts_in_ticks * s_codec_context->time_base.den) / state.ticks_per_second;
-  if (s_scaled_frame->pts != last_pts)
+  picture->pts = (pts_in_ticks * s_codec_context->time_base.den) / state.ticks_per_second;
+  if (picture->pts != last_pts)
   {
     s_last_frame = state.ticks;
     s_last_pts = pts_in_ticks;
-    error = SendFrameAndReceivePacket(s_codec_context, &pkt, s_scaled_frame, &got_packet);
+    error = SendFrameAndReceivePacket(s_codec_context, &pkt, picture, &got_packet);
+    ++s_frames_encoded;
   }
   if (!error && got_packet)
   {
@@ -365,10 +529,41 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
     ERROR_LOG(VIDEO, "Error while encoding video: %d", error);
 }
 
+void AVIDump::EncoderThread()
+{
+  Common::SetCurrentThreadName("FrameDumpEncoder");
+
+  while (true)
+  {
+    QueuedFrame frame;
+    {
+      std::unique_lock<std::mutex> lk(s_queue_lock);
+      s_queue_changed.wait(lk, [] { return s_stop_encoder || !s_pending_frames.empty(); });
+      // Everything queued before Stop() is still written out.
+      if (s_pending_frames.empty())
+        break;
+      frame = std::move(s_pending_frames.front());
+      s_pending_frames.pop_front();
+    }
+    s_queue_changed.notify_all();
+
+    if (CheckResolution(frame.width, frame.height))
+      EncodeFrame(frame);
+
+    std::lock_guard<std::mutex> lk(s_queue_lock);
+    s_free_buffers.push_back(std::move(frame.data));
+  }
+}
+
 static void HandleDelayedPackets()
 {
   AVPacket pkt;
 
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 37, 100)
+  // Enter draining mode, so the encoder returns the frames its threads are still holding.
+  avcodec_send_frame(s_codec_context, nullptr);
+#endif
+
   while (true)
   {
     PreparePacket(&pkt);
@@ -376,7 +571,8 @@ static void HandleDelayedPackets()
     int error = ReceivePacket(s_codec_context, &pkt, &got_packet);
     if (error)
     {
-      ERROR_LOG(VIDEO, "Error while stopping video: %d", error);
+      if (error != AVERROR_EOF)
+        ERROR_LOG(VIDEO, "Error while stopping video: %d", error);
       break;
     }
 
@@ -389,12 +585,41 @@ static void HandleDelayedPackets()
 
 void AVIDump::Stop()
 {
+  {
+    std::lock_guard<std::mutex> lk(s_queue_lock);
+    s_stop_encoder = true;
+  }
+  s_queue_changed.notify_all();
+  if (s_encoder_thread.joinable())
+    s_encoder_thread.join();
+
+  FinishVideoFile();
+  s_file_index = 0;
+
+  {
+    std::lock_guard<std::mutex> lk(s_queue_lock);
+    s_queue_capacity = 0;
+    s_free_buffers.clear();
+  }
+
+  NOTICE_LOG(VIDEO, "Stopping frame dump: %" PRIu64 " frames encoded, %" PRIu64
+                    " dropped, peak queue depth %u",
+             s_frames_encoded, s_frames_dropped, s_peak_queue_depth);
+  if (s_frames_dropped)
+    OSD::AddMessage(StringFromFormat("Stopped dumping frames (%" PRIu64 " dropped)",
+                                     s_frames_dropped));
+  else
+    OSD::AddMessage("Stopped dumping frames");
+}
+
+void AVIDump::FinishVideoFile()
+{
+  if (!s_codec_context)
+    return;
+
   HandleDelayedPackets();
   av_write_trailer(s_format_context);
   CloseVideoFile();
-  s_file_index = 0;
-  NOTICE_LOG(VIDEO, "Stopping frame dump");
-  OSD::AddMessage("Stopped dumping frames");
 }
 
 void AVIDump::CloseVideoFile()
@@ -411,11 +636,9 @@ void AVIDump::CloseVideoFile()
   avformat_free_context(s_format_context);
   s_format_context = nullptr;
 
-  if (s_sws_context)
-  {
-    sws_freeContext(s_sws_context);
-    s_sws_context = nullptr;
-  }
+  for (SwsContext* context : s_sws_contexts)
+    sws_freeContext(context);
+  s_sws_contexts.clear();
 }
 
 void AVIDump::DoState()
@@ -423,20 +646,20 @@ void AVIDump::DoState()
   s_savestate_index++;
 }
 
-void AVIDump::CheckResolution(int width, int height)
+bool AVIDump::CheckResolution(int width, int height)
 {
   // We check here to see if the requested width and height have changed since the last frame which
-  // was dumped, then create a new file accordingly. However, is it possible for the height
-  // (possibly width as well, but no examples known) to have a value of zero. This can occur as the
-  // VI is able to be set to a zero value for height/width to disable output. If this is the case,
-  // simply keep the last known resolution of the video for the added frame.
-  if ((width != s_width || height != s_height) && (width > 0 && height > 0))
+  // was dumped, then create a new file accordingly. Frames with a zero width or height never reach
+  // the queue, see AddFrame().
+  if (width != s_width || height != s_height)
   {
-    int temp_file_index = s_file_index;
-    Stop();
-    s_file_index = temp_file_index + 1;
-    Start(width, height);
+    FinishVideoFile();
+    ++s_file_index;
+    OpenVideoFile(width, height);
   }
+
+  // Frames are skipped if the new file could not be created.
+  return s_codec_context != nullptr;
 }
 
 AVIDump::Frame AVIDump::FetchState(u64 ticks)
@@ -448,3 +671,13 @@ AVIDump::Frame AVIDump::FetchState(u64 ticks)
   state.savestate_index = s_savestate_index;
   return state;
 }
+
+AVIDump::QueueStatistics AVIDump::GetQueueStatistics()
+{
+  std::lock_guard<std::mutex> lk(s_queue_lock);
+  QueueStatistics stats;
+  stats.depth = static_cast<u32>(s_pending_frames.size());
+  stats.capacity = s_queue_capacity;
+  stats.dropped = s_frames_dropped;
+  return stats;
+}
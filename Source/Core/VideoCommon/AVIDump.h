@@ -9,9 +9,12 @@
 class AVIDump
 {
 private:
+  static bool OpenVideoFile(int width, int height);
   static bool CreateVideoFile();
+  static void FinishVideoFile();
   static void CloseVideoFile();
-  static void CheckResolution(int width, int height);
+  static bool CheckResolution(int width, int height);
+  static void EncoderThread();
 
 public:
   struct Frame
@@ -22,14 +25,26 @@ public:
     int savestate_index = 0;
   };
 
+  struct QueueStatistics
+  {
+    u32 depth = 0;
+    u32 capacity = 0;
+    u64 dropped = 0;
+  };
+
   static bool Start(int w, int h, bool fromBGRA = false);
+  // Copies the frame into the encoder queue and returns. Colour conversion and encoding happen on
+  // the encoder thread. Must only be called from one thread at a time.
   static void AddFrame(const u8* data, int width, int height, int stride, const Frame& state);
+  // Encodes every queued frame before closing the file.
   static void Stop();
   static void DoState();
 
 #if defined(HAVE_FFMPEG)
   static Frame FetchState(u64 ticks);
+  static QueueStatistics GetQueueStatistics();
 #else
   static Frame FetchState(u64 ticks) { return{}; }
+  static QueueStatistics GetQueueStatistics() { return {}; }
 #endif
 };
@@ -24,6 +24,7 @@
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/ShaderUidCache.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/TextureDecoder.h"
@@ -52,6 +53,7 @@ void BPInit()
 {
   memset(&bpmem, 0, sizeof(bpmem));
   bpmem.bpMask = 0xFFFFFF;
+  ShaderUidCache::Invalidate();
 
   mapTexAddress = 0;
   numWrites = 0;
@@ -120,6 +122,7 @@ void BPWritten(const BPCmd& bp)
   FlushPipeline();
 
   ((u32*)&bpmem)[bp.address] = bp.newvalue;
+  ShaderUidCache::BPRegisterChanged(bp.address);
 
   switch (bp.address)
   {
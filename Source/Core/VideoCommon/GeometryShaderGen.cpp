@@ -9,6 +9,7 @@
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/GeometryShaderGen.h"
 #include "VideoCommon/LightingShaderGen.h"
+#include "VideoCommon/ShaderUidCache.h"
 #include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -23,8 +24,8 @@ bool geometry_shader_uid_data::IsPassthrough() const
   return primitive_type == static_cast<u32>(PrimitiveType::Triangles) && !stereo && !wireframe;
 }
 
-void GetGeometryShaderUid(GeometryShaderUid& out, PrimitiveType primitive_type, const XFMemory& xfr,
-                          const u32 components)
+static void CalculateGeometryShaderUid(GeometryShaderUid& out, PrimitiveType primitive_type,
+                                       const XFMemory& xfr, const u32 components)
 {
   out.ClearUID();
   geometry_shader_uid_data& uid_data = out.GetUidData<geometry_shader_uid_data>();
@@ -39,6 +40,20 @@ void GetGeometryShaderUid(GeometryShaderUid& out, PrimitiveType primitive_type,
   out.CalculateUIDHash();
 }
 
+void GetGeometryShaderUid(GeometryShaderUid& out, PrimitiveType primitive_type, const XFMemory& xfr,
+                          const u32 components)
+{
+  // The geometry shader doesn't depend on BP state
+  static ShaderUidCache::CachedUid<ShaderUidCache::STAGE_GEOMETRY, GeometryShaderUid,
+                                   PrimitiveType, u32>
+      s_cached_uid;
+  if (s_cached_uid.Lookup(xfr, bpmem, primitive_type, components, &out))
+    return;
+
+  CalculateGeometryShaderUid(out, primitive_type, xfr, components);
+  s_cached_uid.Store(xfr, bpmem, primitive_type, components, out);
+}
+
 inline void EmitVertex(ShaderCode& out, API_TYPE ApiType, const geometry_shader_uid_data& uid_data,
                        const char* vertex, bool first_vertex, const ShaderHostConfig& hostconfig)
 {
@@ -57,7 +57,6 @@ void ShaderCompilerWorkUnit::Release()
 }
 
 HLSLAsyncCompiler::HLSLAsyncCompiler() :
-  m_input(repository_size),
   m_output(repository_size)
 {
   WorkUnitRepository = new ShaderCompilerWorkUnit[repository_size];
@@ -65,7 +64,6 @@ HLSLAsyncCompiler::HLSLAsyncCompiler() :
   {
     m_repository.push_back(std::move(&WorkUnitRepository[i]));
   }
-  Common::ThreadPool::RegisterWorker(this);
 }
 
 void HLSLAsyncCompiler::SetCompilerFunction(pD3DCompile compilerfunc)
@@ -75,34 +73,30 @@ void HLSLAsyncCompiler::SetCompilerFunction(pD3DCompile compilerfunc)
 
 HLSLAsyncCompiler::~HLSLAsyncCompiler()
 {
-  Common::ThreadPool::UnregisterWorker(this);
+  // Compilation tasks still in flight reference the work units.
+  m_tasks.Wait();
   delete[] WorkUnitRepository;
 }
 
-bool HLSLAsyncCompiler::NextTask(size_t ID)
+void HLSLAsyncCompiler::Compile(ShaderCompilerWorkUnit* unit)
 {
-  ShaderCompilerWorkUnit* unit = nullptr;
-  if (m_input.try_pop(unit))
+  if (unit->GenerateCodeHandler)
   {
-    if (unit->GenerateCodeHandler)
-    {
-      unit->GenerateCodeHandler(unit);
-    }
-    unit->cresult = PD3DCompile(unit->code.data(),
-      unit->code.size(),
-      nullptr,
-      (const D3D_SHADER_MACRO*)unit->defines,
-      nullptr,
-      unit->entrypoint,
-      unit->target,
-      unit->flags, 0,
-      &unit->shaderbytecode,
-      &unit->error);
-    m_output.push(std::move(unit));
-    return true;
+    unit->GenerateCodeHandler(unit);
   }
-  return false;
+  unit->cresult = PD3DCompile(unit->code.data(),
+    unit->code.size(),
+    nullptr,
+    (const D3D_SHADER_MACRO*)unit->defines,
+    nullptr,
+    unit->entrypoint,
+    unit->target,
+    unit->flags, 0,
+    &unit->shaderbytecode,
+    &unit->error);
+  m_output.push(std::move(unit));
 }
+
 ShaderCompilerWorkUnit* HLSLAsyncCompiler::NewUnit()
 {
   u32 loopcount = 0;
@@ -125,8 +119,7 @@ ShaderCompilerWorkUnit* HLSLAsyncCompiler::NewUnit()
 void HLSLAsyncCompiler::CompileShaderAsync(ShaderCompilerWorkUnit* unit)
 {
   m_in_progres_counter++;
-  m_input.push(std::move(unit));
-  Common::ThreadPool::NotifyWorkPending();
+  m_tasks.Run([this, unit] { Compile(unit); });
 }
 
 void HLSLAsyncCompiler::ProcCompilationResults()
@@ -154,7 +147,9 @@ void HLSLAsyncCompiler::WaitForFinish()
   while (m_in_progres_counter > 0)
   {
     ProcCompilationResults();
-    Common::cYield(loopcount++);
+    // Compile on this thread too instead of just waiting for the workers.
+    if (!Common::TaskScheduler::RunOneTask())
+      Common::cYield(loopcount++);
   }
 }
 
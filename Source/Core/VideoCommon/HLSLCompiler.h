@@ -8,6 +8,7 @@
 #include <vector>
 #include <D3Dcompiler.h>
 #include "VideoCommon/ShaderGenCommon.h"
+#include "Common/TaskScheduler.h"
 #include "Common/ThreadPool.h"
 
 class HLSLAsyncCompiler;
@@ -33,7 +34,7 @@ public:
   void Release();
 };
 
-class HLSLAsyncCompiler final : Common::IWorker
+class HLSLAsyncCompiler final
 {
   static constexpr size_t repository_size = 256;
   friend class HLSLCompiler;
@@ -42,15 +43,15 @@ class HLSLAsyncCompiler final : Common::IWorker
   s32 m_in_progres_counter = 0;  
   ShaderCompilerWorkUnit* WorkUnitRepository;
   std::deque<ShaderCompilerWorkUnit*> m_repository;
-  Common::OneToManyQueue<ShaderCompilerWorkUnit*, Common::CircularQueue<ShaderCompilerWorkUnit*>> m_input;
   Common::ManyToOneQueue<ShaderCompilerWorkUnit*, Common::CircularQueue<ShaderCompilerWorkUnit*>> m_output;
+  Common::TaskGroup m_tasks;
   HLSLAsyncCompiler(HLSLAsyncCompiler const&);
   void operator=(HLSLAsyncCompiler const&);
+  void Compile(ShaderCompilerWorkUnit* unit);
 public:
   static HLSLAsyncCompiler& getInstance();
   void SetCompilerFunction(pD3DCompile compilerfunc);
-  virtual ~HLSLAsyncCompiler();
-  bool NextTask(size_t ID) override;
+  ~HLSLAsyncCompiler();
   ShaderCompilerWorkUnit* NewUnit();
   void CompileShaderAsync(ShaderCompilerWorkUnit* unit);
   void ProcCompilationResults();
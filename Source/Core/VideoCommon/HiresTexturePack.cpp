@@ -0,0 +1,302 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/HiresTexturePack.h"
+
+#include <cstring>
+#include <limits>
+#include <xxhash.h>
+
+#include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
+#include "Common/StringUtil.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/TextureUtil.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace HiresTexturePack
+{
+u64 HashName(EntryKind kind, const std::string& name)
+{
+  return XXH64(name.data(), name.size(), static_cast<u64>(kind));
+}
+
+static u64 AlignUp(u64 value)
+{
+  return (value + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+}
+
+// Size of the mip levels the texture cache uploads from an entry: the color layer followed by the
+// normal and emissive layers, which always have as many levels as the color layer, or the six
+// faces of an enviroment cube. Returns 0 for descriptions that can't be uploaded at all.
+static u64 GetUploadSize(const FileEntry& entry)
+{
+  if (entry.kind != static_cast<u8>(EntryKind::Texture) &&
+      entry.kind != static_cast<u8>(EntryKind::Enviroment))
+  {
+    return 0;
+  }
+  if (entry.format == PC_TEX_FMT_NONE || entry.format >= PC_TEX_NUM_FORMATS)
+    return 0;
+  if (entry.width == 0 || entry.height == 0 || entry.levels == 0 || entry.levels > 32)
+    return 0;
+  if ((entry.nrm_levels != 0 && entry.nrm_levels != entry.levels) ||
+      (entry.lum_levels != 0 && entry.lum_levels != entry.levels))
+  {
+    return 0;
+  }
+  // GetTextureSizeInBytes() works in 32 bits, with at most 16 bytes per texel.
+  if ((u64(entry.width) + 3) * (u64(entry.height) + 3) * 16 > std::numeric_limits<s32>::max())
+    return 0;
+
+  const HostTextureFormat format = static_cast<HostTextureFormat>(entry.format);
+  u64 layer_size = 0;
+  for (u32 level = 0; level < entry.levels; ++level)
+  {
+    layer_size += TextureUtil::GetTextureSizeInBytes(
+        TextureUtil::CalculateLevelSize(entry.width, level),
+        TextureUtil::CalculateLevelSize(entry.height, level), format);
+  }
+  const u32 layers = entry.kind == static_cast<u8>(EntryKind::Enviroment) ?
+                         6 :
+                         1 + (entry.nrm_levels != 0) + (entry.lum_levels != 0);
+  return layer_size * layers;
+}
+
+Reader::~Reader()
+{
+  Close();
+}
+
+bool Reader::Open(const std::string& path)
+{
+  Close();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileW(UTF8ToUTF16(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader)))
+  {
+    CloseHandle(file);
+    return false;
+  }
+  m_mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!m_mapping)
+    return false;
+  m_view = static_cast<const u8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!m_view)
+  {
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+    return false;
+  }
+  m_size = static_cast<size_t>(size.QuadPart);
+#else
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader)))
+  {
+    close(fd);
+    return false;
+  }
+  void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (view == MAP_FAILED)
+    return false;
+  m_view = static_cast<const u8*>(view);
+  m_size = static_cast<size_t>(st.st_size);
+#endif
+
+  if (!Validate())
+  {
+    ERROR_LOG(VIDEO, "Custom texture pack %s is invalid", path.c_str());
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void Reader::Close()
+{
+  if (!m_view)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_view);
+  CloseHandle(m_mapping);
+  m_mapping = nullptr;
+#else
+  munmap(const_cast<u8*>(m_view), m_size);
+#endif
+  m_view = nullptr;
+  m_size = 0;
+}
+
+// Checks every offset and data size once, so lookups can trust the file afterwards.
+bool Reader::Validate() const
+{
+  FileHeader header;
+  std::memcpy(&header, m_view, sizeof(header));
+  if (header.magic != PACK_MAGIC || header.version != PACK_VERSION || header.file_size != m_size)
+    return false;
+  if (header.table_size == 0 || !MathUtil::IsPow2(header.table_size) ||
+      header.table_size < header.entry_count)
+  {
+    return false;
+  }
+
+  const auto in_bounds = [this](u64 offset, u64 size) {
+    return offset <= m_size && size <= m_size - offset;
+  };
+  if (!in_bounds(header.entries_offset, u64(header.entry_count) * sizeof(FileEntry)) ||
+      !in_bounds(header.table_offset, u64(header.table_size) * sizeof(u32)) ||
+      !in_bounds(header.names_offset, header.names_size) ||
+      header.entries_offset % alignof(u64) != 0 || header.table_offset % alignof(u32) != 0)
+  {
+    return false;
+  }
+
+  const FileEntry* entries = reinterpret_cast<const FileEntry*>(m_view + header.entries_offset);
+  for (u32 i = 0; i < header.entry_count; ++i)
+  {
+    const FileEntry& entry = entries[i];
+    if (!in_bounds(entry.data_offset, entry.data_size) ||
+        u64(entry.name_offset) + entry.name_length > header.names_size)
+    {
+      return false;
+    }
+    // The data may be larger than needed, since the loader over-allocates for mip levels.
+    const u64 upload_size = GetUploadSize(entry);
+    if (upload_size == 0 || upload_size > entry.data_size)
+      return false;
+  }
+
+  const u32* table = reinterpret_cast<const u32*>(m_view + header.table_offset);
+  for (u32 i = 0; i < header.table_size; ++i)
+  {
+    if (table[i] > header.entry_count)
+      return false;
+  }
+  return true;
+}
+
+u32 Reader::GetEntryCount() const
+{
+  if (!m_view)
+    return 0;
+  return reinterpret_cast<const FileHeader*>(m_view)->entry_count;
+}
+
+const FileEntry* Reader::Find(EntryKind kind, const std::string& name) const
+{
+  if (!m_view)
+    return nullptr;
+
+  const FileHeader& header = *reinterpret_cast<const FileHeader*>(m_view);
+  const FileEntry* entries = reinterpret_cast<const FileEntry*>(m_view + header.entries_offset);
+  const u32* table = reinterpret_cast<const u32*>(m_view + header.table_offset);
+  const char* names = reinterpret_cast<const char*>(m_view + header.names_offset);
+
+  const u64 hash = HashName(kind, name);
+  const u32 mask = header.table_size - 1;
+  for (u32 slot = static_cast<u32>(hash) & mask, probes = 0; probes < header.table_size;
+       slot = (slot + 1) & mask, ++probes)
+  {
+    const u32 index = table[slot];
+    if (index == 0)
+      return nullptr;
+
+    const FileEntry& entry = entries[index - 1];
+    if (entry.hash == hash && entry.kind == static_cast<u8>(kind) &&
+        entry.name_length == name.size() &&
+        std::memcmp(names + entry.name_offset, name.data(), name.size()) == 0)
+    {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+bool Writer::Open(const std::string& path)
+{
+  m_entries.clear();
+  m_names.clear();
+  if (!m_file.Open(path, "wb"))
+    return false;
+
+  // The header is rewritten by Finish() once the index is known.
+  const FileHeader header{};
+  m_data_end = sizeof(header);
+  return m_file.WriteBytes(&header, sizeof(header));
+}
+
+bool Writer::Add(EntryKind kind, const std::string& name, FileEntry entry, const u8* data,
+                 size_t size)
+{
+  const u64 data_offset = AlignUp(m_data_end);
+  if (!m_file.Seek(data_offset, SEEK_SET) || !m_file.WriteBytes(data, size))
+    return false;
+
+  entry.hash = HashName(kind, name);
+  entry.kind = static_cast<u8>(kind);
+  entry.data_offset = data_offset;
+  entry.data_size = size;
+  entry.name_offset = static_cast<u32>(m_names.size());
+  entry.name_length = static_cast<u32>(name.size());
+  std::memset(entry.padding, 0, sizeof(entry.padding));
+  m_names += name;
+  m_entries.push_back(entry);
+  m_data_end = data_offset + size;
+  return true;
+}
+
+bool Writer::Finish()
+{
+  FileHeader header{};
+  header.magic = PACK_MAGIC;
+  header.version = PACK_VERSION;
+  header.entry_count = static_cast<u32>(m_entries.size());
+  // Keep the load factor at or below one half so probe sequences stay short.
+  header.table_size = 16;
+  while (header.table_size < header.entry_count * 2)
+    header.table_size *= 2;
+
+  std::vector<u32> table(header.table_size, 0);
+  const u32 mask = header.table_size - 1;
+  for (u32 i = 0; i < header.entry_count; ++i)
+  {
+    u32 slot = static_cast<u32>(m_entries[i].hash) & mask;
+    while (table[slot] != 0)
+      slot = (slot + 1) & mask;
+    table[slot] = i + 1;
+  }
+
+  header.entries_offset = AlignUp(m_data_end);
+  header.table_offset = header.entries_offset + m_entries.size() * sizeof(FileEntry);
+  header.names_offset = header.table_offset + table.size() * sizeof(u32);
+  header.names_size = m_names.size();
+  header.file_size = header.names_offset + header.names_size;
+
+  const bool success = m_file.Seek(header.entries_offset, SEEK_SET) &&
+                       m_file.WriteArray(m_entries.data(), m_entries.size()) &&
+                       m_file.WriteArray(table.data(), table.size()) &&
+                       m_file.WriteBytes(m_names.data(), m_names.size()) &&
+                       m_file.Seek(0, SEEK_SET) && m_file.WriteBytes(&header, sizeof(header));
+  return m_file.Close() && success;
+}
+}  // namespace HiresTexturePack
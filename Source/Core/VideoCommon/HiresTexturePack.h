@@ -0,0 +1,120 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Single-file archive of custom textures.
+//
+// A pack holds textures exactly as HiresTexture hands them to the texture cache: decoded (or
+// still block-compressed for DDS sources), with every mip level and material layer laid out in
+// one buffer. The index is an open-addressing hash table keyed by the texture name, so the whole
+// file can be memory-mapped at boot and looked up without scanning any directory.
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+
+namespace HiresTexturePack
+{
+constexpr u32 PACK_MAGIC = 0x4B505448;  // "HTPK"
+constexpr u32 PACK_VERSION = 1;
+constexpr char PACK_EXTENSION[] = ".htp";
+constexpr u64 DATA_ALIGNMENT = 64;
+
+enum class EntryKind : u8
+{
+  Texture = 0,
+  Enviroment = 1,
+};
+
+#pragma pack(push, 1)
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 entry_count;
+  // Number of slots in the hash table, always a power of two.
+  u32 table_size;
+  u64 entries_offset;
+  u64 table_offset;
+  u64 names_offset;
+  u64 names_size;
+  u64 file_size;
+  u64 reserved;
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader has the wrong size");
+
+struct FileEntry
+{
+  u64 hash;
+  u64 data_offset;
+  u64 data_size;
+  u32 name_offset;
+  u32 name_length;
+  u32 width;
+  u32 height;
+  u32 levels;
+  u32 nrm_levels;
+  u32 lum_levels;
+  u32 format;
+  u8 kind;
+  u8 has_arbitrary_mips;
+  u8 padding[6];
+};
+static_assert(sizeof(FileEntry) == 64, "FileEntry has the wrong size");
+#pragma pack(pop)
+
+// Memory-maps a pack read-only.
+class Reader
+{
+public:
+  Reader() = default;
+  Reader(const Reader&) = delete;
+  Reader& operator=(const Reader&) = delete;
+  ~Reader();
+
+  bool Open(const std::string& path);
+  void Close();
+  bool IsOpen() const { return m_view != nullptr; }
+  u32 GetEntryCount() const;
+
+  const FileEntry* Find(EntryKind kind, const std::string& name) const;
+  const u8* GetData(const FileEntry& entry) const { return m_view + entry.data_offset; }
+
+private:
+  bool Validate() const;
+
+  const u8* m_view = nullptr;
+  size_t m_size = 0;
+#ifdef _WIN32
+  void* m_mapping = nullptr;
+#endif
+};
+
+// Writes payloads as they are added and the index on Finish().
+class Writer
+{
+public:
+  Writer() = default;
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  bool Open(const std::string& path);
+  // entry provides the texture description; its hash, name and data fields are filled in here.
+  bool Add(EntryKind kind, const std::string& name, FileEntry entry, const u8* data, size_t size);
+  bool Finish();
+
+  u32 GetEntryCount() const { return static_cast<u32>(m_entries.size()); }
+
+private:
+  File::IOFile m_file;
+  std::vector<FileEntry> m_entries;
+  std::string m_names;
+  u64 m_data_end = 0;
+};
+
+u64 HashName(EntryKind kind, const std::string& name);
+}  // namespace HiresTexturePack
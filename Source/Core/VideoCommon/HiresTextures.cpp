@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstring>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -24,14 +25,15 @@
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
 #include "Common/Swap.h"
+#include "Common/TaskScheduler.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
 
-#include "Core/Config/GraphicsSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/Host.h"
 
 #include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/HiresTexturePack.h"
 #include "VideoCommon/ImageLoader.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/TextureUtil.h"
@@ -104,9 +106,22 @@ typedef std::unordered_map<std::string, HiresTextureCacheItem> HiresTextureCache
 typedef std::unordered_map<std::string, EnvTextureCacheItem> EnvTextureCache;
 static HiresTextureCache s_textureMap;
 static EnvTextureCache s_enviromentMap;
-typedef std::unordered_map<std::string, std::shared_ptr<HiresTexture>> TextureCache;
+
+// Decoded textures are kept in memory up to a budget. Once it is reached, the least recently used
+// ones are evicted to make room for new loads. Entries are (is enviroment, base name), most
+// recently used first.
+typedef std::list<std::pair<bool, std::string>> LruList;
+struct CachedTexture
+{
+  std::shared_ptr<HiresTexture> texture;
+  LruList::iterator lru_position;
+};
+typedef std::unordered_map<std::string, CachedTexture> TextureCache;
 static TextureCache s_textureCache;
 static TextureCache s_enviromentCache;
+static LruList s_lru;
+
+static HiresTexturePack::Reader s_pack;
 
 static std::mutex s_textureCacheMutex;
 static Common::Flag s_textureCacheAbortLoading;
@@ -115,6 +130,13 @@ static std::atomic<size_t> size_sum;
 static size_t max_mem = 0;
 static std::thread s_prefetcher;
 
+static struct
+{
+  std::atomic<u64> hits;
+  std::atomic<u64> misses;
+  std::atomic<u64> evictions;
+} s_cache_stats;
+
 static const std::string s_format_prefix = "tex1_";
 static const std::string s_enviroment_prefix = "env_";
 
@@ -124,13 +146,86 @@ HiresTexture::HiresTexture()
 {
 }
 
-void HiresTexture::Init()
+static size_t GetCacheBudget()
 {
-  size_sum.store(0);
+  if (g_ActiveConfig.iHiresTexturesCacheSize > 0)
+    return static_cast<size_t>(g_ActiveConfig.iHiresTexturesCacheSize) * 1024 * 1024;
+
   size_t sys_mem = Common::MemPhysical();
   size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
   // keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
-  max_mem = (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
+  return (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
+}
+
+static TextureCache& GetCache(bool enviroment)
+{
+  return enviroment ? s_enviromentCache : s_textureCache;
+}
+
+// The following helpers must be called with s_textureCacheMutex held.
+static std::shared_ptr<HiresTexture> LookupCached(bool enviroment, const std::string& basename)
+{
+  TextureCache& cache = GetCache(enviroment);
+  auto iter = cache.find(basename);
+  if (iter == cache.end())
+    return nullptr;
+  s_lru.splice(s_lru.begin(), s_lru, iter->second.lru_position);
+  return iter->second.texture;
+}
+
+static void InsertCached(bool enviroment, const std::string& basename,
+                         std::shared_ptr<HiresTexture> texture)
+{
+  TextureCache& cache = GetCache(enviroment);
+  if (cache.find(basename) != cache.end())
+    return;
+  size_sum.fetch_add(texture->m_cached_data_size);
+  s_lru.emplace_front(enviroment, basename);
+  cache.emplace(basename, CachedTexture{std::move(texture), s_lru.begin()});
+}
+
+static TextureCache::iterator EraseCached(TextureCache& cache, TextureCache::iterator iter)
+{
+  size_sum.fetch_sub(iter->second.texture->m_cached_data_size);
+  s_lru.erase(iter->second.lru_position);
+  return cache.erase(iter);
+}
+
+static void EvictUntilBelow(size_t limit)
+{
+  while (size_sum.load() > limit && !s_lru.empty())
+  {
+    TextureCache& cache = GetCache(s_lru.back().first);
+    EraseCached(cache, cache.find(s_lru.back().second));
+    s_cache_stats.evictions++;
+  }
+}
+
+static void ClearCache()
+{
+  s_textureCache.clear();
+  s_enviromentCache.clear();
+  s_lru.clear();
+  size_sum.store(0);
+}
+
+static void ReportCacheStatistics()
+{
+  const u64 hits = s_cache_stats.hits.exchange(0);
+  const u64 misses = s_cache_stats.misses.exchange(0);
+  const u64 evictions = s_cache_stats.evictions.exchange(0);
+  if (hits + misses == 0)
+    return;
+
+  INFO_LOG(VIDEO,
+           "Custom texture cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+           " evictions, %.1f of %.1f MB resident",
+           hits, misses, evictions, size_sum / (1024.0 * 1024.0), max_mem / (1024.0 * 1024.0));
+}
+
+void HiresTexture::Init()
+{
+  size_sum.store(0);
   Update();
 }
 
@@ -141,9 +236,11 @@ void HiresTexture::Shutdown()
     s_textureCacheAbortLoading.Set();
     s_prefetcher.join();
   }
+  ReportCacheStatistics();
   s_textureMap.clear();
   s_enviromentMap.clear();
-  s_textureCache.clear();
+  ClearCache();
+  s_pack.Close();
 }
 
 std::set<std::string> HiresTexture::GetTextureDirectory(const std::string& game_id)
@@ -193,6 +290,52 @@ std::set<std::string> HiresTexture::GetTextureDirectory(const std::string& game_
   return result;
 }
 
+bool HiresTexture::OpenPack(const std::string& game_id)
+{
+  // Like the directories, a pack may be named after the full or the region-free game ID.
+  const std::string root_directory = File::GetUserPath(D_HIRESTEXTURES_IDX);
+  for (const std::string& name : {game_id, game_id.substr(0, 3)})
+  {
+    const std::string path = root_directory + name + HiresTexturePack::PACK_EXTENSION;
+    if (File::Exists(path) && s_pack.Open(path))
+    {
+      INFO_LOG(VIDEO, "Using custom texture pack %s with %u textures", path.c_str(),
+               s_pack.GetEntryCount());
+      return true;
+    }
+  }
+  return false;
+}
+
+void HiresTexture::ScanDirectory(const std::string& directory, bool BuildMaterialMaps)
+{
+  std::vector<std::string> Extensions;
+  Extensions.push_back(".png");
+  if (!BuildMaterialMaps)
+  {
+    Extensions.push_back(".dds");
+  }
+
+  std::vector<std::string> filenames =
+      Common::DoFileSearch({directory}, Extensions, /*recursive*/ true);
+
+  for (const std::string& fileitem : filenames)
+  {
+    std::string filename;
+    std::string extension;
+    SplitPath(fileitem, nullptr, &filename, &extension);
+    if (filename.rfind(s_format_prefix, 0) == 0)
+    {
+      ProccessTexture(fileitem, filename, extension, BuildMaterialMaps);
+    }
+    else if (filename.rfind(s_enviroment_prefix, 0) == 0)
+    {
+      filename = filename.substr(s_enviroment_prefix.length());
+      ProccessEnviroment(fileitem, filename, extension);
+    }
+  }
+}
+
 static const std::string ddscode = ".dds";
 static const std::string cddscode = ".DDS";
 static const std::string miptag = "mip";
@@ -318,75 +461,36 @@ void HiresTexture::Update()
     s_textureCacheAbortLoading.Set();
     s_prefetcher.join();
   }
+  ReportCacheStatistics();
 
+  s_pack.Close();
   if (!g_ActiveConfig.bHiresTextures)
   {
     s_textureMap.clear();
     s_enviromentMap.clear();
-    s_textureCache.clear();
-    s_enviromentCache.clear();
-    size_sum.store(0);
+    ClearCache();
     return;
   }
 
   if (!g_ActiveConfig.bCacheHiresTextures)
   {
-    s_textureCache.clear();
-    s_enviromentCache.clear();
-    size_sum.store(0);
+    ClearCache();
   }
 
+  max_mem = GetCacheBudget();
+  EvictUntilBelow(max_mem);
+
   s_textureMap.clear();
   s_enviromentMap.clear();
   const std::string& game_id = SConfig::GetInstance().GetGameID();
-  const std::set<std::string> texture_directories = GetTextureDirectory(game_id);
   const std::string resource_directory = File::GetSysDirectory() + RESOURCES_DIR DIR_SEP;
-  std::vector<std::string> Extensions;
-  Extensions.push_back(".png");
-  if (!BuildMaterialMaps)
-  {
-    Extensions.push_back(".dds");
-  }
+  ScanDirectory(resource_directory, BuildMaterialMaps);
 
-  std::vector<std::string> Resourcefilenames =
-      Common::DoFileSearch({resource_directory}, Extensions, /*recursive*/ true);
-
-  for (const std::string& fileitem : Resourcefilenames)
+  // A pack replaces the loose files of the game, so the texture directories aren't scanned.
+  if (!OpenPack(game_id))
   {
-    std::string filename;
-    std::string extension;
-    SplitPath(fileitem, nullptr, &filename, &extension);
-    if (filename.rfind(s_format_prefix, 0) == 0)
-    {
-      ProccessTexture(fileitem, filename, extension, BuildMaterialMaps);
-    }
-    else if (filename.rfind(s_enviroment_prefix, 0) == 0)
-    {
-      filename = filename.substr(s_enviroment_prefix.length());
-      ProccessEnviroment(fileitem, filename, extension);
-    }
-  }
-
-  for (const auto& texture_directory : texture_directories)
-  {
-    std::vector<std::string> filenames =
-        Common::DoFileSearch({texture_directory}, Extensions, /*recursive*/ true);
-
-    for (const std::string& fileitem : filenames)
-    {
-      std::string filename;
-      std::string extension;
-      SplitPath(fileitem, nullptr, &filename, &extension);
-      if (filename.rfind(s_format_prefix, 0) == 0)
-      {
-        ProccessTexture(fileitem, filename, extension, BuildMaterialMaps);
-      }
-      else if (filename.rfind(s_enviroment_prefix, 0) == 0)
-      {
-        filename = filename.substr(s_enviroment_prefix.length());
-        ProccessEnviroment(fileitem, filename, extension);
-      }
-    }
+    for (const auto& texture_directory : GetTextureDirectory(game_id))
+      ScanDirectory(texture_directory, BuildMaterialMaps);
   }
 
   if (g_ActiveConfig.bCacheHiresTextures && s_textureMap.size() > 0)
@@ -397,8 +501,7 @@ void HiresTexture::Update()
     {
       if (s_textureMap.find(iter->first) == s_textureMap.end())
       {
-        size_sum.fetch_sub(iter->second->m_cached_data_size);
-        iter = s_textureCache.erase(iter);
+        iter = EraseCached(s_textureCache, iter);
       }
       else
       {
@@ -411,8 +514,7 @@ void HiresTexture::Update()
     {
       if (s_enviromentMap.find(iterenv->first) == s_enviromentMap.end())
       {
-        size_sum.fetch_sub(iterenv->second->m_cached_data_size);
-        iterenv = s_enviromentCache.erase(iterenv);
+        iterenv = EraseCached(s_enviromentCache, iterenv);
       }
       else
       {
@@ -431,146 +533,95 @@ void HiresTexture::Update()
 void HiresTexture::Prefetch()
 {
   Common::SetCurrentThreadName("Prefetcher");
-  const size_t total = s_textureMap.size() + s_enviromentMap.size();
-  size_t count = 0;
-  size_t notification = 10;
   u32 starttime = Common::Timer::GetTimeMs();
-  for (const auto& entry : s_textureMap)
-  {
-    const std::string& base_filename = entry.first;
-
-    std::unique_lock<std::mutex> lk(s_textureCacheMutex);
-
-    auto iter = s_textureCache.find(base_filename);
-    if (iter == s_textureCache.end())
-    {
-      lk.unlock();
-      HiresTexture* ptr = Load(
-          base_filename, [](size_t requested_size) { return new u8[requested_size]; }, true);
-      lk.lock();
-      if (ptr != nullptr)
-      {
-        size_sum.fetch_add(ptr->m_cached_data_size);
-        iter = s_textureCache.insert(
-            iter, std::make_pair(base_filename, std::shared_ptr<HiresTexture>(ptr)));
-      }
-    }
-
-    if (s_textureCacheAbortLoading.IsSet())
-    {
-      if (g_ActiveConfig.bWaitForCacheHiresTextures)
-      {
-        Host_UpdateProgressDialog("", -1, -1);
-      }
-      return;
-    }
-
-    if (size_sum.load() > max_mem)
-    {
-      Config::SetCurrent(Config::GFX_HIRES_TEXTURES, false);
-
-      OSD::AddMessage(
-          StringFromFormat(
-              "Custom Textures prefetching after %.1f MB aborted, not enough RAM available",
-              size_sum / (1024.0 * 1024.0)),
-          10000);
-      if (g_ActiveConfig.bWaitForCacheHiresTextures)
-      {
-        Host_UpdateProgressDialog("", -1, -1);
-      }
-      return;
-    }
-    count++;
-    size_t percent = (count * 100) / total;
-    if (percent >= notification)
-    {
-      if (g_ActiveConfig.bWaitForCacheHiresTextures)
-      {
-        Host_UpdateProgressDialog(GetStringT("Prefetching Custom Textures...").c_str(),
-                                  static_cast<int>(count), static_cast<int>(total));
-      }
-      else
-      {
-        OSD::AddMessage(StringFromFormat("Custom Textures prefetching %.1f MB %zu %% finished",
-                                         size_sum / (1024.0 * 1024.0), percent),
-                        2000);
-      }
-      notification += 10;
-    }
-  }
 
+  std::vector<std::pair<bool, const std::string*>> work;
+  work.reserve(s_textureMap.size() + s_enviromentMap.size());
+  for (const auto& entry : s_textureMap)
+    work.emplace_back(false, &entry.first);
   for (const auto& entry : s_enviromentMap)
-  {
-    const std::string& base_filename = entry.first;
+    work.emplace_back(true, &entry.first);
 
-    std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+  const size_t total = work.size();
+  std::atomic<size_t> count{0};
+  std::atomic<bool> budget_full{false};
+  std::mutex progress_mutex;
+  size_t notification = 10;
 
-    auto iter = s_enviromentCache.find(base_filename);
-    if (iter == s_enviromentCache.end())
+  // Decoding is CPU bound, so the textures are loaded on the task scheduler's workers.
+  Common::ParallelFor(static_cast<size_t>(0), total, [&](size_t begin, size_t end) {
+    for (size_t item = begin; item < end; ++item)
     {
-      lk.unlock();
-      HiresTexture* ptr = LoadEnviroment(
-          base_filename, [](size_t requested_size) { return new u8[requested_size]; }, true);
-      lk.lock();
-      if (ptr != nullptr)
-      {
-        size_sum.fetch_add(ptr->m_cached_data_size);
-        iter = s_enviromentCache.insert(
-            iter, std::make_pair(base_filename, std::shared_ptr<HiresTexture>(ptr)));
-      }
-    }
+      if (s_textureCacheAbortLoading.IsSet() || budget_full.load())
+        return;
 
-    if (s_textureCacheAbortLoading.IsSet())
-    {
-      if (g_ActiveConfig.bWaitForCacheHiresTextures)
+      const bool enviroment = work[item].first;
+      const std::string& base_filename = *work[item].second;
       {
-        Host_UpdateProgressDialog("", -1, -1);
+        std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+        if (GetCache(enviroment).count(base_filename))
+          continue;
       }
-      return;
-    }
 
-    if (size_sum.load() > max_mem)
-    {
-      Config::SetCurrent(Config::GFX_HIRES_TEXTURES, false);
-
-      OSD::AddMessage(
-          StringFromFormat(
-              "Custom Textures prefetching after %.1f MB aborted, not enough RAM available",
-              size_sum / (1024.0 * 1024.0)),
-          10000);
-      if (g_ActiveConfig.bWaitForCacheHiresTextures)
-      {
-        Host_UpdateProgressDialog("", -1, -1);
-      }
-      return;
-    }
-    count++;
-    size_t percent = (count * 100) / total;
-    if (percent >= notification)
-    {
-      if (g_ActiveConfig.bWaitForCacheHiresTextures)
+      const auto allocate = [](size_t requested_size) { return new u8[requested_size]; };
+      std::shared_ptr<HiresTexture> ptr(enviroment ?
+                                            LoadEnviroment(base_filename, allocate, true) :
+                                            Load(base_filename, allocate, true));
+      if (ptr)
       {
-        Host_UpdateProgressDialog(GetStringT("Prefetching Custom Textures...").c_str(),
-                                  static_cast<int>(count), static_cast<int>(total));
+        std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+        // Prefetching never evicts anything; what doesn't fit is streamed in on first use.
+        if (size_sum.load() + ptr->m_cached_data_size > max_mem)
+        {
+          budget_full.store(true);
+          return;
+        }
+        InsertCached(enviroment, base_filename, std::move(ptr));
       }
-      else
+
+      const size_t done = ++count;
+      const size_t percent = (done * 100) / total;
+      std::lock_guard<std::mutex> lk(progress_mutex);
+      if (percent >= notification)
       {
-        OSD::AddMessage(StringFromFormat("Custom Textures prefetching %.1f MB %zu %% finished",
-                                         size_sum / (1024.0 * 1024.0), percent),
-                        2000);
+        if (g_ActiveConfig.bWaitForCacheHiresTextures)
+        {
+          Host_UpdateProgressDialog(GetStringT("Prefetching Custom Textures...").c_str(),
+                                    static_cast<int>(done), static_cast<int>(total));
+        }
+        else
+        {
+          OSD::AddMessage(StringFromFormat("Custom Textures prefetching %.1f MB %zu %% finished",
+                                           size_sum / (1024.0 * 1024.0), percent),
+                          2000);
+        }
+        notification = percent - percent % 10 + 10;
       }
-      notification += 10;
     }
-  }
+  });
 
   if (g_ActiveConfig.bWaitForCacheHiresTextures)
   {
     Host_UpdateProgressDialog("", -1, -1);
   }
+  if (s_textureCacheAbortLoading.IsSet())
+    return;
+
   u32 stoptime = Common::Timer::GetTimeMs();
-  OSD::AddMessage(StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s",
-                                   size_sum / (1024.0 * 1024.0), (stoptime - starttime) / 1000.0),
-                  10000);
+  if (budget_full.load())
+  {
+    OSD::AddMessage(StringFromFormat("Custom Textures prefetching stopped at the %.1f MB budget, "
+                                     "remaining textures will be streamed in",
+                                     max_mem / (1024.0 * 1024.0)),
+                    10000);
+  }
+  else
+  {
+    OSD::AddMessage(StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s",
+                                     size_sum / (1024.0 * 1024.0),
+                                     (stoptime - starttime) / 1000.0),
+                    10000);
+  }
 }
 
 std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
@@ -626,11 +677,15 @@ std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, co
   std::string fullname = basename + tlutname + formatname;
   std::string wildcardname = basename + "_$" + formatname;
 
-  if (!dump && s_textureMap.find(wildcardname) != s_textureMap.end())
+  const auto exists = [](const std::string& candidate) {
+    return s_textureMap.find(candidate) != s_textureMap.end() ||
+           s_pack.Find(HiresTexturePack::EntryKind::Texture, candidate);
+  };
+  if (!dump && exists(wildcardname))
     return wildcardname;
 
     // else generate the complete texture
-  if (dump || s_textureMap.find(fullname) != s_textureMap.end())
+  if (dump || exists(fullname))
     return fullname;
 
   return "";
@@ -748,45 +803,70 @@ inline void BuildMaterial(const HiresTextureCacheItem& item, ImageLoaderParams&
   }
 }
 
+// Looks up a texture in the cache, loading it (and evicting others if needed) on a miss.
+static std::shared_ptr<HiresTexture>
+SearchCached(bool enviroment, const std::string& basename,
+             const std::function<u8*(size_t)>& request_buffer_delegate,
+             const std::function<HiresTexture*(std::function<u8*(size_t)>)>& load)
+{
+  std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+
+  std::shared_ptr<HiresTexture> ptr = LookupCached(enviroment, basename);
+  if (ptr)
+  {
+    s_cache_stats.hits++;
+  }
+  else
+  {
+    s_cache_stats.misses++;
+    lk.unlock();
+    ptr.reset(load([](size_t requested_size) { return new u8[requested_size]; }));
+    if (!ptr)
+      return nullptr;
+    lk.lock();
+    if (ptr->m_cached_data_size <= max_mem)
+    {
+      EvictUntilBelow(max_mem - ptr->m_cached_data_size);
+      InsertCached(enviroment, basename, ptr);
+    }
+  }
+
+  u8* dst = request_buffer_delegate(ptr->m_cached_data_size);
+  memcpy(dst, ptr->m_cached_data.get(), ptr->m_cached_data_size);
+  return ptr;
+}
+
 std::shared_ptr<HiresTexture>
 HiresTexture::Search(const std::string& basename,
                      std::function<u8*(size_t)> request_buffer_delegate)
 {
+  // Packed textures are copied straight out of the mapping; the OS page cache is their cache.
+  if (HiresTexture* packed =
+          LoadPacked(HiresTexturePack::EntryKind::Texture, basename, request_buffer_delegate))
+  {
+    return std::shared_ptr<HiresTexture>(packed);
+  }
   if (g_ActiveConfig.bCacheHiresTextures)
   {
-    std::unique_lock<std::mutex> lk(s_textureCacheMutex);
-
-    auto iter = s_textureCache.find(basename);
-    if (iter != s_textureCache.end())
-    {
-      HiresTexture* current = iter->second.get();
-      u8* dst = request_buffer_delegate(current->m_cached_data_size);
-      memcpy(dst, current->m_cached_data.get(), current->m_cached_data_size);
-      return iter->second;
-    }
-    lk.unlock();
-    if (size_sum.load() < max_mem)
-    {
-      std::shared_ptr<HiresTexture> ptr(Load(
-          basename, [](size_t requested_size) { return new u8[requested_size]; }, true));
-      lk.lock();
-      if (ptr)
-      {
-        s_textureCache[basename] = ptr;
-        HiresTexture* current = ptr.get();
-        size_sum.fetch_add(current->m_cached_data_size);
-        u8* dst = request_buffer_delegate(current->m_cached_data_size);
-        memcpy(dst, current->m_cached_data.get(), current->m_cached_data_size);
-      }
-      return ptr;
-    }
+    return SearchCached(false, basename, request_buffer_delegate,
+                        [&basename](std::function<u8*(size_t)> allocate) {
+                          return Load(basename, allocate, true);
+                        });
   }
   return std::shared_ptr<HiresTexture>(Load(basename, request_buffer_delegate, false));
 }
 
 bool HiresTexture::EnviromentExists(const std::string& basename)
 {
-  if (s_enviromentMap.size() == 0 || !g_ActiveConfig.HiresMaterialMapsEnabled())
+  if (!g_ActiveConfig.HiresMaterialMapsEnabled())
+  {
+    return false;
+  }
+  if (s_pack.Find(HiresTexturePack::EntryKind::Enviroment, basename))
+  {
+    return true;
+  }
+  if (s_enviromentMap.size() == 0)
   {
     return false;
   }
@@ -802,35 +882,21 @@ std::shared_ptr<HiresTexture>
 HiresTexture::SearchEnviroment(const std::string& basename,
                                std::function<u8*(size_t)> request_buffer_delegate)
 {
-  if (g_ActiveConfig.bCacheHiresTextures)
+  if (g_ActiveConfig.HiresMaterialMapsEnabled())
   {
-    std::unique_lock<std::mutex> lk(s_textureCacheMutex);
-
-    auto iter = s_enviromentCache.find(basename);
-    if (iter != s_enviromentCache.end())
-    {
-      HiresTexture* current = iter->second.get();
-      u8* dst = request_buffer_delegate(current->m_cached_data_size);
-      memcpy(dst, current->m_cached_data.get(), current->m_cached_data_size);
-      return iter->second;
-    }
-    lk.unlock();
-    if (size_sum.load() < max_mem)
+    if (HiresTexture* packed =
+            LoadPacked(HiresTexturePack::EntryKind::Enviroment, basename, request_buffer_delegate))
     {
-      std::shared_ptr<HiresTexture> ptr(LoadEnviroment(
-          basename, [](size_t requested_size) { return new u8[requested_size]; }, true));
-      lk.lock();
-      if (ptr)
-      {
-        s_enviromentCache[basename] = ptr;
-        HiresTexture* current = ptr.get();
-        size_sum.fetch_add(current->m_cached_data_size);
-        u8* dst = request_buffer_delegate(current->m_cached_data_size);
-        memcpy(dst, current->m_cached_data.get(), current->m_cached_data_size);
-      }
-      return ptr;
+      return std::shared_ptr<HiresTexture>(packed);
     }
   }
+  if (g_ActiveConfig.bCacheHiresTextures)
+  {
+    return SearchCached(true, basename, request_buffer_delegate,
+                        [&basename](std::function<u8*(size_t)> allocate) {
+                          return LoadEnviroment(basename, allocate, true);
+                        });
+  }
   return std::shared_ptr<HiresTexture>(LoadEnviroment(basename, request_buffer_delegate, false));
 }
 
@@ -1274,3 +1340,106 @@ HiresTexture* HiresTexture::LoadEnviroment(const std::string& basename,
   }
   return ret;
 }
+
+HiresTexture* HiresTexture::LoadPacked(HiresTexturePack::EntryKind kind,
+                                       const std::string& basename,
+                                       const std::function<u8*(size_t)>& request_buffer_delegate)
+{
+  const HiresTexturePack::FileEntry* entry = s_pack.Find(kind, basename);
+  if (!entry)
+  {
+    return nullptr;
+  }
+  HiresTexture* ret = new HiresTexture();
+  ret->has_arbitrary_mips = entry->has_arbitrary_mips != 0;
+  ret->m_format = static_cast<HostTextureFormat>(entry->format);
+  ret->m_width = entry->width;
+  ret->m_height = entry->height;
+  ret->m_levels = entry->levels;
+  ret->m_nrm_levels = entry->nrm_levels;
+  ret->m_lum_levels = entry->lum_levels;
+  ret->m_cached_data_size = static_cast<size_t>(entry->data_size);
+  u8* dst = request_buffer_delegate(ret->m_cached_data_size);
+  memcpy(dst, s_pack.GetData(*entry), ret->m_cached_data_size);
+  return ret;
+}
+
+bool HiresTexture::BuildPack(const std::vector<std::string>& directories,
+                             const std::string& pack_path,
+                             const std::function<void(size_t, size_t)>& progress)
+{
+  s_pack.Close();
+  s_textureMap.clear();
+  s_enviromentMap.clear();
+  for (const std::string& directory : directories)
+  {
+    ScanDirectory(directory, g_ActiveConfig.bHiresMaterialMapsBuild);
+  }
+
+  std::vector<std::pair<HiresTexturePack::EntryKind, const std::string*>> work;
+  work.reserve(s_textureMap.size() + s_enviromentMap.size());
+  for (const auto& entry : s_textureMap)
+    work.emplace_back(HiresTexturePack::EntryKind::Texture, &entry.first);
+  for (const auto& entry : s_enviromentMap)
+    work.emplace_back(HiresTexturePack::EntryKind::Enviroment, &entry.first);
+
+  HiresTexturePack::Writer writer;
+  if (!writer.Open(pack_path))
+  {
+    ERROR_LOG(VIDEO, "Failed to create custom texture pack %s", pack_path.c_str());
+    return false;
+  }
+
+  // Decode a batch in parallel, then write it out in order, so only one batch is in memory.
+  const size_t batch_size = (Common::TaskScheduler::GetWorkerCount() + 1) * 4;
+  std::vector<std::unique_ptr<HiresTexture>> batch(batch_size);
+  bool success = true;
+  for (size_t batch_start = 0; batch_start < work.size() && success; batch_start += batch_size)
+  {
+    const size_t batch_end = std::min(work.size(), batch_start + batch_size);
+    Common::ParallelFor(batch_start, batch_end, [&](size_t begin, size_t end) {
+      const auto allocate = [](size_t requested_size) { return new u8[requested_size]; };
+      for (size_t i = begin; i < end; ++i)
+      {
+        const std::string& name = *work[i].second;
+        batch[i - batch_start].reset(work[i].first == HiresTexturePack::EntryKind::Enviroment ?
+                                         LoadEnviroment(name, allocate, true) :
+                                         Load(name, allocate, true));
+      }
+    });
+
+    for (size_t i = batch_start; i < batch_end && success; ++i)
+    {
+      const std::unique_ptr<HiresTexture> texture = std::move(batch[i - batch_start]);
+      if (!texture)
+      {
+        WARN_LOG(VIDEO, "Custom texture %s could not be loaded, skipping it",
+                 work[i].second->c_str());
+        continue;
+      }
+      HiresTexturePack::FileEntry entry = {};
+      entry.width = texture->m_width;
+      entry.height = texture->m_height;
+      entry.levels = texture->m_levels;
+      entry.nrm_levels = texture->m_nrm_levels;
+      entry.lum_levels = texture->m_lum_levels;
+      entry.format = static_cast<u32>(texture->m_format);
+      entry.has_arbitrary_mips = texture->has_arbitrary_mips;
+      success = writer.Add(work[i].first, *work[i].second, entry, texture->m_cached_data.get(),
+                           texture->m_cached_data_size);
+    }
+    if (progress)
+    {
+      progress(batch_end, work.size());
+    }
+  }
+
+  success = writer.Finish() && success;
+  if (!success)
+  {
+    ERROR_LOG(VIDEO, "Failed to write custom texture pack %s", pack_path.c_str());
+  }
+  s_textureMap.clear();
+  s_enviromentMap.clear();
+  return success;
+}
@@ -11,6 +11,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "VideoCommon/HiresTexturePack.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoCommon.h"
 
@@ -29,6 +30,11 @@ public:
 
   static bool EnviromentExists(const std::string& basename);
 
+  // Loads every custom texture found in directories, using the current video config, and writes
+  // them to a pack. progress is called with (done, total) as textures are written.
+  static bool BuildPack(const std::vector<std::string>& directories, const std::string& pack_path,
+                        const std::function<void(size_t, size_t)>& progress);
+
   static std::string GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
                                  size_t tlut_size, u32 width, u32 height, int format,
                                  bool has_mipmaps, bool dump = false);
@@ -51,6 +57,11 @@ private:
                                       std::function<u8*(size_t)> request_buffer_delegate,
                                       bool cacheresult);
 
+  static bool OpenPack(const std::string& game_id);
+  static void ScanDirectory(const std::string& directory, bool BuildMaterialMaps);
+  static HiresTexture* LoadPacked(HiresTexturePack::EntryKind kind, const std::string& basename,
+                                  const std::function<u8*(size_t)>& request_buffer_delegate);
+
   static void Prefetch();
   HiresTexture();
   static std::set<std::string> GetTextureDirectory(const std::string& game_id);
@@ -2,14 +2,23 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <list>
+#include <mutex>
 #include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "png.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/TaskScheduler.h"
 #include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/VideoConfig.h"
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -35,7 +44,7 @@ data      : This is an array of RGBA with 8 bits per channel. 4 bytes for each p
 row_stride: Determines the amount of bytes per row of pixels.
 */
 bool TextureToPng(const u8* data, int row_stride, const std::string& filename, int width,
-  int height, bool saveAlpha, bool frombgra)
+  int height, bool saveAlpha, bool frombgra, int compression_level)
 {
   bool success = false;
 
@@ -84,6 +93,8 @@ bool TextureToPng(const u8* data, int row_stride, const std::string& filename, i
   }
 
   png_init_io(png_ptr, fp.GetHandle());
+  if (compression_level >= 0)
+    png_set_compression_level(png_ptr, compression_level);
 
   // Write header (8 bit color depth)
   png_set_IHDR(png_ptr, info_ptr, width, height, 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
@@ -136,3 +147,168 @@ finalise:
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
+
+namespace
+{
+struct ImageJob
+{
+  std::vector<u8> data;
+  int row_stride;
+  std::string filename;
+  int width;
+  int height;
+  bool dds;
+  bool save_alpha;
+  bool from_bgra;
+  DDSCompression dds_format;
+  int compression_level;
+};
+
+// Pixel data waiting to be written (or being written) before producers have to wait.
+constexpr size_t MAX_QUEUED_BYTES = 128 * 1024 * 1024;
+// Claimed keys are forgotten past this many. At worst an image is then dumped a second time.
+constexpr size_t MAX_CLAIMED_KEYS = 65536;
+
+class ImageQueue
+{
+public:
+  void Push(ImageJob job)
+  {
+    {
+      std::unique_lock<std::mutex> lk(m_mutex);
+      // Let a single oversized image through, otherwise it could never be queued.
+      const size_t size = job.data.size();
+      m_space_available.wait(lk, [&] {
+        return m_queued_bytes == 0 || m_queued_bytes + size <= MAX_QUEUED_BYTES;
+      });
+      m_queued_bytes += size;
+      m_jobs.push_back(std::move(job));
+    }
+    // Each task writes whichever job is next, which keeps the job out of the task's storage.
+    m_tasks.Run([this] { WriteNext(); });
+  }
+
+  bool Claim(u64 key)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_claimed.size() >= MAX_CLAIMED_KEYS)
+      m_claimed.clear();
+    return m_claimed.insert(key).second;
+  }
+
+  void Flush() { m_tasks.Wait(); }
+
+  void Shutdown()
+  {
+    Flush();
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_claimed.clear();
+  }
+
+private:
+  void WriteNext()
+  {
+    ImageJob job;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    if (job.dds)
+    {
+      TextureToDDS(job.data.data(), job.row_stride, job.filename, job.width, job.height,
+                   job.dds_format);
+    }
+    else
+    {
+      TextureToPng(job.data.data(), job.row_stride, job.filename, job.width, job.height,
+                   job.save_alpha, job.from_bgra, job.compression_level);
+    }
+
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_queued_bytes -= job.data.size();
+    }
+    m_space_available.notify_all();
+  }
+
+  std::mutex m_mutex;
+  std::condition_variable m_space_available;
+  std::deque<ImageJob> m_jobs;
+  size_t m_queued_bytes = 0;
+  std::unordered_set<u64> m_claimed;
+  Common::TaskGroup m_tasks;
+};
+
+ImageQueue s_image_queue;
+
+// Copies rows rows of row_bytes each, dropping any padding of the source stride.
+std::vector<u8> CopyRows(const u8* data, int row_stride, size_t row_bytes, size_t rows)
+{
+  std::vector<u8> copy(row_bytes * rows);
+  for (size_t y = 0; y < rows; ++y)
+    std::memcpy(copy.data() + y * row_bytes, data + y * row_stride, row_bytes);
+  return copy;
+}
+
+size_t DDSRowBytes(int width)
+{
+  return static_cast<size_t>((width + 3) >> 2) * 16;
+}
+
+size_t DDSRows(int height)
+{
+  return static_cast<size_t>((height + 3) >> 2);
+}
+}  // Anonymous namespace
+
+void QueueTextureToPng(const u8* data, int row_stride, const std::string& filename, int width,
+  int height, bool saveAlpha, bool frombgra)
+{
+  if (!data)
+    return;
+  const size_t row_bytes = static_cast<size_t>(width) * 4;
+  QueueTextureToPng(CopyRows(data, row_stride, row_bytes, height), static_cast<int>(row_bytes),
+                    filename, width, height, saveAlpha, frombgra);
+}
+
+void QueueTextureToPng(std::vector<u8> data, int row_stride, const std::string& filename,
+  int width, int height, bool saveAlpha, bool frombgra)
+{
+  s_image_queue.Push({std::move(data), row_stride, filename, width, height, false, saveAlpha,
+                      frombgra, DDSCompression::DDSC_DXT3, g_ActiveConfig.iPNGCompressionLevel});
+}
+
+void QueueTextureToDDS(const u8* data, int row_stride, const std::string& filename, int width,
+  int height, DDSCompression format)
+{
+  if (!data)
+    return;
+  const size_t row_bytes = DDSRowBytes(width);
+  QueueTextureToDDS(CopyRows(data, row_stride, row_bytes, DDSRows(height)),
+                    static_cast<int>(row_bytes), filename, width, height, format);
+}
+
+void QueueTextureToDDS(std::vector<u8> data, int row_stride, const std::string& filename,
+  int width, int height, DDSCompression format)
+{
+  s_image_queue.Push({std::move(data), row_stride, filename, width, height, true, false, false,
+                      format, -1});
+}
+
+bool ClaimImageDump(u64 key)
+{
+  return s_image_queue.Claim(key);
+}
+
+void FlushImageQueue()
+{
+  s_image_queue.Flush();
+}
+
+void ShutdownImageQueue()
+{
+  s_image_queue.Shutdown();
+}
@@ -5,10 +5,33 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "Common/Common.h"
 #include "VideoCommon/ImageLoader.h"
 
 bool SaveData(const std::string& filename, const std::string& data);
 bool TextureToPng(const u8* data, int row_stride, const std::string& filename, int width,
-  int height, bool saveAlpha = false, bool frombgra = false);
+  int height, bool saveAlpha = false, bool frombgra = false, int compression_level = -1);
 bool TextureToDDS(const u8* data, int row_stride, const std::string& filename, int width, int height, DDSCompression format = DDSCompression::DDSC_DXT3);
+
+// Background image writing, used for texture and EFB dumps. Images are encoded and written as
+// tasks on the Common::TaskScheduler, using the PNG compression level from the video config. The
+// queue is bounded: when it is full, queueing waits for the tasks to catch up.
+//
+// The pointer versions copy the pixels before returning; the vector versions take ownership of
+// data, which must hold height rows of row_stride bytes (block rows for DDS).
+void QueueTextureToPng(const u8* data, int row_stride, const std::string& filename, int width,
+  int height, bool saveAlpha = false, bool frombgra = false);
+void QueueTextureToPng(std::vector<u8> data, int row_stride, const std::string& filename,
+  int width, int height, bool saveAlpha = false, bool frombgra = false);
+void QueueTextureToDDS(const u8* data, int row_stride, const std::string& filename, int width,
+  int height, DDSCompression format = DDSCompression::DDSC_DXT3);
+void QueueTextureToDDS(std::vector<u8> data, int row_stride, const std::string& filename,
+  int width, int height, DDSCompression format = DDSCompression::DDSC_DXT3);
+// Returns true the first time key is claimed, so dumps of the same image can be skipped before
+// reading it back from the GPU.
+bool ClaimImageDump(u64 key);
+// Waits until every queued image has been written.
+void FlushImageQueue();
+// Writes out the queue and forgets claimed keys.
+void ShutdownImageQueue();
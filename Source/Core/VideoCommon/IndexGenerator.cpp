@@ -2,9 +2,11 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cstddef>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OpcodeDecoding.h"
@@ -14,20 +16,145 @@
 u16 *IndexGenerator::index_buffer_current;
 u16 *IndexGenerator::BASEIptr;
 u32 IndexGenerator::base_index;
+bool IndexGenerator::use_primitive_restart;
 
 static void(*primitive_table[8])(u32);
 
-void IndexGenerator::Init()
+namespace
 {
-  primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = IndexGenerator::AddQuads;
-#if defined(_DEBUG) || defined(DEBUGFAST)
-  primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = IndexGenerator::AddQuads_nonstandard;
+constexpr u16 R = IndexGenerator::RESTART_INDEX;
+
+// A repeating run of N * 8 indices. Each lane starts at first + offset (or at RESTART_INDEX for
+// restart lanes) and advances by its step every time the run is repeated.
+template <size_t N>
+struct IndexPattern
+{
+  std::array<u16, N * 8> offsets;
+  std::array<u16, N * 8> steps;
+};
+
+// 8 strip triangles: 012 132 234 354 ...
+constexpr IndexPattern<3> STRIP_PATTERN = {
+    {{0, 1, 2, 1, 3, 2, 2, 3, 4, 3, 5, 4, 4, 5, 6, 5, 7, 6, 6, 7, 8, 7, 9, 8}},
+    {{8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8}}};
+
+// 8 fan triangles around vertex 0: 012 023 034 ...
+constexpr IndexPattern<3> FAN_PATTERN = {
+    {{0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 5, 0, 5, 6, 0, 6, 7, 0, 7, 8, 0, 8, 9}},
+    {{0, 8, 8, 0, 8, 8, 0, 8, 8, 0, 8, 8, 0, 8, 8, 0, 8, 8, 0, 8, 8, 0, 8, 8}}};
+
+// 4 quads, two triangles each: 012 023 456 467 ...
+constexpr IndexPattern<3> QUAD_PATTERN = {
+    {{0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7, 8, 9, 10, 8, 10, 11, 12, 13, 14, 12, 14, 15}},
+    {{16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+      16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16}}};
+
+// 4 line strip segments: 01 12 23 34
+constexpr IndexPattern<1> LINE_STRIP_PATTERN = {{{0, 1, 1, 2, 2, 3, 3, 4}},
+                                                {{4, 4, 4, 4, 4, 4, 4, 4}}};
+
+// Primitive restart variants.
+
+// 2 separate triangles: 012 345
+constexpr IndexPattern<1> LIST_PR_PATTERN = {{{0, 1, 2, R, 3, 4, 5, R}},
+                                             {{6, 6, 6, 0, 6, 6, 6, 0}}};
+
+// 4 strips of 3 fan triangles each, see AddFan: 12034 45067 ...
+constexpr IndexPattern<3> FAN_PR_PATTERN = {
+    {{1, 2, 0, 3, 4, R, 4, 5, 0, 6, 7, R, 7, 8, 0, 9, 10, R, 10, 11, 0, 12, 13, R}},
+    {{12, 12, 0, 12, 12, 0, 12, 12, 0, 12, 12, 0, 12, 12, 0, 12, 12, 0, 12, 12, 0, 12, 12, 0}}};
+
+// 8 quads as strips, see AddQuads: 1203 5647 ...
+constexpr IndexPattern<5> QUAD_PR_PATTERN = {
+    {{1,  2,  0,  3,  R,  5,  6,  4,  7,  R,  9,  10, 8,  11, R,  13, 14, 12, 15, R,
+      17, 18, 16, 19, R,  21, 22, 20, 23, R,  25, 26, 24, 27, R,  29, 30, 28, 31, R}},
+    {{32, 32, 32, 32, 0, 32, 32, 32, 32, 0, 32, 32, 32, 32, 0, 32, 32, 32, 32, 0,
+      32, 32, 32, 32, 0, 32, 32, 32, 32, 0, 32, 32, 32, 32, 0, 32, 32, 32, 32, 0}}};
+
+// Writes `repeats` copies of pattern starting at vertex first.
+template <size_t N>
+u16* WritePattern(u16* ptr, u32 first, u32 repeats, const IndexPattern<N>& pattern)
+{
+#if _M_SSE >= 0x200
+  const __m128i first_vec = _mm_set1_epi16(static_cast<s16>(first));
+  const __m128i restart_vec = _mm_set1_epi16(static_cast<s16>(R));
+  __m128i values[N];
+  __m128i steps[N];
+  for (size_t n = 0; n < N; ++n)
+  {
+    const __m128i offsets =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pattern.offsets[n * 8]));
+    const __m128i is_restart = _mm_cmpeq_epi16(offsets, restart_vec);
+    values[n] = _mm_add_epi16(offsets, _mm_andnot_si128(is_restart, first_vec));
+    steps[n] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pattern.steps[n * 8]));
+  }
+
+  for (u32 r = 0; r < repeats; ++r)
+  {
+    for (size_t n = 0; n < N; ++n)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr + n * 8), values[n]);
+      values[n] = _mm_add_epi16(values[n], steps[n]);
+    }
+    ptr += N * 8;
+  }
 #else
-  primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = IndexGenerator::AddQuads;
+  for (u32 r = 0; r < repeats; ++r)
+  {
+    for (size_t i = 0; i < N * 8; ++i)
+    {
+      *ptr++ = pattern.offsets[i] == R ? R :
+                                         static_cast<u16>(first + pattern.offsets[i] +
+                                                          r * pattern.steps[i]);
+    }
+  }
+#endif
+  return ptr;
+}
+
+// Writes first, first + 1, ..., first + count - 1.
+u16* WriteSequence(u16* ptr, u32 first, u32 count)
+{
+  u32 i = 0;
+#if _M_SSE >= 0x200
+  __m128i values = _mm_add_epi16(_mm_set1_epi16(static_cast<s16>(first)),
+                                 _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m128i step = _mm_set1_epi16(8);
+  for (; i + 8 <= count; i += 8)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), values);
+    values = _mm_add_epi16(values, step);
+    ptr += 8;
+  }
+#endif
+  for (; i < count; ++i)
+    *ptr++ = first + i;
+  return ptr;
+}
+}  // Anonymous namespace
+
+void IndexGenerator::Init(bool primitive_restart)
+{
+  use_primitive_restart = primitive_restart;
+  if (primitive_restart)
+  {
+    primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = IndexGenerator::AddQuads<true>;
+    primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = IndexGenerator::AddQuads_nonstandard<true>;
+    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLES] = IndexGenerator::AddList<true>;
+    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStrip<true>;
+    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_FAN] = IndexGenerator::AddFan<true>;
+  }
+  else
+  {
+    primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = IndexGenerator::AddQuads<false>;
+    primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = IndexGenerator::AddQuads_nonstandard<false>;
+    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLES] = IndexGenerator::AddList<false>;
+    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStrip<false>;
+    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_FAN] = IndexGenerator::AddFan<false>;
+  }
+#if !defined(_DEBUG) && !defined(DEBUGFAST)
+  primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = primitive_table[OpcodeDecoder::GX_DRAW_QUADS];
 #endif
-  primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLES] = IndexGenerator::AddList;
-  primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStrip;
-  primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_FAN] = IndexGenerator::AddFan;
   primitive_table[OpcodeDecoder::GX_DRAW_LINES] = &IndexGenerator::AddLineList;
   primitive_table[OpcodeDecoder::GX_DRAW_LINE_STRIP] = &IndexGenerator::AddLineStrip;
   primitive_table[OpcodeDecoder::GX_DRAW_POINTS] = &IndexGenerator::AddPoints;
@@ -47,32 +174,60 @@ void IndexGenerator::AddIndices(int primitive, u32 numVerts)
 }
 
 // Triangles
+template <bool pr>
 __forceinline u16* IndexGenerator::WriteTriangle(u16* ptr, u32 index1, u32 index2, u32 index3)
 {
   *ptr++ = index1;
   *ptr++ = index2;
   *ptr++ = index3;
+  if (pr)
+    *ptr++ = R;
   return ptr;
 }
 
+template <bool pr>
 void IndexGenerator::AddList(u32 const numVerts)
 {
-  u32 i = base_index + 2;
-  u32 top = (base_index + numVerts);
+  const u32 num_triangles = numVerts / 3;
   u16* ptr = index_buffer_current;
-  while (i < top)
+  if (pr)
+  {
+    ptr = WritePattern(ptr, base_index, num_triangles / 2, LIST_PR_PATTERN);
+    if (num_triangles & 1)
+    {
+      const u32 i = base_index + (num_triangles - 1) * 3;
+      ptr = WriteTriangle<pr>(ptr, i, i + 1, i + 2);
+    }
+  }
+  else
   {
-    ptr = WriteTriangle(ptr, i - 2, i - 1, i);
-    i += 3;
+    // A list is just every vertex in order.
+    ptr = WriteSequence(ptr, base_index, num_triangles * 3);
   }
   index_buffer_current = ptr;
 }
 
+template <bool pr>
 void IndexGenerator::AddStrip(u32 const numVerts)
 {
+  if (numVerts < 3)
+    return;
+
   u16* ptr = index_buffer_current;
+  if (pr)
+  {
+    ptr = WriteSequence(ptr, base_index, numVerts);
+    *ptr++ = R;
+    index_buffer_current = ptr;
+    return;
+  }
+
+  const u32 num_triangles = numVerts - 2;
+  const u32 repeats = num_triangles / 8;
+  ptr = WritePattern(ptr, base_index, repeats, STRIP_PATTERN);
+
   u32 top = (base_index + numVerts);
-  u32 a = base_index;
+  u32 a = base_index + repeats * 8;
   u32 i = a + 2;
   u32 wind = 1;
   while (i < top)
@@ -80,7 +235,7 @@ void IndexGenerator::AddStrip(u32 const numVerts)
     u32 b = i - wind;
     wind ^= 1;
     u32 c = i - wind;
-    ptr = WriteTriangle(
+    ptr = WriteTriangle<pr>(
       ptr,
       a,
       b,
@@ -110,17 +265,49 @@ void IndexGenerator::AddStrip(u32 const numVerts)
  * so we use 6 indices for 3 triangles
  */
 
+template <bool pr>
 void IndexGenerator::AddFan(u32 numVerts)
 {
-  u32 i = base_index + 2;
-  u32 top = (base_index + numVerts);
+  if (numVerts < 3)
+    return;
+
+  u32 i = 2;
   u16* ptr = index_buffer_current;
 
-  while (i < top)
+  if (pr)
   {
-    ptr = WriteTriangle(ptr, base_index, i - 1, i);
-    ++i;
+    const u32 num_strips = (numVerts - 2) / 3;
+    ptr = WritePattern(ptr, base_index, num_strips / 4, FAN_PR_PATTERN);
+    i += num_strips / 4 * 12;
+    for (; i + 3 <= numVerts; i += 3)
+    {
+      *ptr++ = base_index + i - 1;
+      *ptr++ = base_index + i;
+      *ptr++ = base_index;
+      *ptr++ = base_index + i + 1;
+      *ptr++ = base_index + i + 2;
+      *ptr++ = R;
+    }
+    // 1203
+    if (i + 2 <= numVerts)
+    {
+      *ptr++ = base_index + i - 1;
+      *ptr++ = base_index + i;
+      *ptr++ = base_index;
+      *ptr++ = base_index + i + 1;
+      *ptr++ = R;
+      i += 2;
+    }
+  }
+  else
+  {
+    const u32 repeats = (numVerts - 2) / 8;
+    ptr = WritePattern(ptr, base_index, repeats, FAN_PATTERN);
+    i += repeats * 8;
   }
+
+  for (; i < numVerts; ++i)
+    ptr = WriteTriangle<pr>(ptr, base_index, base_index + i - 1, base_index + i);
   index_buffer_current = ptr;
 }
 
@@ -141,54 +328,71 @@ void IndexGenerator::AddFan(u32 numVerts)
  * A simple triangle has to be rendered for three vertices.
  * ZWW do this for sun rays
  */
+template <bool pr>
 void IndexGenerator::AddQuads(u32 numVerts)
 {
-  u32 i = base_index + 3;
-  u32 top = (base_index + numVerts);
+  const u32 num_quads = numVerts / 4;
+  const u32 repeats = pr ? num_quads / 8 : num_quads / 4;
   u16* ptr = index_buffer_current;
+  if (pr)
+    ptr = WritePattern(ptr, base_index, repeats, QUAD_PR_PATTERN);
+  else
+    ptr = WritePattern(ptr, base_index, repeats, QUAD_PATTERN);
+
+  u32 i = base_index + 3 + repeats * (pr ? 32 : 16);
+  u32 top = (base_index + numVerts);
   while (i < top)
   {
-    ptr = WriteTriangle(ptr, i - 3, i - 2, i - 1);
-    ptr = WriteTriangle(ptr, i - 3, i - 1, i - 0);
+    if (pr)
+    {
+      *ptr++ = i - 2;
+      *ptr++ = i - 1;
+      *ptr++ = i - 3;
+      *ptr++ = i - 0;
+      *ptr++ = R;
+    }
+    else
+    {
+      ptr = WriteTriangle<pr>(ptr, i - 3, i - 2, i - 1);
+      ptr = WriteTriangle<pr>(ptr, i - 3, i - 1, i - 0);
+    }
     i += 4;
   }
 
   // three vertices remaining, so render a triangle
   if (i == top)
   {
-    ptr = WriteTriangle(ptr, top - 3, top - 2, top - 1);
+    ptr = WriteTriangle<pr>(ptr, top - 3, top - 2, top - 1);
   }
   index_buffer_current = ptr;
 }
 
+template <bool pr>
 void IndexGenerator::AddQuads_nonstandard(u32 numVerts)
 {
   WARN_LOG(VIDEO, "Non-standard primitive drawing command GL_DRAW_QUADS_2");
-  AddQuads(numVerts);
+  AddQuads<pr>(numVerts);
 }
 
 // Lines
 void IndexGenerator::AddLineList(u32 numVerts)
 {
-  u32 i = base_index + 1;
-  u32 top = (base_index + numVerts);
-  u16* ptr = index_buffer_current;
-  while (i < top)
-  {
-    *ptr++ = i - 1;
-    *ptr++ = i;
-    i += 2;
-  }
-  index_buffer_current = ptr;
+  // Every vertex in order, minus a trailing unpaired one.
+  index_buffer_current = WriteSequence(index_buffer_current, base_index, numVerts & ~1u);
 }
 
 // shouldn't be used as strips as LineLists are much more common
 // so converting them to lists
 void IndexGenerator::AddLineStrip(u32 numVerts)
 {
-  u32 i = base_index + 1;
+  if (numVerts < 2)
+    return;
+
+  const u32 repeats = (numVerts - 1) / 4;
+  u16* ptr = WritePattern(index_buffer_current, base_index, repeats, LINE_STRIP_PATTERN);
+
+  u32 i = base_index + 1 + repeats * 4;
   u32 top = (base_index + numVerts);
-  u16* ptr = index_buffer_current;
   while (i < top)
   {
     *ptr++ = i - 1;
@@ -201,13 +405,5 @@ void IndexGenerator::AddLineStrip(u32 numVerts)
 // Points
 void IndexGenerator::AddPoints(u32 numVerts)
 {
-  u32 i = base_index;
-  u32 top = (base_index + numVerts);
-  u16 *ptr = index_buffer_current;
-  while (i < top)
-  {
-    *ptr++ = i;
-    ++i;
-  }
-  index_buffer_current = ptr;
+  index_buffer_current = WriteSequence(index_buffer_current, base_index, numVerts);
 }
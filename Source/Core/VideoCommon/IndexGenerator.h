@@ -8,8 +8,13 @@
 class IndexGenerator
 {
 public:
+  // Index value that ends the current strip when primitive restart is in use.
+  static constexpr u16 RESTART_INDEX = 65535;
+
   // Init
-  static void Init();
+  // With primitive_restart, all triangle primitives are emitted as strips separated by
+  // RESTART_INDEX and must be drawn as a triangle strip; otherwise they are emitted as lists.
+  static void Init(bool primitive_restart);
   static void Start(u16 *Indexptr);
 
   static void AddIndices(int primitive, u32 numVertices);
@@ -35,13 +40,18 @@ public:
   {
     return BASEIptr;
   }
+
+  static inline bool UsesPrimitiveRestart()
+  {
+    return use_primitive_restart;
+  }
 private:
   // Triangles
-  static void AddList(u32 numVerts);
-  static void AddStrip(u32 numVerts);
-  static void AddFan(u32 numVerts);
-  static void AddQuads(u32 numVerts);
-  static void AddQuads_nonstandard(u32 numVerts);
+  template <bool pr> static void AddList(u32 numVerts);
+  template <bool pr> static void AddStrip(u32 numVerts);
+  template <bool pr> static void AddFan(u32 numVerts);
+  template <bool pr> static void AddQuads(u32 numVerts);
+  template <bool pr> static void AddQuads_nonstandard(u32 numVerts);
 
   // Lines
   static void AddLineList(u32 numVerts);
@@ -50,9 +60,11 @@ private:
   // Points
   static void AddPoints(u32 numVerts);
 
+  template <bool pr>
   static u16* WriteTriangle(u16 *ptr, u32 index1, u32 index2, u32 index3);
 
   static u16 *index_buffer_current;
   static u16 *BASEIptr;
   static u32 base_index;
+  static bool use_primitive_restart;
 };
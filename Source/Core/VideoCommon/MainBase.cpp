@@ -18,6 +18,7 @@
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/TessellationShaderManager.h"
+#include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/OpcodeDecoding.h"
@@ -213,7 +214,6 @@ void VideoBackendBase::InitializeShared()
   PixelEngine::Init();
   BPInit();
   VertexLoaderManager::Init();
-  IndexGenerator::Init();
   VertexShaderManager::Init();
   GeometryShaderManager::Init();
   PixelShaderManager::Init(!(g_ActiveConfig.backend_info.APIType & API_D3D9));
@@ -236,6 +236,7 @@ void VideoBackendBase::ShutdownShared()
   m_initialized = false;
 
   Fifo::Shutdown();
+  ShutdownImageQueue();
   GeometryShaderManager::Shutdown();
   TessellationShaderManager::Shutdown();
 }
@@ -31,6 +31,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include <algorithm>
+#include <climits>
 #include <fstream>
 #include <functional>
 #include <map>
@@ -99,6 +100,18 @@ public:
     return item.info;
   }
 
+  // Like GetOrAdd, but doesn't count as a use of the object, for objects which are only loaded
+  // ahead of time. Otherwise everything in a cache would look used on every start.
+  TInfo& GetOrAddUncounted(const Tobj& obj)
+  {
+    ObjectMetadata& item = m_objects[obj];
+    if (item.category_mask.size() < m_max_category_index)
+    {
+      item.category_mask.resize(m_max_category_index);
+    }
+    return item.info;
+  }
+
   void ForEach(const std::function<void(TInfo&)>& func)
   {
     for (auto& item : m_objects)
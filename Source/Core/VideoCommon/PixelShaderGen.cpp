@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <array>
 #include <assert.h>
 #include <cmath>
 #include <cstring>
@@ -18,6 +19,7 @@
 #include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/ShaderUidCache.h"
 #include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/XFMemory.h"  // for texture projection mode
@@ -432,12 +434,61 @@ float snoise(float2 v)
 }
 )hlsl";
 
+void pixel_shader_uid_data::ClearUnused()
+{
+  pad0 = 0;
+  pad1 = 0;
+  pad2 = 0;
+  texMtxInfo_n_projection = 0;
+  uint_output = 0;
+
+  // Only checked against PASS
+  if (Pretest == AlphaTest::FAIL)
+    Pretest = AlphaTest::UNDETERMINED;
+
+  // The fog modes without a table entry are all linear
+  if (fog_fsel != 0 && fog_fsel < 4)
+    fog_fsel = 2;
+
+  // The depth is only written with per pixel depth, and otherwise z textures only feed the fog
+  if (!per_pixel_depth)
+  {
+    early_ztest = 0;
+    late_ztest = 0;
+    if (fog_fsel == 0)
+      ztex_op = ZTEXTURE_DISABLE;
+  }
+
+  for (u32 n = 0; n <= genMode_numtevstages; ++n)
+  {
+    stage_hash_data& stage = stagehash[n];
+    if (!stage.tevorders_enable && !stage.hasindstage)
+      stage.tevorders_texcoord = 0;
+    if (!stage.hasindstage)
+      continue;
+
+    TevStageIndirect tevind;
+    tevind.hex = stage.tevind;
+    tevind.lb_utclod = 0;
+    if (tevind.mid == 0)
+    {
+      tevind.bias = 0;
+      if (tevind.bs == ITBA_OFF)
+      {
+        tevind.bt = 0;
+        tevind.fmt = 0;
+      }
+    }
+    stage.tevind = tevind.hex;
+  }
+}
+
 // FIXME: Some of the video card's capabilities (BBox support, EarlyZ support, dstAlpha support)
 // leak
 //        into this UID; This is really unhelpful if these UIDs ever move from one machine to
 //        another.
-void GetPixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode, u32 components,
-                       const XFMemory& xfr, const BPMemory& bpm)
+static void CalculatePixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode,
+                                    u32 components, const XFMemory& xfr, const BPMemory& bpm)
 {
   out.ClearUID();
   pixel_shader_uid_data& uid_data = out.GetUidData<pixel_shader_uid_data>();
@@ -630,6 +681,23 @@ void GetPixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode
   out.CalculateUIDHash();
 }
 
+void GetPixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode, u32 components,
+                       const XFMemory& xfr, const BPMemory& bpm)
+{
+  // Some backends request the depth only variant next to the regular one for every draw
+  static std::array<ShaderUidCache::CachedUid<ShaderUidCache::STAGE_PIXEL, PixelShaderUid, u32, bool>,
+                    PSRM_DEPTH_ONLY + 1>
+      s_cached_uids;
+  auto& cached_uid = s_cached_uids[render_mode];
+
+  const bool bbox_active = BoundingBox::active;
+  if (cached_uid.Lookup(xfr, bpm, components, bbox_active, &out))
+    return;
+
+  CalculatePixelShaderUID(out, render_mode, components, xfr, bpm);
+  cached_uid.Store(xfr, bpm, components, bbox_active, out);
+}
+
 void SampleTexture(ShaderCode& out, API_TYPE ApiType, const char* texcoords, const char* texswap,
                    int texmap, bool stereo)
 {
@@ -642,7 +710,7 @@ void SampleTexture(ShaderCode& out, API_TYPE ApiType, const char* texcoords, con
   {
     if (stereo)
     {
-      out.Write(",min(layer, " I_TEXLAYERS "[%d].x))", texmap);
+      out.Write(",min(float(layer), " I_TEXLAYERS "[%d].x))", texmap);
     }
     else
     {
@@ -103,23 +103,20 @@ union stage_hash_data
 
 struct pixel_shader_uid_data
 {
+  // Counted from StartValue(), so that the unused stages are left out without running past the end
   u32 NumValues() const
   {
-    return sizeof(pixel_shader_uid_data) - (sizeof(stage_hash_data) * (16 - (genMode_numtevstages + 1)));
+    return sizeof(pixel_shader_uid_data) - StartValue() -
+           (sizeof(stage_hash_data) * (16 - (genMode_numtevstages + 1)));
   }
   u32 StartValue() const
   {
     return pixel_lighting ? 0 : sizeof(LightingUidData);
   }
 
-  void ClearUnused()
-  {
-    pad0 = 0;
-    pad1 = 0;
-    pad2 = 0;
-    texMtxInfo_n_projection = 0;
-    uint_output = 0;
-  }
+  // Zeroes the fields which don't change the generated code, so that all the variants of a
+  // shader share the same uid, compile and cache entry.
+  void ClearUnused();
 
   // TODO: Optimize field order for easy access!
   LightingUidData lighting;
@@ -353,6 +353,19 @@ void Renderer::DrawDebugText()
     final_yellow += "\n";
   }
 
+  if (g_ActiveConfig.bShowFPS && SConfig::GetInstance().m_DumpFrames)
+  {
+    const AVIDump::QueueStatistics dump_queue = AVIDump::GetQueueStatistics();
+    if (dump_queue.capacity)
+    {
+      final_cyan += StringFromFormat("Dump queue: %u/%u", dump_queue.depth, dump_queue.capacity);
+      if (dump_queue.dropped)
+        final_cyan += StringFromFormat(" (%" PRIu64 " dropped)", dump_queue.dropped);
+      final_cyan += "\n";
+      final_yellow += "\n";
+    }
+  }
+
   if (SConfig::GetInstance().m_ShowLag)
   {
     final_cyan += StringFromFormat("Lag: %" PRIu64 "\n", Movie::GetCurrentLagCount());
@@ -855,7 +868,7 @@ void Renderer::RunFrameDumps()
   bool frame_dump_started = false;
 
   // If Dolphin was compiled without libav, we only support dumping to images.
-#if !defined(HAVE_LIBAV) && !defined(_WIN32)
+#if !defined(HAVE_FFMPEG)
   if (dump_to_avi)
   {
     WARN_LOG(VIDEO, "AVI frame dump requested, but Dolphin was compiled without libav. "
@@ -927,11 +940,11 @@ void Renderer::RunFrameDumps()
   }
 }
 
-#if defined(HAVE_LIBAV) || defined(_WIN32)
+#if defined(HAVE_FFMPEG)
 
 bool Renderer::StartFrameDumpToAVI(const FrameDumpConfig& config)
 {
-  return AVIDump::Start(config.width, config.height);
+  return AVIDump::Start(config.width, config.height, config.bgra);
 }
 
 void Renderer::DumpFrameToAVI(const FrameDumpConfig& config)
@@ -959,7 +972,7 @@ void Renderer::StopFrameDumpToAVI()
 {
 }
 
-#endif  // defined(HAVE_LIBAV) || defined(WIN32)
+#endif  // defined(HAVE_FFMPEG)
 
 std::string Renderer::GetFrameDumpNextImageFileName() const
 {
@@ -3,10 +3,33 @@
 // Refer to the license.txt file included.
 
 #include "VideoCommon/ShaderGenCommon.h"
+
+#include <cstring>
+
 #include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
 #include "Core/ConfigManager.h"
 
+void ShaderCode::WriteV(const char* fmt, va_list arglist)
+{
+  // Most of the generator output is plain text or a handful of short arguments. Append those
+  // directly, or through a stack buffer, instead of allocating a temporary string per call.
+  if (!std::strchr(fmt, '%'))
+  {
+    m_buffer.append(fmt);
+    return;
+  }
+
+  va_list args_copy;
+  va_copy(args_copy, arglist);
+  char buffer[1024];
+  if (CharArrayFromFormatV(buffer, sizeof(buffer), fmt, arglist))
+    m_buffer.append(buffer);
+  else
+    m_buffer += StringFromFormatV(fmt, args_copy);
+  va_end(args_copy);
+}
+
 ShaderHostConfig ShaderHostConfig::GetCurrent()
 {
   ShaderHostConfig bits = {};
@@ -33,8 +56,7 @@ ShaderHostConfig ShaderHostConfig::GetCurrent()
   return bits;
 }
 
-std::string GetDiskShaderCacheFileName(API_TYPE api_type, const char* type, bool include_gameid,
-  bool include_host_config, bool uid)
+static std::string GetDiskShaderCacheBaseName(API_TYPE api_type, const char* type, bool uid)
 {
   std::string filename;
   if (uid)
@@ -71,7 +93,13 @@ std::string GetDiskShaderCacheFileName(API_TYPE api_type, const char* type, bool
 
   filename += '-';
   filename += type;
+  return filename;
+}
 
+std::string GetDiskShaderCacheFileName(API_TYPE api_type, const char* type, bool include_gameid,
+  bool include_host_config, bool uid)
+{
+  std::string filename = GetDiskShaderCacheBaseName(api_type, type, uid);
   if (include_gameid)
   {
     filename += '-';
@@ -88,3 +116,11 @@ std::string GetDiskShaderCacheFileName(API_TYPE api_type, const char* type, bool
   filename += ".cache";
   return filename;
 }
+
+std::string GetDiskShaderCacheFileName(API_TYPE api_type, const char* type,
+  const std::string& game_id, ShaderHostConfig host_config)
+{
+  return StringFromFormat("%s-%s-%05X.cache",
+    GetDiskShaderCacheBaseName(api_type, type, false).c_str(), game_id.c_str(),
+    host_config.bits);
+}
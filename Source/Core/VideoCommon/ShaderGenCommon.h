@@ -123,9 +123,10 @@ public:
   {
     va_list arglist;
     va_start(arglist, fmt);
-    m_buffer += StringFromFormatV(fmt, arglist);
+    WriteV(fmt, arglist);
     va_end(arglist);
-}
+  }
+  void WriteV(const char* fmt, va_list arglist);
   void clear()
   {
     m_buffer.clear();
@@ -182,6 +183,10 @@ union ShaderHostConfig
 std::string GetDiskShaderCacheFileName(API_TYPE api_type, const char* type, bool include_gameid,
   bool include_host_config, bool uid = false);
 
+// Same as above, for a specific game and host config instead of the running ones.
+std::string GetDiskShaderCacheFileName(API_TYPE api_type, const char* type,
+  const std::string& game_id, ShaderHostConfig host_config);
+
 inline void WriteRegister(ShaderCode& object, API_TYPE api_type, const char *prefix, const u32 num)
 {
   if (!(api_type & API_D3D9))
@@ -0,0 +1,107 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/ShaderUidCache.h"
+
+#include <array>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace ShaderUidCache
+{
+static std::array<u32, NUM_STAGES> s_generations = {{1, 1, 1, 1}};
+
+static void InvalidateStage(Stage stage)
+{
+  // 0 marks an empty cache entry
+  if (++s_generations[stage] == 0)
+    s_generations[stage] = 1;
+}
+
+void Invalidate()
+{
+  for (u32 stage = 0; stage < NUM_STAGES; ++stage)
+    InvalidateStage(static_cast<Stage>(stage));
+}
+
+// The registers read by GetPixelShaderUID and GetTessellationShaderUID. The vertex and
+// geometry shader UIDs don't depend on BP state.
+static bool IsBPRegisterInShaderUid(u32 address)
+{
+  switch (address)
+  {
+  case BPMEM_GENMODE:
+  case BPMEM_IREF:
+  case BPMEM_ZMODE:
+  case BPMEM_BLENDMODE:
+  case BPMEM_ZCOMPARE:
+  case BPMEM_FOGRANGE:
+  case BPMEM_FOGPARAM3:
+  case BPMEM_ALPHACOMPARE:
+  case BPMEM_ZTEX2:
+    return true;
+  default:
+    return (address >= BPMEM_IND_CMD && address < BPMEM_IND_CMD + 16) ||
+           (address >= BPMEM_TREF && address < BPMEM_TREF + 8) ||
+           (address >= BPMEM_TEV_COLOR_ENV && address < BPMEM_TEV_COLOR_ENV + 32) ||
+           (address >= BPMEM_TEV_KSEL && address < BPMEM_TEV_KSEL + 8);
+  }
+}
+
+void BPRegisterChanged(u32 address)
+{
+  if (!IsBPRegisterInShaderUid(address))
+    return;
+
+  InvalidateStage(STAGE_PIXEL);
+  InvalidateStage(STAGE_TESSELLATION);
+}
+
+// Matrices, lights, colors and the viewport are uniforms. Everything else in the XF register
+// range selects code paths in at least one of the generators.
+static bool IsXFRegisterInShaderUid(u32 address)
+{
+  if (address < 0x1000)
+    return false;
+
+  switch (address)
+  {
+  case XFMEM_ERROR:
+  case XFMEM_DIAG:
+  case XFMEM_STATE0:
+  case XFMEM_STATE1:
+  case XFMEM_CLOCK:
+  case XFMEM_CLIPDISABLE:
+  case XFMEM_SETGPMETRIC:
+  case XFMEM_VTXSPECS:
+  case XFMEM_SETCHAN0_AMBCOLOR:
+  case XFMEM_SETCHAN1_AMBCOLOR:
+  case XFMEM_SETCHAN0_MATCOLOR:
+  case XFMEM_SETCHAN1_MATCOLOR:
+  case XFMEM_SETMATRIXINDA:
+  case XFMEM_SETMATRIXINDB:
+    return false;
+  default:
+    // Only the projection type at the end of the projection parameters matters
+    return !(address >= XFMEM_SETVIEWPORT && address < XFMEM_SETPROJECTION + 6);
+  }
+}
+
+bool IsXFWriteRelevant(u32 address, u32 new_value)
+{
+  return IsXFRegisterInShaderUid(address) && reinterpret_cast<u32*>(&xfmem)[address] != new_value;
+}
+
+u32 GetGeneration(Stage stage)
+{
+  return s_generations[stage];
+}
+
+bool IsGlobalState(const XFMemory& xfr, const BPMemory& bpm)
+{
+  return &xfr == &xfmem && &bpm == &bpmem;
+}
+}  // namespace ShaderUidCache
@@ -0,0 +1,81 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <tuple>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/Statistics.h"
+
+struct BPMemory;
+struct XFMemory;
+
+// Shader UIDs are built from bpmem, xfmem and the active config on every flush, but most
+// register writes between two draws (textures, konst colors, matrices, scissor...) don't
+// change any of them. The register loaders tell this cache which stages were affected by a
+// write, and the UID generators keep returning their last result until that happens.
+namespace ShaderUidCache
+{
+enum Stage : u32
+{
+  STAGE_PIXEL,
+  STAGE_VERTEX,
+  STAGE_GEOMETRY,
+  STAGE_TESSELLATION,
+  NUM_STAGES
+};
+
+// Starts over, for when bpmem, xfmem or the config are replaced as a whole.
+void Invalidate();
+
+// Called after the BP register at the given address was changed.
+void BPRegisterChanged(u32 address);
+// Returns true if writing the value to the XF register changes any of the UIDs. Pending draws
+// are flushed before the registers are written, so the caller invalidates after the write.
+bool IsXFWriteRelevant(u32 address, u32 new_value);
+
+// Incremented whenever a register the stage depends on changes. Never 0.
+u32 GetGeneration(Stage stage);
+
+// Only UIDs computed from the global bpmem and xfmem are cached.
+bool IsGlobalState(const XFMemory& xfr, const BPMemory& bpm);
+
+// The UID for a stage as last computed from the global bpmem and xfmem, along with the inputs
+// to the generator that don't come from them.
+template <Stage stage, typename UidType, typename... Key>
+class CachedUid
+{
+public:
+  bool Lookup(const XFMemory& xfr, const BPMemory& bpm, const Key&... key, UidType* out) const
+  {
+    if (m_generation != GetGeneration(stage) || m_key != std::tie(key...) ||
+        !IsGlobalState(xfr, bpm))
+    {
+      return false;
+    }
+
+    *out = m_uid;
+    INCSTAT(stats.thisFrame.numShaderUidsReused);
+    return true;
+  }
+
+  void Store(const XFMemory& xfr, const BPMemory& bpm, const Key&... key, const UidType& uid)
+  {
+    INCSTAT(stats.thisFrame.numShaderUidsComputed);
+    if (!IsGlobalState(xfr, bpm))
+      return;
+
+    m_generation = GetGeneration(stage);
+    m_key = std::make_tuple(key...);
+    m_uid = uid;
+  }
+
+private:
+  u32 m_generation = 0;
+  std::tuple<Key...> m_key;
+  UidType m_uid;
+};
+}  // namespace ShaderUidCache
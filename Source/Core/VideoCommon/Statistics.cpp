@@ -55,6 +55,18 @@ std::string Statistics::ToString()
   str += StringFromFormat("dshaders created: %i\n", stats.numDomainShadersCreated);
   str += StringFromFormat("dshaders alive: %i\n", stats.numDomainShadersAlive);
   str += StringFromFormat("shaders changes: %i\n", stats.thisFrame.numShaderChanges);
+  str += StringFromFormat("shader UIDs computed: %i\n", stats.thisFrame.numShaderUidsComputed);
+  str += StringFromFormat("shader UIDs reused: %i\n", stats.thisFrame.numShaderUidsReused);
+  str += StringFromFormat("shader compiles pending: %i\n", stats.numPendingShaderCompiles);
+  str += StringFromFormat("shader compiles finished: %i\n",
+                          stats.thisFrame.numShaderCompilesFinished);
+  if (stats.thisFrame.numShaderCompilesFinished)
+  {
+    str += StringFromFormat("shader compile latency: %.1f ms avg, %.1f ms max\n",
+                            stats.thisFrame.shaderCompileLatencyTotal /
+                                stats.thisFrame.numShaderCompilesFinished,
+                            stats.thisFrame.shaderCompileLatencyMax);
+  }
   str += StringFromFormat("dlists called: %i\n", stats.thisFrame.numDListsCalled);
   str += StringFromFormat("Primitive joins: %i\n", stats.thisFrame.numPrimitiveJoins);
   str += StringFromFormat("Draw calls: %i\n", stats.thisFrame.numDrawCalls);
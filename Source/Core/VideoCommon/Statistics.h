@@ -24,6 +24,9 @@ struct Statistics
 
   int numVertexLoaders;
 
+  // Specialized shaders waiting for a background compiler thread
+  int numPendingShaderCompiles;
+
   float proj_0, proj_1, proj_2, proj_3, proj_4, proj_5;
   float gproj_0, gproj_1, gproj_2, gproj_3, gproj_4, gproj_5;
   float gproj_6, gproj_7, gproj_8, gproj_9, gproj_10, gproj_11, gproj_12, gproj_13, gproj_14, gproj_15;
@@ -44,6 +47,13 @@ struct Statistics
     int numPrims;
     int numDLPrims;
     int numShaderChanges;
+    int numShaderUidsComputed;
+    int numShaderUidsReused;
+
+    // Background shader compiles which finished, and the time from queueing to finishing them
+    int numShaderCompilesFinished;
+    float shaderCompileLatencyTotal;
+    float shaderCompileLatencyMax;
 
     int numPrimitiveJoins;
     int numDrawCalls;
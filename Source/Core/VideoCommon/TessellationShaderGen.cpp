@@ -6,6 +6,7 @@
 
 #include "VideoCommon/LightingShaderGen.h"
 #include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/ShaderUidCache.h"
 #include "VideoCommon/TessellationShaderGen.h"
 #include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VideoConfig.h"
@@ -195,8 +196,8 @@ static inline void WriteStageUID(Tessellation_shader_uid_data& uid_data, int n,
   }
 }
 
-void GetTessellationShaderUID(TessellationShaderUid& out, const XFMemory& xfr, const BPMemory& bpm,
-                              const u32 components)
+static void CalculateTessellationShaderUID(TessellationShaderUid& out, const XFMemory& xfr,
+                                           const BPMemory& bpm, const u32 components)
 {
   Tessellation_shader_uid_data& uid_data = out.GetUidData<Tessellation_shader_uid_data>();
   out.ClearUID();
@@ -259,6 +260,18 @@ void GetTessellationShaderUID(TessellationShaderUid& out, const XFMemory& xfr, c
   out.CalculateUIDHash();
 }
 
+void GetTessellationShaderUID(TessellationShaderUid& out, const XFMemory& xfr, const BPMemory& bpm,
+                              const u32 components)
+{
+  static ShaderUidCache::CachedUid<ShaderUidCache::STAGE_TESSELLATION, TessellationShaderUid, u32>
+      s_cached_uid;
+  if (s_cached_uid.Lookup(xfr, bpm, components, &out))
+    return;
+
+  CalculateTessellationShaderUID(out, xfr, bpm, components);
+  s_cached_uid.Store(xfr, bpm, components, out);
+}
+
 template <API_TYPE ApiType>
 inline void WriteFetchDisplacement(ShaderCode& out, int n,
                                    const Tessellation_shader_uid_data& uid_data)
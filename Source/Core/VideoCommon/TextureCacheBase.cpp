@@ -6,6 +6,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <xxhash.h>
 
 #include "Common/Align.h"
 #include "Common/FileUtil.h"
@@ -20,6 +21,7 @@
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/PostProcessing.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/SamplerCommon.h"
@@ -106,11 +108,19 @@ TextureCacheBase::~TextureCacheBase()
 void TextureCacheBase::OnConfigChanged(VideoConfig& config)
 {
   if (config.bHiresTextures != backup_config.hires_textures ||
-      config.bCacheHiresTextures != backup_config.cache_hires_textures)
+      config.bCacheHiresTextures != backup_config.cache_hires_textures ||
+      config.iHiresTexturesCacheSize != backup_config.hires_textures_cache_size)
   {
     HiresTexture::Update();
   }
 
+  // Make sure every dump has hit the disk once dumping is turned off
+  if ((backup_config.dump_textures && !config.bDumpTextures) ||
+      (backup_config.dump_efb_target && !config.bDumpEFBTarget))
+  {
+    FlushImageQueue();
+  }
+
   // TODO: Invalidating texcache is really stupid in some of these cases
   if (config.iSafeTextureCache_ColorSamples != backup_config.colorsamples ||
       config.bTexFmtOverlayEnable != backup_config.texfmt_overlay ||
@@ -145,12 +155,15 @@ void TextureCacheBase::SetBackupConfig(const VideoConfig& config)
   backup_config.texfmt_overlay_center = config.bTexFmtOverlayCenter;
   backup_config.hires_textures = config.bHiresTextures;
   backup_config.cache_hires_textures = config.bCacheHiresTextures;
+  backup_config.hires_textures_cache_size = config.iHiresTexturesCacheSize;
   backup_config.stereo_3d = config.iStereoMode > 0;
   backup_config.efb_mono_depth = config.bStereoEFBMonoDepth;
   backup_config.scaling_factor = config.iTexScalingFactor;
   backup_config.scaling_mode = config.iTexScalingType;
   backup_config.scaling_deposterize = config.bTexDeposterize;
   backup_config.gpu_texture_decoding = config.bEnableGPUTextureDecoding;
+  backup_config.dump_textures = config.bDumpTextures;
+  backup_config.dump_efb_target = config.bDumpEFBTarget;
 }
 
 void TextureCacheBase::Cleanup(s32 _frameCount)
@@ -481,7 +494,9 @@ void TextureCacheBase::DumpTexture(TCacheEntry* entry, std::string basename, u32
   std::string filename = szDir + "/" + basename +
                          (TexDecoder::IsCompressed(entry->GetConfig().pcformat) ? ".dds" : ".png");
 
-  if (!File::Exists(filename))
+  // Save() queues the image for writing, so the file may not exist yet when the same texture
+  // is loaded again.
+  if (ClaimImageDump(XXH64(filename.data(), filename.size(), 0)) && !File::Exists(filename))
     entry->texture->Save(filename, level);
 }
 
@@ -1609,7 +1624,11 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32
       u64 hash = entry->CalculateHash();
       entry->SetHashes(hash, hash);
 
-      if (g_ActiveConfig.bDumpEFBTarget)
+      // Games often copy the same image many times, so only the first copy is dumped. The key
+      // hashes all of the copy, as a sampled hash could match for different images. Copies which
+      // skip RAM can't be told apart without reading them back, so every one of those is dumped.
+      if (g_ActiveConfig.bDumpEFBTarget &&
+          (!copy_to_ram || ClaimImageDump(entry->CalculateHash(0))))
       {
         static int count = 0;
         entry->texture->Save(StringFromFormat("%sefb_frame_%i.png",
@@ -1781,11 +1800,16 @@ void TextureCacheBase::TCacheEntry::SetEfbCopy(u32 stride)
 }
 
 u64 TextureCacheBase::TCacheEntry::CalculateHash() const
+{
+  return CalculateHash(g_ActiveConfig.iSafeTextureCache_ColorSamples);
+}
+
+u64 TextureCacheBase::TCacheEntry::CalculateHash(u32 samples) const
 {
   u8* ptr = Memory::GetPointer(addr);
   if (memory_stride == BytesPerRow())
   {
-    return GetHash64(ptr, size_in_bytes, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+    return GetHash64(ptr, size_in_bytes, samples);
   }
   else
   {
@@ -1793,11 +1817,11 @@ u64 TextureCacheBase::TCacheEntry::CalculateHash() const
     u64 temp_hash = size_in_bytes;
 
     u32 samples_per_row = 0;
-    if (g_ActiveConfig.iSafeTextureCache_ColorSamples != 0)
+    if (samples != 0)
     {
       // Hash at least 4 samples per row to avoid hashing in a bad pattern, like just on the left
       // side of the efb copy
-      samples_per_row = std::max(g_ActiveConfig.iSafeTextureCache_ColorSamples / blocks, 4u);
+      samples_per_row = std::max(samples / blocks, 4u);
     }
 
     for (u32 i = 0; i < blocks; i++)
@@ -138,6 +138,8 @@ public:
     u32 BytesPerRow() const;
 
     u64 CalculateHash() const;
+    // Hashes every byte when samples is 0.
+    u64 CalculateHash(u32 samples) const;
     const TextureConfig GetConfig() const { return texture->GetConfig(); }
   };
 
@@ -263,12 +265,15 @@ private:
     bool texfmt_overlay_center;
     bool hires_textures;
     bool cache_hires_textures;
+    int hires_textures_cache_size;
     bool stereo_3d;
     bool efb_mono_depth;
     s32 scaling_mode;
     s32 scaling_factor;
     bool scaling_deposterize;
     bool gpu_texture_decoding;
+    bool dump_textures;
+    bool dump_efb_target;
   };
   BackupConfig backup_config = {};
   std::unique_ptr<TextureScaler> m_scaler;
@@ -63,7 +63,11 @@ PrimitiveType VertexManagerBase::GetPrimitiveType(int primitive)
   return primitive_from_gx[primitive & 7];
 }
 
-VertexManagerBase::VertexManagerBase() {}
+VertexManagerBase::VertexManagerBase()
+{
+  // Backends fill in their capabilities before creating the vertex manager.
+  IndexGenerator::Init(g_ActiveConfig.backend_info.bSupportsPrimitiveRestart);
+}
 
 VertexManagerBase::~VertexManagerBase() {}
 
@@ -73,6 +77,16 @@ inline u32 GetRemainingIndices(int prim)
 {
   OpcodeDecoder::GxDrawMode primitive = static_cast<OpcodeDecoder::GxDrawMode>(prim);
   u32 index_len = VertexManagerBase::MAXIBUFFERSIZE - IndexGenerator::GetIndexLen();
+  if (IndexGenerator::UsesPrimitiveRestart() && primitive < OpcodeDecoder::GX_DRAW_LINES)
+  {
+    // Strips take one extra index for the restart, fans at most two per vertex, and lists and
+    // quads at most four indices per three vertices.
+    if (primitive == OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP)
+      return index_len - 1;
+    if (primitive == OpcodeDecoder::GX_DRAW_TRIANGLE_FAN)
+      return index_len / 2;
+    return index_len / 4 * 3;
+  }
   if (primitive == OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP || primitive == OpcodeDecoder::GX_DRAW_TRIANGLE_FAN)
   {
     return index_len / 3 + 2;
@@ -338,9 +352,13 @@ void VertexManagerBase::DoFlush()
         m_zslope_refresh_required = false;
       }
     }
-    else if (IndexGenerator::GetIndexLen() >= 3)
+    else
     {
-      CalculateZSlope(vtx_dcl, g_vertex_manager->GetIndexBuffer() + IndexGenerator::GetIndexLen() - 3);
+      // With primitive restart, the last triangle is followed by a restart index.
+      const u32 last_triangle_end =
+          IndexGenerator::GetIndexLen() - (IndexGenerator::UsesPrimitiveRestart() ? 1 : 0);
+      if (IndexGenerator::GetIndexLen() > 0 && last_triangle_end >= 3)
+        CalculateZSlope(vtx_dcl, g_vertex_manager->GetIndexBuffer() + last_triangle_end - 3);
     }
 
     // if cull mode is CULL_ALL, ignore triangles and quads
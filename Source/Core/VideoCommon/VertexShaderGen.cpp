@@ -14,13 +14,14 @@
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/LightingShaderGen.h"
+#include "VideoCommon/ShaderUidCache.h"
 #include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VideoConfig.h"
 
 static const char* texOffsetMemberSelector[] = {"x", "y", "z", "w"};
 
-void GetVertexShaderUID(VertexShaderUid& out, u32 components, const XFMemory& xfr,
-                        const BPMemory& bpm)
+static void CalculateVertexShaderUID(VertexShaderUid& out, u32 components, const XFMemory& xfr,
+                                     const BPMemory& bpm)
 {
   out.ClearUID();
   vertex_shader_uid_data& uid_data = out.GetUidData<vertex_shader_uid_data>();
@@ -85,6 +86,17 @@ void GetVertexShaderUID(VertexShaderUid& out, u32 components, const XFMemory& xf
   out.CalculateUIDHash();
 }
 
+void GetVertexShaderUID(VertexShaderUid& out, u32 components, const XFMemory& xfr,
+                        const BPMemory& bpm)
+{
+  static ShaderUidCache::CachedUid<ShaderUidCache::STAGE_VERTEX, VertexShaderUid, u32> s_cached_uid;
+  if (s_cached_uid.Lookup(xfr, bpm, components, &out))
+    return;
+
+  CalculateVertexShaderUID(out, components, xfr, bpm);
+  s_cached_uid.Store(xfr, bpm, components, out);
+}
+
 inline void GenerateVertexShader(ShaderCode& out, API_TYPE api_type,
                                  const vertex_shader_uid_data& uid_data, bool use_integer_math,
                                  const ShaderHostConfig& hostconfig)
@@ -21,6 +21,7 @@
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/PostProcessing.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/ShaderUidCache.h"
 #include "VideoCommon/Statistics.h"
 
 alignas(256) float VertexShaderManager::vsconstants[VertexShaderManager::ConstantBufferSize];
@@ -191,6 +192,7 @@ void VertexShaderManager::Init()
   Dirty();
   m_buffer.Clear();
   memset(&xfmem, 0, sizeof(xfmem));
+  ShaderUidCache::Invalidate();
   ResetView();
 
   // TODO: should these go inside ResetView()?
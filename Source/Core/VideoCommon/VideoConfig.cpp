@@ -7,6 +7,7 @@
 
 #include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
 #include "Core/Config/GraphicsSettings.h"
 #include "Core/ConfigManager.h"
@@ -14,6 +15,7 @@
 #include "Core/Movie.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/ShaderUidCache.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -28,6 +30,7 @@ void UpdateActiveConfig()
     Movie::SetGraphicsConfig();
   std::unique_lock<std::mutex> config_lock(config_mutex);
   g_ActiveConfig = g_Config;
+  ShaderUidCache::Invalidate();
 }
 void VideoConfig::ClearFormats()
 {
@@ -101,7 +104,9 @@ void VideoConfig::Refresh()
   bHiresMaterialMapsBuild = Config::Get(Config::GFX_HIRES_MATERIAL_MAPS_BUILD);  
   bCacheHiresTextures = Config::Get(Config::GFX_CACHE_HIRES_TEXTURES);
   bWaitForCacheHiresTextures = Config::Get(Config::GFX_WAIT_CACHE_HIRES_TEXTURES);
+  iHiresTexturesCacheSize = Config::Get(Config::GFX_HIRES_TEXTURES_CACHE_SIZE);
   bDumpEFBTarget = Config::Get(Config::GFX_DUMP_EFB_TARGET);
+  iPNGCompressionLevel = MathUtil::Clamp(Config::Get(Config::GFX_PNG_COMPRESSION_LEVEL), 0, 9);
   bDumpFramesAsImages = Config::Get(Config::GFX_DUMP_FRAMES_AS_IMAGES);
   bFreeLook = Config::Get(Config::GFX_FREE_LOOK);
   bCompileShaderOnStartup = Config::Get(Config::GFX_COMPILE_SHADERS_ON_STARTUP);
@@ -110,6 +115,8 @@ void VideoConfig::Refresh()
   sDumpCodec = Config::Get(Config::GFX_DUMP_CODEC);
   sDumpPath = Config::Get(Config::GFX_DUMP_PATH);
   iBitrateKbps = Config::Get(Config::GFX_BITRATE_KBPS);
+  iFrameDumpQueueSize = std::max(Config::Get(Config::GFX_FRAME_DUMP_QUEUE_SIZE), 1);
+  bFrameDumpDropFrames = Config::Get(Config::GFX_FRAME_DUMP_DROP_FRAMES);
   bInternalResolutionFrameDumps = Config::Get(Config::GFX_INTERNAL_RESOLUTION_FRAME_DUMPS);
   bEnableGPUTextureDecoding = Config::Get(Config::GFX_ENABLE_GPU_TEXTURE_DECODING);
   bEnableComputeTextureEncoding = Config::Get(Config::GFX_ENABLE_COMPUTE_TEXTURE_ENCODING);
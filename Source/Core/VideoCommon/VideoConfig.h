@@ -174,7 +174,9 @@ struct VideoConfig final
   bool bHiresMaterialMapsBuild;
   bool bCacheHiresTextures;
   bool bWaitForCacheHiresTextures;
+  int iHiresTexturesCacheSize;
   bool bDumpEFBTarget;
+  int iPNGCompressionLevel;
   bool bDumpFramesAsImages;
   bool bUseFFV1;
   std::string sDumpCodec;
@@ -184,6 +186,10 @@ struct VideoConfig final
   bool bFreeLook;
   bool bBorderlessFullscreen;
   int iBitrateKbps;
+  // Frames buffered between the renderer and the encoder. When the queue is full the renderer
+  // waits for the encoder, or the frame is dropped if bFrameDumpDropFrames is set.
+  int iFrameDumpQueueSize;
+  bool bFrameDumpDropFrames;
   bool bCompileShaderOnStartup;
 
 
@@ -323,6 +329,7 @@ struct VideoConfig final
     bool bSupportsDynamicSamplerIndexing;  // Needed by UberShaders, so must stay in VideoCommon
     bool bSupportsUberShaders;
     bool bSupportsHighPrecisionFrameBuffer;
+    bool bSupportsPrimitiveRestart;
   } backend_info;
 
   // Utility
@@ -12,6 +12,7 @@
 #include "VideoCommon/TessellationShaderManager.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/ShaderUidCache.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -31,6 +32,8 @@ void VideoCommon_DoState(PointerWrap &p)
   p.Do(xfmem);
   p.DoMarker("XF Memory");
 
+  ShaderUidCache::Invalidate();
+
   // Texture decoder
   p.DoArray(texMem);
   p.DoMarker("texMem");
@@ -17,6 +17,7 @@
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/ShaderUidCache.h"
 
 inline void XFMemWritten(u32 transferSize, u32 baseAddress)
 {
@@ -245,8 +246,18 @@ void LoadXFReg(u32 transferSize, u32 baseAddress)
   // write to XF regs
   if (transferSize > 0)
   {
+    bool shader_uids_changed = false;
+    for (u32 i = 0; i < transferSize; ++i)
+    {
+      shader_uids_changed |= ShaderUidCache::IsXFWriteRelevant(
+          baseAddress + i, g_VideoData.Peek<u32>(i * sizeof(u32)));
+    }
+
     XFRegWritten(transferSize, baseAddress);
     OpcodeDecoder::DataReadU32xFuncs[transferSize - 1](&((u32*)&xfmem)[baseAddress]);
+
+    if (shader_uids_changed)
+      ShaderUidCache::Invalidate();
   }
 }
 
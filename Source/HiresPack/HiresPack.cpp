@@ -0,0 +1,118 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Packs a directory of custom textures into a single file that HiresTexture can memory-map.
+// Place the result next to the texture directories, named <game id>.htp.
+
+#include <OptionParser.h>
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/Host.h"
+#include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/VideoConfig.h"
+
+// Stub out the host interface, since this is just a simple cmdline tool.
+bool Host_UINeedsControllerState()
+{
+  return false;
+}
+bool Host_RendererHasFocus()
+{
+  return false;
+}
+bool Host_RendererIsFullscreen()
+{
+  return false;
+}
+void Host_Message(int)
+{
+}
+void Host_NotifyMapLoaded()
+{
+}
+void Host_RefreshDSPDebuggerWindow()
+{
+}
+void Host_RequestRenderWindowSize(int, int)
+{
+}
+void Host_UpdateDisasmDialog()
+{
+}
+void Host_UpdateMainFrame()
+{
+}
+void Host_UpdateTitle(const std::string&)
+{
+}
+void Host_ShowVideoConfig(void*, const std::string&)
+{
+}
+void Host_YieldToUI()
+{
+}
+void Host_UpdateProgressDialog(const char*, int, int)
+{
+}
+void* Host_GetRenderHandle()
+{
+  return nullptr;
+}
+
+int main(int argc, char** argv)
+{
+  optparse::OptionParser parser;
+  parser.usage("usage: %prog [options] -o <pack file> <texture directory>...");
+  parser.add_option("-o", "--output").action("store").help("Pack file to write");
+  parser.add_option("-m", "--material-maps")
+      .action("store_true")
+      .help("Include normal, emissive and enviroment maps");
+  parser.add_option("-b", "--build-material-maps")
+      .action("store_true")
+      .help("Build material maps from bump and specular maps (implies -m)");
+
+  const optparse::Values& options = parser.parse_args(argc, argv);
+  const std::vector<std::string> directories = parser.args();
+  if (!options.is_set("output") || directories.empty())
+  {
+    parser.print_help();
+    return 1;
+  }
+  for (const std::string& directory : directories)
+  {
+    if (!File::IsDirectory(directory))
+    {
+      fprintf(stderr, "%s is not a directory\n", directory.c_str());
+      return 1;
+    }
+  }
+
+  // Payloads are stored exactly as HiresTexture::Load produces them for this configuration.
+  const bool build_material_maps = options.get("build_material_maps");
+  g_Config.bHiresTextures = true;
+  g_Config.bHiresMaterialMapsBuild = build_material_maps;
+  g_Config.bHiresMaterialMaps = build_material_maps || options.get("material_maps");
+  g_Config.backend_info.bSupportsNormalMaps = true;
+  UpdateActiveConfig();
+
+  const std::string output = static_cast<const char*>(options.get("output"));
+  const bool success = HiresTexture::BuildPack(directories, output, [](size_t done, size_t total) {
+    printf("\r%zu / %zu textures", done, total);
+    fflush(stdout);
+  });
+  printf("\n");
+
+  if (!success)
+  {
+    fprintf(stderr, "Failed to write %s\n", output.c_str());
+    return 1;
+  }
+  printf("Wrote %s (%" PRIu64 " bytes)\n", output.c_str(), File::GetSize(output));
+  return 0;
+}
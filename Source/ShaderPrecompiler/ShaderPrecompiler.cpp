@@ -0,0 +1,465 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Builds the Vulkan shader caches ahead of time, so that players don't have to wait for shaders
+// to be compiled the first time they are used. The shaders are taken from the usage profiles
+// which are recorded while playing (ShadersUIDS/<game id>.vs.usage and .ps.usage).
+//
+// The cache file names contain the host config of the GPU and settings they were built for, e.g.
+// the 0C8C3 in IVK-ps-GALE01-0C8C3.cache. Pass the host configs to build for with -c. The caches
+// are only valid for builds of the same revision as this tool.
+//
+// With --benchmark, the shaders are only generated, and the speed of the generators is reported.
+// With --report-duplicates, the profiles are only read, and the tool reports how many of the
+// recorded shaders turn out to be the same shader once their unused fields are cleared.
+
+#include <OptionParser.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/LinearDiskCache.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/TaskScheduler.h"
+#include "Core/Host.h"
+#include "UICommon/UICommon.h"
+#include "VideoBackends/Vulkan/ShaderCompiler.h"
+#include "VideoBackends/Vulkan/VulkanContext.h"
+#include "VideoCommon/GeometryShaderGen.h"
+#include "VideoCommon/ObjectUsageProfiler.h"
+#include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/ShaderGenCommon.h"
+#include "VideoCommon/UberShaderPixel.h"
+#include "VideoCommon/UberShaderVertex.h"
+#include "VideoCommon/VertexShaderGen.h"
+#include "VideoCommon/VideoConfig.h"
+
+// Stub out the host interface, since this is just a simple cmdline tool.
+bool Host_UINeedsControllerState()
+{
+  return false;
+}
+bool Host_RendererHasFocus()
+{
+  return false;
+}
+bool Host_RendererIsFullscreen()
+{
+  return false;
+}
+void Host_Message(int)
+{
+}
+void Host_NotifyMapLoaded()
+{
+}
+void Host_RefreshDSPDebuggerWindow()
+{
+}
+void Host_RequestRenderWindowSize(int, int)
+{
+}
+void Host_UpdateDisasmDialog()
+{
+}
+void Host_UpdateMainFrame()
+{
+}
+void Host_UpdateTitle(const std::string&)
+{
+}
+void Host_ShowVideoConfig(void*, const std::string&)
+{
+}
+void Host_YieldToUI()
+{
+}
+void Host_UpdateProgressDialog(const char*, int, int)
+{
+}
+void* Host_GetRenderHandle()
+{
+  return nullptr;
+}
+
+namespace
+{
+using Vulkan::ShaderCompiler::SPIRVCodeVector;
+using CompileFunction = bool (*)(SPIRVCodeVector*, const char*, size_t);
+
+// Compiled shaders are appended to the cache after every batch, which bounds the memory used and
+// keeps the work done so far if the tool is interrupted.
+constexpr size_t BATCH_SIZE = 1024;
+
+// Minimum time to spend generating each stage when benchmarking
+constexpr double BENCHMARK_SECONDS = 1.0;
+
+bool PrintAlert(const char* caption, const char* text, bool, MsgType)
+{
+  fprintf(stderr, "%s: %s\n", caption, text);
+  return true;
+}
+
+// Sets up the video config so that ShaderHostConfig::GetCurrent() returns host_config. The
+// generators read some of these settings directly, so setting up the config is not optional.
+bool ApplyHostConfig(ShaderHostConfig host_config)
+{
+  Vulkan::VulkanContext::PopulateBackendInfo(&g_Config);
+  g_Config.backend_info.bSupportsDualSourceBlend = host_config.backend_dual_source_blend;
+  g_Config.backend_info.bSupportsGeometryShaders = host_config.backend_geometry_shaders;
+  g_Config.backend_info.bSupportsEarlyZ = host_config.backend_early_z;
+  g_Config.backend_info.bSupportsBBox = host_config.backend_bbox;
+  g_Config.backend_info.bSupportsGSInstancing = host_config.backend_gs_instancing;
+  g_Config.backend_info.bSupportsClipControl = host_config.backend_clip_control;
+  g_Config.backend_info.bSupportsSSAA = host_config.backend_ssaa;
+  g_Config.backend_info.bSupportsFragmentStoresAndAtomics = host_config.backend_atomics;
+  g_Config.backend_info.bSupportsDepthClamp = host_config.backend_depth_clamp;
+  g_Config.backend_info.bSupportsReversedDepthRange = host_config.backend_reversed_depth_range;
+  g_Config.backend_info.bSupportsBitfield = host_config.backend_bitfield;
+  g_Config.backend_info.bSupportsDynamicSamplerIndexing =
+      host_config.backend_dynamic_sampler_indexing;
+
+  g_Config.iMultisamples = host_config.msaa ? 4 : 1;
+  g_Config.bSSAA = host_config.ssaa;
+  g_Config.iStereoMode = host_config.stereo ? STEREO_SBS : STEREO_OFF;
+  g_Config.bWireFrame = host_config.wireframe;
+  g_Config.bFastDepthCalc = host_config.fast_depth_calc;
+  g_Config.iBBoxMode = host_config.bounding_box ? BBoxGPU : BBoxNone;
+  UpdateActiveConfig();
+
+  // Rejects unused bits and combinations which the emulator never produces (SSAA without MSAA)
+  return ShaderHostConfig::GetCurrent().bits == host_config.bits;
+}
+
+// Returns the game IDs which have a usage profile
+std::set<std::string> FindProfiledGames()
+{
+  std::set<std::string> games;
+  for (const std::string& path :
+       Common::DoFileSearch({File::GetUserPath(D_SHADERUIDCACHE_IDX)}, {".vs.usage", ".ps.usage"}))
+  {
+    std::string name;
+    SplitPath(path, nullptr, &name, nullptr);
+    // SplitPath only strips .usage
+    name = name.substr(0, name.rfind('.'));
+    if (name != "Ishiiruka")
+      games.insert(name);
+  }
+  return games;
+}
+
+// Returns the shaders used by a game, most used first, the same way ShaderCache::CompileShaders
+// picks them at startup. Profiles recorded by older builds can contain several variants of the
+// same shader, which only differ in fields that are cleared when the hash is recalculated. These
+// are only returned once; profiled receives the number of entries before that.
+template <typename Uid>
+std::vector<Uid> LoadUsedUids(const std::string& game_id, pKey_t version, const char* type,
+                              size_t* profiled = nullptr)
+{
+  using Profiler = ObjectUsageProfiler<Uid, pKey_t, bool, typename Uid::ShaderUidHasher>;
+
+  const pKey_t category = static_cast<pKey_t>(GetMurmurHash3(
+      reinterpret_cast<const u8*>(game_id.data()), static_cast<u32>(game_id.size()), 0));
+  std::unique_ptr<Profiler> profiler(
+      Profiler::Create(category, version, StringFromFormat("Ishiiruka.%s", type),
+                       StringFromFormat("%s.%s", game_id.c_str(), type)));
+
+  std::vector<Uid> uids;
+  std::unordered_set<Uid, typename Uid::ShaderUidHasher> seen;
+  size_t count = 0;
+  profiler->ForEachMostUsedByCategory(category,
+                                      [&](const Uid& uid, size_t) {
+                                        Uid item = uid;
+                                        item.ClearHASH();
+                                        item.CalculateUIDHash();
+                                        if (seen.insert(item).second)
+                                          uids.push_back(item);
+                                        count++;
+                                      },
+                                      {}, true);
+  if (profiled)
+    *profiled = count;
+  return uids;
+}
+
+template <typename Uid>
+void ReportDuplicates(const char* name, const std::string& game_id, pKey_t version,
+                      const char* type)
+{
+  size_t profiled = 0;
+  const size_t unique = LoadUsedUids<Uid>(game_id, version, type, &profiled).size();
+  if (profiled == 0)
+  {
+    printf("%s: no shaders\n", name);
+    return;
+  }
+
+  printf("%s: %zu profiled, %zu unique (%.1f%% fewer)\n", name, profiled, unique,
+         100.0 * (profiled - unique) / profiled);
+}
+
+template <typename Uid>
+std::vector<Uid> EnumerateUids(void (*enumerate)(const std::function<void(const Uid&, size_t)>&))
+{
+  std::vector<Uid> uids;
+  enumerate([&](const Uid& uid, size_t) { uids.push_back(uid); });
+  return uids;
+}
+
+template <typename Uid>
+class CachedUidReader : public LinearDiskCacheReader<Uid, u32>
+{
+public:
+  void Read(const Uid& key, const u32*, u32) override { uids.insert(key); }
+
+  std::unordered_set<Uid, typename Uid::ShaderUidHasher> uids;
+};
+
+// Compiles the shaders which aren't in the cache file yet, and appends them to it. Returns the
+// number of shaders which failed to compile.
+template <typename Uid, typename Generator>
+size_t CompileStage(const char* name, const std::string& filename, const std::vector<Uid>& uids,
+                    const Generator& generate, CompileFunction compile)
+{
+  LinearDiskCache<Uid, u32> disk_cache;
+  CachedUidReader<Uid> reader;
+  disk_cache.OpenAndRead(filename, reader);
+
+  std::vector<Uid> pending;
+  for (const Uid& uid : uids)
+  {
+    if (reader.uids.insert(uid).second)
+      pending.push_back(uid);
+  }
+
+  size_t failed = 0;
+  std::atomic<size_t> done{0};
+  std::vector<SPIRVCodeVector> spirv;
+  for (size_t batch = 0; batch < pending.size(); batch += BATCH_SIZE)
+  {
+    const size_t batch_end = std::min(pending.size(), batch + BATCH_SIZE);
+    spirv.assign(batch_end - batch, {});
+
+    Common::ParallelFor<size_t>(batch, batch_end, [&](size_t begin, size_t end) {
+      ShaderCode code;
+      for (size_t i = begin; i < end; ++i)
+      {
+        code.clear();
+        generate(code, pending[i]);
+        if (!compile(&spirv[i - batch], code.data(), code.size()))
+          spirv[i - batch].clear();
+
+        printf("\r%s: %zu / %zu", name, ++done, pending.size());
+        fflush(stdout);
+      }
+    });
+
+    for (size_t i = batch; i < batch_end; ++i)
+    {
+      const SPIRVCodeVector& code = spirv[i - batch];
+      if (code.empty())
+        failed++;
+      else
+        disk_cache.Append(pending[i], code.data(), static_cast<u32>(code.size()));
+    }
+    disk_cache.Sync();
+  }
+  disk_cache.Close();
+
+  printf("\r%s: %zu compiled, %zu already cached, %zu failed\n", name, pending.size() - failed,
+         uids.size() - pending.size(), failed);
+  return failed;
+}
+
+// Generates every shader on a single thread without compiling it, and reports how fast that is.
+template <typename Uid, typename Generator>
+void BenchmarkStage(const char* name, const std::vector<Uid>& uids, const Generator& generate)
+{
+  if (uids.empty())
+  {
+    printf("%s: no shaders\n", name);
+    return;
+  }
+
+  ShaderCode code;
+  size_t shaders = 0;
+  size_t bytes = 0;
+  const auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed;
+  do
+  {
+    for (const Uid& uid : uids)
+    {
+      code.clear();
+      generate(code, uid);
+      bytes += code.size();
+    }
+    shaders += uids.size();
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed.count() < BENCHMARK_SECONDS);
+
+  printf("%s: %zu shaders, %.0f shaders/s, %.1f MB/s\n", name, uids.size(),
+         shaders / elapsed.count(), bytes / elapsed.count() / (1024 * 1024));
+}
+
+template <typename Uid, typename Generator>
+size_t RunStage(bool benchmark, const char* name, const std::string& filename,
+                const std::vector<Uid>& uids, const Generator& generate, CompileFunction compile)
+{
+  if (!benchmark)
+    return CompileStage(name, filename, uids, generate, compile);
+
+  BenchmarkStage(name, uids, generate);
+  return 0;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  optparse::OptionParser parser;
+  parser.usage("usage: %prog [options] -c <host config>...");
+  parser.add_option("-c", "--host-config")
+      .action("append")
+      .help("Host config to build caches for, as hex digits from a shader cache file name");
+  parser.add_option("-g", "--game")
+      .action("append")
+      .help("Game ID to build caches for (default: every game with a usage profile)");
+  parser.add_option("-u", "--user").action("store").help("User folder path");
+  parser.add_option("--ubershaders").action("store_true").help("Also build the ubershader caches");
+  parser.add_option("--benchmark")
+      .action("store_true")
+      .help("Only generate the shaders and report how fast that is, nothing is written");
+  parser.add_option("--report-duplicates")
+      .action("store_true")
+      .help("Only report how many profiled shaders are variants of the same shader");
+
+  const optparse::Values& options = parser.parse_args(argc, argv);
+  const bool report_duplicates = options.get("report_duplicates");
+  if (!options.is_set("host_config") && !report_duplicates)
+  {
+    parser.print_help();
+    return 1;
+  }
+
+  RegisterMsgAlertHandler(PrintAlert);
+  const char* user_dir =
+      options.is_set("user") ? static_cast<const char*>(options.get("user")) : "";
+  UICommon::SetUserDirectory(user_dir);
+  File::CreateFullPath(File::GetUserPath(D_SHADERCACHE_IDX));
+
+  std::set<std::string> games;
+  if (options.is_set("game"))
+  {
+    for (const std::string& game : options.all("game"))
+      games.insert(game);
+  }
+  else
+  {
+    games = FindProfiledGames();
+  }
+  if (games.empty() && (!options.get("ubershaders") || report_duplicates))
+  {
+    fprintf(stderr, "No shader usage profiles found in %s\n",
+            File::GetUserPath(D_SHADERUIDCACHE_IDX).c_str());
+    return 1;
+  }
+
+  if (report_duplicates)
+  {
+    for (const std::string& game_id : games)
+    {
+      printf("%s\n", game_id.c_str());
+      ReportDuplicates<VertexShaderUid>("Vertex shaders", game_id, VERTEXSHADERGEN_UID_VERSION,
+                                        "vs");
+      ReportDuplicates<PixelShaderUid>("Pixel shaders", game_id, PIXELSHADERGEN_UID_VERSION, "ps");
+    }
+    return 0;
+  }
+
+  const bool benchmark = options.get("benchmark");
+  size_t failed = 0;
+  for (const std::string& host_config_string : options.all("host_config"))
+  {
+    char* end = nullptr;
+    ShaderHostConfig host_config;
+    host_config.bits = strtoul(host_config_string.c_str(), &end, 16);
+    if (host_config_string.empty() || *end != '\0' || !ApplyHostConfig(host_config))
+    {
+      fprintf(stderr, "%s is not a valid host config\n", host_config_string.c_str());
+      return 1;
+    }
+
+    for (const std::string& game_id : games)
+    {
+      printf("%s (%05X)\n", game_id.c_str(), host_config.bits);
+
+      failed += RunStage(
+          benchmark, "Vertex shaders",
+          GetDiskShaderCacheFileName(API_VULKAN, "vs", game_id, host_config),
+          LoadUsedUids<VertexShaderUid>(game_id, VERTEXSHADERGEN_UID_VERSION, "vs"),
+          [&](ShaderCode& code, const VertexShaderUid& uid) {
+            GenerateVertexShaderCode(code, uid.GetUidData(), host_config);
+          },
+          Vulkan::ShaderCompiler::CompileVertexShader);
+
+      failed += RunStage(
+          benchmark, "Pixel shaders",
+          GetDiskShaderCacheFileName(API_VULKAN, "ps", game_id, host_config),
+          LoadUsedUids<PixelShaderUid>(game_id, PIXELSHADERGEN_UID_VERSION, "ps"),
+          [&](ShaderCode& code, const PixelShaderUid& uid) {
+            GeneratePixelShaderCode(code, uid.GetUidData(), host_config);
+          },
+          Vulkan::ShaderCompiler::CompileFragmentShader);
+
+      if (host_config.backend_geometry_shaders)
+      {
+        failed += RunStage(
+            benchmark, "Geometry shaders",
+            GetDiskShaderCacheFileName(API_VULKAN, "gs", game_id, host_config),
+            EnumerateUids<GeometryShaderUid>(EnumerateGeometryShaderUids),
+            [&](ShaderCode& code, const GeometryShaderUid& uid) {
+              GenerateGeometryShaderCode(code, uid.GetUidData(), host_config);
+            },
+            Vulkan::ShaderCompiler::CompileGeometryShader);
+      }
+    }
+
+    if (options.get("ubershaders"))
+    {
+      printf("Ubershaders (%05X)\n", host_config.bits);
+
+      failed += RunStage(
+          benchmark, "Vertex ubershaders",
+          GetDiskShaderCacheFileName(API_VULKAN, "UVS", false, true),
+          EnumerateUids<UberShader::VertexUberShaderUid>(UberShader::EnumerateVertexUberShaderUids),
+          [&](ShaderCode& code, const UberShader::VertexUberShaderUid& uid) {
+            UberShader::GenVertexShader(code, API_VULKAN, host_config, uid.GetUidData());
+          },
+          Vulkan::ShaderCompiler::CompileVertexShader);
+
+      failed += RunStage(
+          benchmark, "Pixel ubershaders",
+          GetDiskShaderCacheFileName(API_VULKAN, "UPS", false, true),
+          EnumerateUids<UberShader::PixelUberShaderUid>(UberShader::EnumeratePixelUberShaderUids),
+          [&](ShaderCode& code, const UberShader::PixelUberShaderUid& uid) {
+            UberShader::GenPixelShader(code, API_VULKAN, host_config, uid.GetUidData());
+          },
+          Vulkan::ShaderCompiler::CompileFragmentShader);
+    }
+  }
+
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "Common/TaskScheduler.h"
+
+TEST(WorkStealingDeque, PushPopSteal)
+{
+  Common::WorkStealingDeque<u32, 8> deque;
+  u32 value;
+
+  EXPECT_TRUE(deque.Empty());
+  EXPECT_FALSE(deque.Pop(&value));
+  EXPECT_FALSE(deque.Steal(&value));
+
+  for (u32 i = 0; i < 8; ++i)
+    EXPECT_TRUE(deque.Push(i));
+  EXPECT_FALSE(deque.Push(8));
+
+  // The owner takes from the bottom, thieves from the top.
+  EXPECT_TRUE(deque.Pop(&value));
+  EXPECT_EQ(7u, value);
+  EXPECT_TRUE(deque.Steal(&value));
+  EXPECT_EQ(0u, value);
+
+  for (u32 i = 6; i >= 1; --i)
+  {
+    EXPECT_TRUE(deque.Pop(&value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_TRUE(deque.Empty());
+}
+
+TEST(WorkStealingDeque, ConcurrentSteal)
+{
+  constexpr u32 ITEMS = 100000;
+  Common::WorkStealingDeque<u32, 1024> deque;
+  std::atomic<u64> sum{0};
+  std::atomic<u32> taken{0};
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < 3; ++i)
+  {
+    thieves.emplace_back([&] {
+      u32 value;
+      while (taken.load() < ITEMS)
+      {
+        if (deque.Steal(&value))
+        {
+          sum += value;
+          ++taken;
+        }
+      }
+    });
+  }
+
+  u32 value;
+  for (u32 i = 1; i <= ITEMS; ++i)
+  {
+    while (!deque.Push(i))
+    {
+      if (deque.Pop(&value))
+      {
+        sum += value;
+        ++taken;
+      }
+    }
+  }
+  while (deque.Pop(&value))
+  {
+    sum += value;
+    ++taken;
+  }
+
+  for (std::thread& thief : thieves)
+    thief.join();
+
+  EXPECT_EQ(ITEMS, taken.load());
+  EXPECT_EQ(static_cast<u64>(ITEMS) * (ITEMS + 1) / 2, sum.load());
+}
+
+TEST(TaskScheduler, TaskGroup)
+{
+  std::atomic<u32> counter{0};
+  {
+    Common::TaskGroup group;
+    for (int i = 0; i < 1000; ++i)
+      group.Run([&counter] { ++counter; });
+    group.Wait();
+    EXPECT_EQ(1000u, counter.load());
+  }
+}
+
+TEST(TaskScheduler, NestedGroups)
+{
+  std::atomic<u32> counter{0};
+  Common::TaskGroup outer;
+  for (int i = 0; i < 16; ++i)
+  {
+    outer.Run([&counter] {
+      Common::TaskGroup inner;
+      for (int j = 0; j < 16; ++j)
+        inner.Run([&counter] { ++counter; });
+    });
+  }
+  outer.Wait();
+  EXPECT_EQ(256u, counter.load());
+}
+
+TEST(TaskScheduler, ParallelFor)
+{
+  std::vector<std::atomic<u32>> hits(10007);
+  for (auto& hit : hits)
+    hit = 0;
+
+  Common::ParallelFor<size_t>(0, hits.size(), 13, [&hits](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      ++hits[i];
+  });
+
+  for (const auto& hit : hits)
+    EXPECT_EQ(1u, hit.load());
+
+  // Empty ranges must not call the body.
+  bool called = false;
+  Common::ParallelFor(5, 5, [&called](int, int) { called = true; });
+  EXPECT_FALSE(called);
+}
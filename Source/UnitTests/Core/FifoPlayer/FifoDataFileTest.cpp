@@ -0,0 +1,127 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+
+namespace
+{
+MemoryUpdate MakeUpdate(u32 address, u32 fifo_position, std::vector<u8> data)
+{
+  MemoryUpdate update;
+  update.address = address;
+  update.fifoPosition = fifo_position;
+  update.type = MemoryUpdate::TEXTURE_MAP;
+  update.data = std::move(data);
+  return update;
+}
+
+FifoFrameInfo MakeFrame(u32 seed)
+{
+  FifoFrameInfo frame;
+  for (u32 i = 0; i < 1000 + seed; ++i)
+    frame.fifoData.push_back(static_cast<u8>(i * seed));
+  frame.fifoStart = 0x1000 * seed;
+  frame.fifoEnd = frame.fifoStart + static_cast<u32>(frame.fifoData.size());
+
+  // The same texture is used every frame, next to one which changes
+  frame.memoryUpdates.push_back(MakeUpdate(0x80000000, 0, std::vector<u8>(4096, 0x55)));
+  frame.memoryUpdates.push_back(MakeUpdate(0x80001000, 16, std::vector<u8>(512, seed)));
+  return frame;
+}
+
+void ExpectSameFrame(const FifoFrameInfo& expected, const FifoFrameInfo& actual)
+{
+  EXPECT_EQ(expected.fifoData, actual.fifoData);
+  EXPECT_EQ(expected.fifoStart, actual.fifoStart);
+  EXPECT_EQ(expected.fifoEnd, actual.fifoEnd);
+  ASSERT_EQ(expected.memoryUpdates.size(), actual.memoryUpdates.size());
+  for (size_t i = 0; i < expected.memoryUpdates.size(); ++i)
+  {
+    EXPECT_EQ(expected.memoryUpdates[i].address, actual.memoryUpdates[i].address);
+    EXPECT_EQ(expected.memoryUpdates[i].fifoPosition, actual.memoryUpdates[i].fifoPosition);
+    EXPECT_EQ(expected.memoryUpdates[i].type, actual.memoryUpdates[i].type);
+    EXPECT_EQ(expected.memoryUpdates[i].data, actual.memoryUpdates[i].data);
+  }
+}
+}  // namespace
+
+TEST(FifoDataFile, StreamedRecordingReadsBack)
+{
+  const std::string directory = File::CreateTempDir();
+  const std::string path = directory + "/stream.dff";
+  const std::string copy_path = directory + "/saved.dff";
+
+  std::vector<FifoFrameInfo> frames;
+  {
+    FifoDataFile file;
+    file.SetIsWii(true);
+    ASSERT_TRUE(file.BeginStream(path));
+    for (u32 i = 1; i <= 20; ++i)
+    {
+      frames.push_back(MakeFrame(i));
+      FifoFrameInfo frame = frames.back();
+      file.StreamFrame(std::move(frame));
+    }
+    file.GetBPMem()[0] = 0x12345678;
+    file.GetTexMem()[100] = 0xAB;
+    ASSERT_TRUE(file.EndStream());
+
+    EXPECT_EQ(20u, file.GetRecordedFrameCount());
+    EXPECT_EQ(20u * (4096 + 512), file.GetRecordedMemoryBytes());
+    EXPECT_TRUE(file.Save(copy_path));
+  }
+
+  for (const std::string& filename : {path, copy_path})
+  {
+    std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(filename, false);
+    ASSERT_NE(nullptr, loaded);
+    EXPECT_TRUE(loaded->GetIsWii());
+    EXPECT_EQ(0x12345678u, loaded->GetBPMem()[0]);
+    EXPECT_EQ(0xAB, loaded->GetTexMem()[100]);
+    ASSERT_EQ(frames.size(), loaded->GetFrameCount());
+    for (u32 i = 0; i < loaded->GetFrameCount(); ++i)
+      ExpectSameFrame(frames[i], loaded->GetFrame(i));
+  }
+
+  File::DeleteDirRecursively(directory);
+}
+
+// Emulation can stop before the last frame of a recording arrives, which leaves the stream open
+TEST(FifoDataFile, SaveEndsUnfinishedStream)
+{
+  const std::string directory = File::CreateTempDir();
+  const std::string path = directory + "/stream.dff";
+  const std::string copy_path = directory + "/saved.dff";
+
+  std::vector<FifoFrameInfo> frames;
+  {
+    FifoDataFile file;
+    ASSERT_TRUE(file.BeginStream(path));
+    for (u32 i = 1; i <= 3; ++i)
+    {
+      frames.push_back(MakeFrame(i));
+      FifoFrameInfo frame = frames.back();
+      file.StreamFrame(std::move(frame));
+    }
+
+    EXPECT_TRUE(file.Save(copy_path));
+    EXPECT_FALSE(file.IsStreaming());
+  }
+
+  std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(copy_path, false);
+  ASSERT_NE(nullptr, loaded);
+  ASSERT_EQ(frames.size(), loaded->GetFrameCount());
+  for (u32 i = 0; i < loaded->GetFrameCount(); ++i)
+    ExpectSameFrame(frames[i], loaded->GetFrame(i));
+
+  File::DeleteDirRecursively(directory);
+}
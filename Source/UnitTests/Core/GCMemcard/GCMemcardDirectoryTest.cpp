@@ -0,0 +1,122 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/GCMemcard/GCMemcard.h"
+#include "Core/HW/GCMemcard/GCMemcardDirectory.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 RUNNING_GAME_ID = 0x47414C45;  // GALE
+
+// The first save loaded from the folder is placed right after the system area
+constexpr u32 SAVE_ADDRESS = MC_FST_BLOCKS * BLOCK_SIZE;
+
+void WriteGCI(const std::string& path, u8 fill)
+{
+  DEntry header;
+  std::memcpy(header.Gamecode, "GZLE", 4);
+  std::memcpy(header.Makercode, "01", 2);
+  std::memset(header.Filename, 0, sizeof(header.Filename));
+  std::strcpy(reinterpret_cast<char*>(header.Filename), "test");
+  header.BlockCount[0] = 0;
+  header.BlockCount[1] = 1;
+
+  std::vector<u8> block(BLOCK_SIZE, fill);
+  File::IOFile file(path, "wb");
+  file.WriteBytes(&header, DENTRY_SIZE);
+  file.WriteBytes(block.data(), block.size());
+}
+
+u8 ReadFirstByteOnDisk(const std::string& path)
+{
+  u8 value = 0;
+  File::IOFile file(path, "rb");
+  file.Seek(DENTRY_SIZE, SEEK_SET);
+  file.ReadBytes(&value, 1);
+  return value;
+}
+}  // namespace
+
+class GCMemcardDirectoryTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    // Flushes are driven by the test instead of the flush thread
+    SConfig::GetInstance().bEnableMemcardSdWriting = false;
+
+    m_card_path = m_profile_path + "/Card/";
+    File::CreateFullPath(m_card_path);
+    m_gci_path = m_card_path + "01-GZLE-test.gci";
+  }
+
+  void TearDown() override
+  {
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  std::string m_profile_path;
+  std::string m_card_path;
+  std::string m_gci_path;
+};
+
+// Saves of games other than the running one are unloaded from memory after a flush. When the
+// write fails they have to stay loaded and dirty, or the changes are lost.
+TEST_F(GCMemcardDirectoryTest, FailedWriteKeepsSaveData)
+{
+  WriteGCI(m_gci_path, 0x11);
+
+  GCMemcardDirectory card(m_card_path, 0, MemCard59Mb, false, RUNNING_GAME_ID);
+  std::array<u8, BLOCK_SIZE> data;
+  ASSERT_EQ(static_cast<s32>(BLOCK_SIZE), card.Read(SAVE_ADDRESS, BLOCK_SIZE, data.data()));
+  EXPECT_EQ(0x11, data[0]);
+
+  // Blocks are erased before they are written, as on a real card
+  card.ClearBlock(SAVE_ADDRESS);
+  data.fill(0x22);
+  ASSERT_EQ(static_cast<s32>(BLOCK_SIZE), card.Write(SAVE_ADDRESS, BLOCK_SIZE, data.data()));
+
+  // Neither the update nor the full rewrite can open a directory
+  ASSERT_TRUE(File::Delete(m_gci_path));
+  ASSERT_TRUE(File::CreateDir(m_gci_path));
+  card.FlushToFile();
+  card.FlushToFile();
+
+  data.fill(0);
+  ASSERT_EQ(static_cast<s32>(BLOCK_SIZE), card.Read(SAVE_ADDRESS, BLOCK_SIZE, data.data()));
+  EXPECT_EQ(0x22, data[0]);
+  EXPECT_EQ(0x22, data[BLOCK_SIZE - 1]);
+
+  // Once the path is writable again the next flush still has the whole save
+  ASSERT_TRUE(File::DeleteDir(m_gci_path));
+  card.FlushToFile();
+  ASSERT_TRUE(File::Exists(m_gci_path));
+  EXPECT_EQ(static_cast<u64>(DENTRY_SIZE + BLOCK_SIZE), File::GetSize(m_gci_path));
+  EXPECT_EQ(0x22, ReadFirstByteOnDisk(m_gci_path));
+
+  // Now that it is on disk, the save is read back from the file
+  data.fill(0);
+  ASSERT_EQ(static_cast<s32>(BLOCK_SIZE), card.Read(SAVE_ADDRESS, BLOCK_SIZE, data.data()));
+  EXPECT_EQ(0x22, data[0]);
+}
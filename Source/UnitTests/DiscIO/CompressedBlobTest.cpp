@@ -0,0 +1,188 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+
+namespace
+{
+constexpr int BLOCK_SIZE = 0x4000;
+
+bool Progress(const std::string&, float, void*)
+{
+  return true;
+}
+
+bool Cancel(const std::string&, float percent, void*)
+{
+  return percent < 0.5f;
+}
+
+// Alternates runs of compressible and incompressible blocks, and ends with a partial block.
+std::vector<u8> MakeImage()
+{
+  std::mt19937 random(1234);
+  std::vector<u8> data(BLOCK_SIZE * 300 + 1234);
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    if ((i / BLOCK_SIZE) % 7 < 3)
+      data[i] = static_cast<u8>(random());
+    else
+      data[i] = static_cast<u8>((i / 64) & 0x0f);
+  }
+  return data;
+}
+
+void Write32(std::vector<u8>* data, size_t offset, u32 value)
+{
+  for (int i = 0; i < 4; ++i)
+    (*data)[offset + i] = static_cast<u8>(value >> (24 - i * 8));
+}
+
+// A GameCube disc which is filled with random padding, and whose file system has two files
+// and a boot DOL. The last file isn't aligned and ends in the partial cluster at the end.
+std::vector<u8> MakeGameCubeDisc()
+{
+  std::mt19937 random(4321);
+  std::vector<u8> data(0x200000 + 0x123);
+  for (u8& byte : data)
+    byte = static_cast<u8>(random());
+
+  std::copy_n("GTST01", 6, data.begin());
+  Write32(&data, 0x1c, 0xC2339F3D);
+  Write32(&data, 0x420, 0x60000);  // DOL offset
+  Write32(&data, 0x424, 0x70000);  // FST offset
+  Write32(&data, 0x428, 40);       // FST size
+  Write32(&data, 0x42c, 40);
+  Write32(&data, 0x2454, 0x100);  // Apploader size
+  Write32(&data, 0x2458, 0);      // Apploader trailer size
+
+  // DOL with a single text section
+  std::fill_n(data.begin() + 0x60000, 0x100, 0);
+  Write32(&data, 0x60000, 0x100);
+  Write32(&data, 0x60090, 0x200);
+
+  // Root directory, then files "a" and "b"
+  Write32(&data, 0x70000, 0x01000000);
+  Write32(&data, 0x70004, 0);
+  Write32(&data, 0x70008, 3);
+  Write32(&data, 0x7000c, 0x00000000);
+  Write32(&data, 0x70010, 0x100000);
+  Write32(&data, 0x70014, 0x9000);
+  Write32(&data, 0x70018, 0x00000002);
+  Write32(&data, 0x7001c, 0x1f8010);
+  Write32(&data, 0x70020, 0x8000);
+  std::copy_n("a\0b", 4, data.begin() + 0x70024);
+
+  return data;
+}
+
+std::vector<u8> ReadFile(const std::string& path)
+{
+  File::IOFile file(path, "rb");
+  std::vector<u8> data(file.GetSize());
+  file.ReadBytes(data.data(), data.size());
+  return data;
+}
+
+class CompressedBlobTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_directory = File::CreateTempDir();
+    m_image = MakeImage();
+    File::IOFile(Path("image.iso"), "wb").WriteBytes(m_image.data(), m_image.size());
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_directory); }
+
+  std::string Path(const std::string& name) const { return m_directory + DIR_SEP + name; }
+
+  std::string m_directory;
+  std::vector<u8> m_image;
+};
+}  // namespace
+
+TEST_F(CompressedBlobTest, RoundTrip)
+{
+  ASSERT_TRUE(DiscIO::CompressFileToBlob(Path("image.iso"), Path("image.gcz"), 0, BLOCK_SIZE,
+                                         Progress));
+  EXPECT_LT(File::GetSize(Path("image.gcz")), m_image.size());
+
+  ASSERT_TRUE(DiscIO::DecompressBlobToFile(Path("image.gcz"), Path("unpacked.iso"), Progress));
+  EXPECT_EQ(m_image, ReadFile(Path("unpacked.iso")));
+}
+
+TEST_F(CompressedBlobTest, RandomAccess)
+{
+  ASSERT_TRUE(DiscIO::CompressFileToBlob(Path("image.iso"), Path("image.gcz"), 0, BLOCK_SIZE,
+                                         Progress));
+
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(Path("image.gcz"));
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(DiscIO::BlobType::GCZ, reader->GetBlobType());
+  EXPECT_EQ(m_image.size(), reader->GetDataSize());
+
+  std::mt19937 random(5678);
+  for (int i = 0; i < 100; ++i)
+  {
+    const u64 offset = random() % (m_image.size() - 1);
+    const u64 size = std::min<u64>(random() % (3 * BLOCK_SIZE) + 1, m_image.size() - offset);
+    std::vector<u8> data(size);
+    ASSERT_TRUE(reader->Read(offset, size, data.data()));
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), m_image.begin() + offset));
+  }
+}
+
+TEST_F(CompressedBlobTest, CancelRemovesOutput)
+{
+  EXPECT_FALSE(DiscIO::CompressFileToBlob(Path("image.iso"), Path("image.gcz"), 0, BLOCK_SIZE,
+                                          Cancel));
+  EXPECT_FALSE(File::Exists(Path("image.gcz")));
+}
+
+TEST_F(CompressedBlobTest, ScrubGameCubeDisc)
+{
+  constexpr u64 CLUSTER_SIZE = 0x8000;
+  const std::vector<u8> disc = MakeGameCubeDisc();
+  File::IOFile(Path("disc.iso"), "wb").WriteBytes(disc.data(), disc.size());
+
+  ASSERT_TRUE(DiscIO::CompressFileToBlob(Path("disc.iso"), Path("disc.gcz"), 1, BLOCK_SIZE,
+                                         Progress));
+  EXPECT_LT(File::GetSize(Path("disc.gcz")), disc.size() / 4);
+
+  ASSERT_TRUE(DiscIO::DecompressBlobToFile(Path("disc.gcz"), Path("scrubbed.iso"), Progress));
+  const std::vector<u8> scrubbed = ReadFile(Path("scrubbed.iso"));
+  ASSERT_EQ(disc.size(), scrubbed.size());
+
+  // Header, DOL, FST and the clusters covered by the two files
+  const std::vector<u64> used_clusters = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 12, 14, 32, 33, 63, 64};
+  for (u64 offset = 0; offset < disc.size(); offset += CLUSTER_SIZE)
+  {
+    const u64 cluster = offset / CLUSTER_SIZE;
+    const auto begin = scrubbed.begin() + offset;
+    const auto end = scrubbed.begin() + std::min<u64>(offset + CLUSTER_SIZE, disc.size());
+    if (std::find(used_clusters.begin(), used_clusters.end(), cluster) != used_clusters.end())
+    {
+      EXPECT_TRUE(std::equal(begin, end, disc.begin() + offset)) << "cluster " << cluster;
+    }
+    else
+    {
+      EXPECT_TRUE(std::all_of(begin, end, [](u8 byte) { return byte == 0; }))
+          << "cluster " << cluster;
+    }
+  }
+}
@@ -0,0 +1,90 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/DirectoryBlob.h"
+
+namespace
+{
+// More files than there are cached handles, so that reads keep evicting them
+constexpr int NUM_FILES = 40;
+
+class DirectoryBlobTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_directory = File::CreateTempDir();
+
+    // Files separated by gaps that read as zeroes, followed by a buffer in memory
+    u64 offset = 0x100;
+    for (int i = 0; i < NUM_FILES; ++i)
+    {
+      std::vector<u8> data(m_random() % 0x8000 + 1);
+      for (u8& byte : data)
+        byte = static_cast<u8>(m_random());
+
+      const std::string path = m_directory + DIR_SEP + std::to_string(i);
+      File::IOFile(path, "wb").WriteBytes(data.data(), data.size());
+      m_contents.Add(offset, data.size(), path);
+
+      m_image.resize(offset);
+      m_image.insert(m_image.end(), data.begin(), data.end());
+      offset += data.size() + m_random() % 0x100;
+    }
+
+    m_buffer.resize(0x1000, 0xab);
+    m_contents.Add(offset, m_buffer);
+    m_image.resize(offset);
+    m_image.insert(m_image.end(), m_buffer.begin(), m_buffer.end());
+    m_image.resize(m_image.size() + 0x100);
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_directory); }
+
+  void CheckRead(u64 offset, u64 length)
+  {
+    std::vector<u8> buffer(length, 0xcd);
+    ASSERT_TRUE(m_contents.Read(offset, length, buffer.data()));
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), m_image.begin() + offset))
+        << "offset " << offset << " length " << length;
+  }
+
+  std::mt19937 m_random{1234};
+  std::string m_directory;
+  std::vector<u8> m_buffer;
+  std::vector<u8> m_image;
+  DiscIO::DiscContentContainer m_contents;
+};
+}  // namespace
+
+TEST_F(DirectoryBlobTest, SequentialRead)
+{
+  for (u64 offset = 0; offset < m_image.size(); offset += 0x800)
+    CheckRead(offset, std::min<u64>(0x800, m_image.size() - offset));
+}
+
+TEST_F(DirectoryBlobTest, RandomRead)
+{
+  for (int i = 0; i < 1000; ++i)
+  {
+    const u64 offset = m_random() % m_image.size();
+    CheckRead(offset, m_random() % std::min<u64>(0x20000, m_image.size() - offset + 1));
+  }
+}
+
+TEST_F(DirectoryBlobTest, ReadWholeImage)
+{
+  CheckRead(0, m_image.size());
+}
@@ -51,6 +51,13 @@ bool Host_RendererIsFullscreen()
 {
   return false;
 }
+bool Host_UINeedsControllerState()
+{
+  return false;
+}
+void Host_UpdateProgressDialog(const char*, int, int)
+{
+}
 void Host_ConnectWiimote(int, bool)
 {
 }
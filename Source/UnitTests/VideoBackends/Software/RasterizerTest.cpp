@@ -0,0 +1,162 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BPStructs.h"
+#include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace
+{
+constexpr u32 MAX_DEPTH = 0x00ffffff;
+
+struct TestTriangle
+{
+  OutputVertexData vertices[3];
+  ZMode::CompareMode func;
+  bool update;
+};
+
+class SWRasterizerTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    BPInit();
+    VertexShaderManager::Init();
+
+    bpmem.zcontrol.pixel_format = PEControl::RGB8_Z24;
+    bpmem.zcontrol.early_ztest = 1;
+    bpmem.zmode.testenable = 1;
+    bpmem.alpha_test.comp0 = AlphaTest::ALWAYS;
+    bpmem.alpha_test.comp1 = AlphaTest::ALWAYS;
+
+    // Scissor covering the whole EFB
+    bpmem.scissorOffset.x = 342 / 2;
+    bpmem.scissorOffset.y = 342 / 2;
+    bpmem.scissorTL.x = 342;
+    bpmem.scissorTL.y = 342;
+    bpmem.scissorBR.x = 342 + EFB_WIDTH - 1;
+    bpmem.scissorBR.y = 342 + EFB_HEIGHT - 1;
+
+    Rasterizer::Init();
+    Rasterizer::SetScissor();
+  }
+
+  void TearDown() override { g_ActiveConfig.bZComploc = false; }
+
+  float RandomFloat(float min, float max)
+  {
+    return std::uniform_real_distribution<float>(min, max)(m_random);
+  }
+
+  std::vector<TestTriangle> RandomTriangles(size_t count, bool flat)
+  {
+    static constexpr ZMode::CompareMode funcs[] = {
+        ZMode::NEVER,   ZMode::LESS,   ZMode::EQUAL,  ZMode::LEQUAL,
+        ZMode::GREATER, ZMode::NEQUAL, ZMode::GEQUAL, ZMode::ALWAYS,
+    };
+
+    std::vector<TestTriangle> triangles(count);
+    for (TestTriangle& triangle : triangles)
+    {
+      // Keep depth values on a coarse grid so that EQUAL and NEQUAL hit both outcomes
+      const float flat_depth = static_cast<float>((m_random() % 16) * (MAX_DEPTH / 16));
+
+      for (OutputVertexData& vertex : triangle.vertices)
+      {
+        vertex.screenPosition.x = RandomFloat(-16.0f, EFB_WIDTH + 16.0f);
+        vertex.screenPosition.y = RandomFloat(-16.0f, EFB_HEIGHT + 16.0f);
+        vertex.screenPosition.z = flat ? flat_depth : RandomFloat(0.0f, MAX_DEPTH);
+        vertex.projectedPosition.w = 1.0f;
+      }
+
+      // Only one winding is rasterized, make sure every triangle covers some pixels
+      const Vec3& a = triangle.vertices[0].screenPosition;
+      const Vec3& b = triangle.vertices[1].screenPosition;
+      const Vec3& c = triangle.vertices[2].screenPosition;
+      if ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x) > 0.0f)
+        std::swap(triangle.vertices[1], triangle.vertices[2]);
+
+      triangle.func = funcs[m_random() % 8];
+      triangle.update = m_random() % 4 != 0;
+    }
+    return triangles;
+  }
+
+  // Rasterizes the triangles on top of a cleared depth buffer and returns the resulting depth.
+  // With zcomploc disabled the depth test is done per pixel after texturing instead of early,
+  // which serves as the reference for the tile based early rejection.
+  std::vector<u32> Rasterize(std::vector<TestTriangle> triangles, bool zcomploc)
+  {
+    g_ActiveConfig.bZComploc = zcomploc;
+
+    bpmem.zmode.updateenable = 1;
+    for (u16 y = 0; y < EFB_HEIGHT; y++)
+    {
+      for (u16 x = 0; x < EFB_WIDTH; x++)
+        EfbInterface::SetDepth(x, y, MAX_DEPTH - ((x / 32) ^ (y / 32)) * 0x1000);
+    }
+
+    for (TestTriangle& triangle : triangles)
+    {
+      bpmem.zmode.func = triangle.func;
+      bpmem.zmode.updateenable = triangle.update;
+      Rasterizer::DrawTriangleFrontFace(&triangle.vertices[0], &triangle.vertices[1],
+                                        &triangle.vertices[2]);
+    }
+
+    std::vector<u32> depth;
+    depth.reserve(EFB_WIDTH * EFB_HEIGHT);
+    for (u16 y = 0; y < EFB_HEIGHT; y++)
+    {
+      for (u16 x = 0; x < EFB_WIDTH; x++)
+        depth.push_back(EfbInterface::GetDepth(x, y));
+    }
+    return depth;
+  }
+
+  std::mt19937 m_random{1234};
+};
+}  // namespace
+
+TEST_F(SWRasterizerTest, EarlyDepthMatchesPerPixelTest)
+{
+  const std::vector<TestTriangle> triangles = RandomTriangles(200, false);
+  const std::vector<u32> reference = Rasterize(triangles, false);
+  EXPECT_EQ(reference, Rasterize(triangles, true));
+}
+
+TEST_F(SWRasterizerTest, FlatEarlyDepthMatchesPerPixelTest)
+{
+  const std::vector<TestTriangle> triangles = RandomTriangles(200, true);
+  const std::vector<u32> reference = Rasterize(triangles, false);
+  EXPECT_EQ(reference, Rasterize(triangles, true));
+}
+
+TEST_F(SWRasterizerTest, OccludedTriangleLeavesDepthUntouched)
+{
+  std::vector<TestTriangle> triangles = RandomTriangles(1, true);
+  triangles[0].func = ZMode::LESS;
+  triangles[0].update = true;
+  for (OutputVertexData& vertex : triangles[0].vertices)
+    vertex.screenPosition.z = 0x1000;
+  const std::vector<u32> front = Rasterize(triangles, true);
+
+  // The same triangle further away is hidden everywhere
+  triangles.push_back(triangles[0]);
+  for (OutputVertexData& vertex : triangles[1].vertices)
+    vertex.screenPosition.z = MAX_DEPTH / 2;
+  EXPECT_EQ(front, Rasterize(triangles, true));
+}
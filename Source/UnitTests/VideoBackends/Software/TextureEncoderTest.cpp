@@ -0,0 +1,111 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Common/MsgHandler.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/TextureEncoder.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BPStructs.h"
+
+namespace
+{
+// Formats which aren't valid for the pixel format raise a panic alert in both encoders.
+bool IgnoreAlert(const char*, const char*, bool, MsgType)
+{
+  return true;
+}
+
+class SWTextureEncoderTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    RegisterMsgAlertHandler(IgnoreAlert);
+    BPInit();
+
+    // Random color and depth buffers
+    for (bool depth : {false, true})
+    {
+      u8* efb = EfbInterface::GetPixelPointer(0, 0, depth);
+      for (u32 i = 0; i < EFB_WIDTH * EFB_HEIGHT * 3; ++i)
+        efb[i] = static_cast<u8>(m_random());
+    }
+  }
+
+  void TearDown() override { RegisterMsgAlertHandler(nullptr); }
+
+  void SetRandomRectangle()
+  {
+    // Leave room for the partially covered blocks at the right and bottom edges
+    bpmem.copyTexSrcXY.x = m_random() % 300;
+    bpmem.copyTexSrcXY.y = m_random() % 100;
+    bpmem.copyTexSrcWH.x = m_random() % 256;
+    bpmem.copyTexSrcWH.y = m_random() % 200;
+
+    // Enough room for a row of RGBA8 blocks
+    bpmem.copyMipMapStrideChannels = ((bpmem.copyTexSrcWH.x >> 2) + 1) * 2;
+  }
+
+  std::vector<u8> Encode(void (*encode)(u8*))
+  {
+    const size_t rows = (bpmem.copyTexSrcWH.y >> 2) + 2;
+    std::vector<u8> dst(bpmem.copyMipMapStrideChannels * 32 * rows, 0xcd);
+    encode(dst.data());
+    return dst;
+  }
+
+  void CheckAllFormats(PEControl::PixelFormat pixel_format)
+  {
+    bpmem.zcontrol.pixel_format = pixel_format;
+    for (u32 half_scale = 0; half_scale < 2; ++half_scale)
+    {
+      for (u32 intensity_fmt = 0; intensity_fmt < 2; ++intensity_fmt)
+      {
+        for (u32 target_format = 0; target_format < 16; ++target_format)
+        {
+          bpmem.triggerEFBCopy.half_scale = half_scale;
+          bpmem.triggerEFBCopy.intensity_fmt = intensity_fmt;
+          bpmem.triggerEFBCopy.target_pixel_format = target_format;
+
+          for (int i = 0; i < 4; ++i)
+          {
+            SetRandomRectangle();
+            EXPECT_EQ(Encode(TextureEncoder::EncodeGeneric), Encode(TextureEncoder::Encode))
+                << "half_scale " << half_scale << " intensity_fmt " << intensity_fmt
+                << " target_pixel_format " << target_format;
+          }
+        }
+      }
+    }
+  }
+
+  std::mt19937 m_random{1234};
+};
+}  // namespace
+
+TEST_F(SWTextureEncoderTest, RGBA6)
+{
+  CheckAllFormats(PEControl::RGBA6_Z24);
+}
+
+TEST_F(SWTextureEncoderTest, RGB8)
+{
+  CheckAllFormats(PEControl::RGB8_Z24);
+}
+
+TEST_F(SWTextureEncoderTest, RGB565)
+{
+  CheckAllFormats(PEControl::RGB565_Z16);
+}
+
+TEST_F(SWTextureEncoderTest, Z24)
+{
+  CheckAllFormats(PEControl::Z24);
+}
@@ -0,0 +1,231 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <random>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/TransformUnit.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BPStructs.h"
+#include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace
+{
+// Highest matrix index whose 3x4 matrix still fits in the 256 entry matrix memory.
+constexpr u8 MAX_MATRIX_INDEX = 61;
+
+class SWTransformUnitTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    BPInit();
+    VertexShaderManager::Init();
+
+    for (float& value : xfmem.posMatrices)
+      value = RandomFloat(-2.0f, 2.0f);
+    for (float& value : xfmem.normalMatrices)
+      value = RandomFloat(-2.0f, 2.0f);
+    for (float& value : xfmem.postMatrices)
+      value = RandomFloat(-2.0f, 2.0f);
+
+    for (Light& light : xfmem.lights)
+    {
+      for (u8& component : light.color)
+        component = static_cast<u8>(m_random());
+      for (int i = 0; i < 3; ++i)
+      {
+        light.cosatt[i] = RandomFloat(-1.0f, 1.0f);
+        light.distatt[i] = RandomFloat(0.0f, 1.0f);
+        light.dpos[i] = RandomFloat(-10.0f, 10.0f);
+        light.ddir[i] = RandomFloat(-1.0f, 1.0f);
+      }
+    }
+    // Exercise the division by zero fallbacks.
+    std::memset(xfmem.lights[7].distatt, 0, sizeof(xfmem.lights[7].distatt));
+
+    for (float& value : xfmem.projection.rawProjection)
+      value = RandomFloat(-2.0f, 2.0f);
+    xfmem.ambColor[0] = m_random();
+    xfmem.ambColor[1] = m_random();
+    xfmem.matColor[0] = m_random();
+    xfmem.matColor[1] = m_random();
+
+    for (auto& texcoord : bpmem.texcoords)
+    {
+      texcoord.s.scale_minus_1 = m_random() & 0xff;
+      texcoord.t.scale_minus_1 = m_random() & 0xff;
+    }
+
+    for (size_t i = 0; i < m_input.size(); ++i)
+    {
+      InputVertexData& vertex = m_input[i];
+      vertex = InputVertexData{};
+      vertex.posMtx = RandomMatrixIndex();
+      for (u8& index : vertex.texMtx)
+        index = RandomMatrixIndex();
+      vertex.position = RandomVec3(-10.0f, 10.0f);
+      for (Vec3& normal : vertex.normal)
+        normal = RandomVec3(-1.0f, 1.0f);
+      for (auto& color : vertex.color)
+        for (u8& component : color)
+          component = static_cast<u8>(m_random());
+      for (auto& texcoord : vertex.texCoords)
+      {
+        texcoord[0] = RandomFloat(-4.0f, 4.0f);
+        texcoord[1] = RandomFloat(-4.0f, 4.0f);
+      }
+    }
+    // A vertex sitting on a light and one with a zero normal.
+    m_input[1].position.set(0.0f, 0.0f, 0.0f);
+    xfmem.posMatrices[m_input[1].posMtx * 4 + 3] = xfmem.lights[0].dpos[0];
+    xfmem.posMatrices[m_input[1].posMtx * 4 + 7] = xfmem.lights[0].dpos[1];
+    xfmem.posMatrices[m_input[1].posMtx * 4 + 11] = xfmem.lights[0].dpos[2];
+    m_input[2].normal[0].SetZero();
+  }
+
+  float RandomFloat(float min, float max)
+  {
+    return std::uniform_real_distribution<float>(min, max)(m_random);
+  }
+
+  Vec3 RandomVec3(float min, float max)
+  {
+    return Vec3(RandomFloat(min, max), RandomFloat(min, max), RandomFloat(min, max));
+  }
+
+  u8 RandomMatrixIndex() { return static_cast<u8>(m_random() % (MAX_MATRIX_INDEX + 1)); }
+
+  // Transforms every vertex with the scalar functions and in batches of every size, and expects
+  // identical bits.
+  void ExpectBatchesMatch(bool nbt, bool specialCase)
+  {
+    std::array<OutputVertexData, 13> expected{};
+    for (size_t i = 0; i < m_input.size(); ++i)
+    {
+      TransformUnit::TransformPosition(&m_input[i], &expected[i]);
+      TransformUnit::TransformNormal(&m_input[i], nbt, &expected[i]);
+      TransformUnit::TransformColor(&m_input[i], &expected[i]);
+      TransformUnit::TransformTexCoord(&m_input[i], &expected[i], specialCase);
+    }
+
+    for (int batch = 1; batch <= TransformUnit::VERTEX_BATCH_SIZE; ++batch)
+    {
+      std::array<OutputVertexData, 13> actual{};
+      for (size_t i = 0; i < m_input.size(); i += batch)
+      {
+        const int count = static_cast<int>(std::min<size_t>(batch, m_input.size() - i));
+        TransformUnit::TransformPositionBatch(&m_input[i], &actual[i], count);
+        TransformUnit::TransformNormalBatch(&m_input[i], nbt, &actual[i], count);
+        TransformUnit::TransformColorBatch(&m_input[i], &actual[i], count);
+        TransformUnit::TransformTexCoordBatch(&m_input[i], &actual[i], specialCase, count);
+      }
+
+      for (size_t i = 0; i < m_input.size(); ++i)
+      {
+        EXPECT_EQ(0, std::memcmp(&expected[i], &actual[i], sizeof(OutputVertexData)))
+            << "vertex " << i << " in batches of " << batch;
+      }
+    }
+  }
+
+  std::mt19937 m_random{12345};
+  // Not a multiple of the batch size, so partial batches are covered as well.
+  std::array<InputVertexData, 13> m_input;
+};
+}  // namespace
+
+TEST_F(SWTransformUnitTest, Lighting)
+{
+  xfmem.numChan.numColorChans = 2;
+  for (u32 projection : {GX_PERSPECTIVE, GX_ORTHOGRAPHIC})
+  {
+    xfmem.projection.type = projection;
+    for (u32 attnfunc = LIGHTATTN_NONE; attnfunc <= LIGHTATTN_SPOT; ++attnfunc)
+    {
+      for (u32 diffusefunc = LIGHTDIF_NONE; diffusefunc <= LIGHTDIF_CLAMP; ++diffusefunc)
+      {
+        for (LitChannel* chan : {&xfmem.color[0], &xfmem.color[1], &xfmem.alpha[0],
+                                 &xfmem.alpha[1]})
+        {
+          chan->hex = 0;
+          chan->enablelighting = 1;
+          chan->lightMask0_3 = 0xf;
+          chan->lightMask4_7 = 0xf;
+          chan->attnfunc = attnfunc;
+          chan->diffusefunc = diffusefunc;
+        }
+        xfmem.color[0].matsource = 1;
+        xfmem.alpha[1].ambsource = 1;
+        xfmem.color[1].ambsource = 1;
+
+        SCOPED_TRACE(testing::Message() << "attnfunc " << attnfunc << " diffusefunc "
+                                        << diffusefunc << " projection " << projection);
+        ExpectBatchesMatch(false, false);
+      }
+    }
+  }
+}
+
+TEST_F(SWTransformUnitTest, TexGen)
+{
+  xfmem.numChan.numColorChans = 2;
+  xfmem.numTexGen.numTexGens = 8;
+  for (bool dual_tex : {false, true})
+  {
+    xfmem.dualTexTrans.enabled = dual_tex;
+    for (u32 form = XF_TEXINPUT_AB11; form <= XF_TEXINPUT_ABC1; ++form)
+    {
+      for (u32 projection = XF_TEXPROJ_ST; projection <= XF_TEXPROJ_STQ; ++projection)
+      {
+        // Texture coordinate 7 would be read past the vertex as a three component source.
+        static const u32 source_rows[8] = {
+            XF_SRCGEOM_INROW,       XF_SRCNORMAL_INROW, XF_SRCBINORMAL_T_INROW,
+            XF_SRCBINORMAL_B_INROW, XF_SRCTEX0_INROW,   XF_SRCTEX3_INROW,
+            XF_SRCTEX5_INROW,       XF_SRCTEX6_INROW};
+        for (u32 i = 0; i < 8; ++i)
+        {
+          TexMtxInfo& info = xfmem.texMtxInfo[i];
+          info.hex = 0;
+          info.texgentype = XF_TEXGEN_REGULAR;
+          info.inputform = form;
+          info.projection = projection;
+          info.sourcerow = source_rows[i];
+          xfmem.postMtxInfo[i].hex = 0;
+          xfmem.postMtxInfo[i].index = RandomMatrixIndex();
+          xfmem.postMtxInfo[i].normalize = i & 1;
+        }
+        xfmem.texMtxInfo[5].texgentype = XF_TEXGEN_EMBOSS_MAP;
+        xfmem.texMtxInfo[5].embosssourceshift = 1;
+        xfmem.texMtxInfo[5].embosslightshift = 3;
+        xfmem.texMtxInfo[6].texgentype = XF_TEXGEN_COLOR_STRGBC0;
+        xfmem.texMtxInfo[6].sourcerow = XF_SRCCOLORS_INROW;
+        xfmem.texMtxInfo[6].inputform = XF_TEXINPUT_AB11;
+
+        SCOPED_TRACE(testing::Message() << "dual " << dual_tex << " form " << form
+                                        << " projection " << projection);
+        ExpectBatchesMatch(true, false);
+      }
+    }
+  }
+}
+
+TEST_F(SWTransformUnitTest, TexGenSpecialCase)
+{
+  xfmem.numTexGen.numTexGens = 1;
+  xfmem.texMtxInfo[0].texgentype = XF_TEXGEN_REGULAR;
+  xfmem.texMtxInfo[0].projection = XF_TEXPROJ_ST;
+  xfmem.texMtxInfo[0].sourcerow = XF_SRCTEX0_INROW;
+  for (bool dual_tex : {false, true})
+  {
+    xfmem.dualTexTrans.enabled = dual_tex;
+    ExpectBatchesMatch(false, true);
+  }
+}
@@ -0,0 +1,188 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "VideoCommon/HiresTexturePack.h"
+#include "VideoCommon/TextureDecoder.h"
+
+using HiresTexturePack::EntryKind;
+
+namespace
+{
+std::vector<u8> MakePayload(u32 seed, size_t size)
+{
+  std::vector<u8> data(size);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<u8>(seed * 31 + i);
+  return data;
+}
+
+HiresTexturePack::FileEntry MakeEntry(u32 width, u32 height, u32 levels)
+{
+  HiresTexturePack::FileEntry entry = {};
+  entry.width = width;
+  entry.height = height;
+  entry.levels = levels;
+  entry.format = PC_TEX_FMT_RGBA32;
+  return entry;
+}
+
+// Enough data for every level of an RGBA32 texture; the size of each level is padded to 4x4.
+size_t PayloadSize(u32 width, u32 height, u32 levels)
+{
+  return levels * ((width + 3) & ~3) * ((height + 3) & ~3) * 4;
+}
+}  // Anonymous namespace
+
+TEST(HiresTexturePack, RoundTrip)
+{
+  const std::string directory = File::CreateTempDir();
+  const std::string path = directory + DIR_SEP "test.htp";
+  constexpr u32 COUNT = 500;
+
+  HiresTexturePack::Writer writer;
+  ASSERT_TRUE(writer.Open(path));
+  for (u32 i = 0; i < COUNT; ++i)
+  {
+    const HiresTexturePack::FileEntry entry = MakeEntry(i % 32 + 1, i % 17 + 1, i % 7 + 1);
+    const std::vector<u8> payload =
+        MakePayload(i, PayloadSize(entry.width, entry.height, entry.levels) + i);
+    ASSERT_TRUE(writer.Add(EntryKind::Texture, StringFromFormat("tex1_%u", i), entry,
+                           payload.data(), payload.size()));
+  }
+  // Same name, different kind.
+  const std::vector<u8> env_payload = MakePayload(COUNT, PayloadSize(4, 4, 1) * 6);
+  ASSERT_TRUE(writer.Add(EntryKind::Enviroment, "tex1_0", MakeEntry(4, 4, 1), env_payload.data(),
+                         env_payload.size()));
+  ASSERT_TRUE(writer.Finish());
+
+  HiresTexturePack::Reader reader;
+  ASSERT_TRUE(reader.Open(path));
+  EXPECT_EQ(COUNT + 1, reader.GetEntryCount());
+  for (u32 i = 0; i < COUNT; ++i)
+  {
+    const HiresTexturePack::FileEntry* entry =
+        reader.Find(EntryKind::Texture, StringFromFormat("tex1_%u", i));
+    ASSERT_NE(nullptr, entry);
+    EXPECT_EQ(i % 32 + 1, entry->width);
+    EXPECT_EQ(i % 17 + 1, entry->height);
+    EXPECT_EQ(i % 7 + 1, entry->levels);
+    EXPECT_EQ(0u, entry->data_offset % HiresTexturePack::DATA_ALIGNMENT);
+
+    const std::vector<u8> payload =
+        MakePayload(i, PayloadSize(entry->width, entry->height, entry->levels) + i);
+    ASSERT_EQ(payload.size(), entry->data_size);
+    EXPECT_EQ(payload, std::vector<u8>(reader.GetData(*entry),
+                                       reader.GetData(*entry) + entry->data_size));
+  }
+
+  const HiresTexturePack::FileEntry* env_entry = reader.Find(EntryKind::Enviroment, "tex1_0");
+  ASSERT_NE(nullptr, env_entry);
+  EXPECT_EQ(env_payload.size(), env_entry->data_size);
+  EXPECT_EQ(nullptr, reader.Find(EntryKind::Enviroment, "tex1_1"));
+  EXPECT_EQ(nullptr, reader.Find(EntryKind::Texture, "tex1_"));
+  EXPECT_EQ(nullptr, reader.Find(EntryKind::Texture, StringFromFormat("tex1_%u", COUNT)));
+
+  reader.Close();
+  File::DeleteDirRecursively(directory);
+}
+
+TEST(HiresTexturePack, RejectsDamagedFiles)
+{
+  const std::string directory = File::CreateTempDir();
+  const std::string path = directory + DIR_SEP "test.htp";
+
+  HiresTexturePack::Writer writer;
+  ASSERT_TRUE(writer.Open(path));
+  const std::vector<u8> payload = MakePayload(1, PayloadSize(8, 8, 1));
+  ASSERT_TRUE(writer.Add(EntryKind::Texture, "tex1_a", MakeEntry(8, 8, 1), payload.data(),
+                         payload.size()));
+  ASSERT_TRUE(writer.Finish());
+
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(path, contents));
+
+  HiresTexturePack::Reader reader;
+  // Truncated.
+  ASSERT_TRUE(File::WriteStringToFile(contents.substr(0, contents.size() - 1), path));
+  EXPECT_FALSE(reader.Open(path));
+  // Bad magic.
+  std::string damaged = contents;
+  damaged[0] ^= 0xff;
+  ASSERT_TRUE(File::WriteStringToFile(damaged, path));
+  EXPECT_FALSE(reader.Open(path));
+  EXPECT_FALSE(reader.IsOpen());
+  // Intact again.
+  ASSERT_TRUE(File::WriteStringToFile(contents, path));
+  EXPECT_TRUE(reader.Open(path));
+  EXPECT_NE(nullptr, reader.Find(EntryKind::Texture, "tex1_a"));
+
+  reader.Close();
+  File::DeleteDirRecursively(directory);
+}
+
+// The texture cache uploads every level an entry describes, so its data has to cover them.
+TEST(HiresTexturePack, RejectsEntriesLargerThanTheirData)
+{
+  const std::string directory = File::CreateTempDir();
+  const std::string path = directory + DIR_SEP "test.htp";
+  HiresTexturePack::Reader reader;
+
+  const auto write_pack = [&path](EntryKind kind, const HiresTexturePack::FileEntry& entry,
+                                  size_t size) {
+    HiresTexturePack::Writer writer;
+    const std::vector<u8> payload = MakePayload(1, size);
+    return writer.Open(path) &&
+           writer.Add(kind, "tex1_a", entry, payload.data(), payload.size()) && writer.Finish();
+  };
+
+  HiresTexturePack::FileEntry entry = MakeEntry(64, 32, 7);
+  ASSERT_TRUE(write_pack(EntryKind::Texture, entry, PayloadSize(64, 32, 7)));
+  EXPECT_TRUE(reader.Open(path));
+  // Too short for its mip levels.
+  ASSERT_TRUE(write_pack(EntryKind::Texture, entry, PayloadSize(64, 32, 1)));
+  EXPECT_FALSE(reader.Open(path));
+
+  // Single levels from here on, so that PayloadSize() is exact.
+  const size_t size = PayloadSize(64, 32, 1);
+  entry = MakeEntry(64, 32, 1);
+  ASSERT_TRUE(write_pack(EntryKind::Texture, entry, size));
+  EXPECT_TRUE(reader.Open(path));
+  ASSERT_TRUE(write_pack(EntryKind::Texture, entry, size - 1));
+  EXPECT_FALSE(reader.Open(path));
+  // A normal map needs a second layer.
+  entry.nrm_levels = 1;
+  ASSERT_TRUE(write_pack(EntryKind::Texture, entry, size));
+  EXPECT_FALSE(reader.Open(path));
+  ASSERT_TRUE(write_pack(EntryKind::Texture, entry, size * 2));
+  EXPECT_TRUE(reader.Open(path));
+  // Material layers always have as many levels as the color layer.
+  entry.nrm_levels = 2;
+  ASSERT_TRUE(write_pack(EntryKind::Texture, entry, size * 2));
+  EXPECT_FALSE(reader.Open(path));
+  // Enviroment maps have six faces.
+  ASSERT_TRUE(write_pack(EntryKind::Enviroment, MakeEntry(64, 32, 1), size * 5));
+  EXPECT_FALSE(reader.Open(path));
+  ASSERT_TRUE(write_pack(EntryKind::Enviroment, MakeEntry(64, 32, 1), size * 6));
+  EXPECT_TRUE(reader.Open(path));
+  // Unknown format.
+  entry = MakeEntry(64, 32, 1);
+  entry.format = PC_TEX_NUM_FORMATS;
+  ASSERT_TRUE(write_pack(EntryKind::Texture, entry, size));
+  EXPECT_FALSE(reader.Open(path));
+  // Sizes of this magnitude overflow the texture size calculation.
+  ASSERT_TRUE(write_pack(EntryKind::Texture, MakeEntry(0x10000, 0x10000, 1), size));
+  EXPECT_FALSE(reader.Open(path));
+
+  reader.Close();
+  File::DeleteDirRecursively(directory);
+}
@@ -0,0 +1,174 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+
+namespace
+{
+using Triangle = std::array<u16, 3>;
+
+// Straightforward one-primitive-at-a-time expansion, matching the original generator.
+void ReferenceIndices(int primitive, u32 base, u32 count, std::vector<u16>* out)
+{
+  const u32 top = base + count;
+  switch (primitive)
+  {
+  case OpcodeDecoder::GX_DRAW_QUADS:
+  case OpcodeDecoder::GX_DRAW_QUADS_2:
+  {
+    u32 i = base + 3;
+    for (; i < top; i += 4)
+      out->insert(out->end(), {u16(i - 3), u16(i - 2), u16(i - 1), u16(i - 3), u16(i - 1), u16(i)});
+    if (i == top)
+      out->insert(out->end(), {u16(top - 3), u16(top - 2), u16(top - 1)});
+    break;
+  }
+  case OpcodeDecoder::GX_DRAW_TRIANGLES:
+    for (u32 i = base + 2; i < top; i += 3)
+      out->insert(out->end(), {u16(i - 2), u16(i - 1), u16(i)});
+    break;
+  case OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP:
+    for (u32 i = base + 2; i < top; ++i)
+    {
+      if ((i - base) & 1)
+        out->insert(out->end(), {u16(i - 2), u16(i), u16(i - 1)});
+      else
+        out->insert(out->end(), {u16(i - 2), u16(i - 1), u16(i)});
+    }
+    break;
+  case OpcodeDecoder::GX_DRAW_TRIANGLE_FAN:
+    for (u32 i = base + 2; i < top; ++i)
+      out->insert(out->end(), {u16(base), u16(i - 1), u16(i)});
+    break;
+  case OpcodeDecoder::GX_DRAW_LINES:
+    for (u32 i = base + 1; i < top; i += 2)
+      out->insert(out->end(), {u16(i - 1), u16(i)});
+    break;
+  case OpcodeDecoder::GX_DRAW_LINE_STRIP:
+    for (u32 i = base + 1; i < top; ++i)
+      out->insert(out->end(), {u16(i - 1), u16(i)});
+    break;
+  case OpcodeDecoder::GX_DRAW_POINTS:
+    for (u32 i = base; i < top; ++i)
+      out->push_back(u16(i));
+    break;
+  }
+}
+
+// Rotates a triangle so that its smallest index comes first, keeping the winding.
+Triangle Canonical(Triangle t)
+{
+  std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+  return t;
+}
+
+std::vector<Triangle> TrianglesFromList(const u16* indices, size_t count)
+{
+  std::vector<Triangle> triangles;
+  for (size_t i = 0; i + 3 <= count; i += 3)
+    triangles.push_back(Canonical({{indices[i], indices[i + 1], indices[i + 2]}}));
+  return triangles;
+}
+
+// Decodes restart-separated triangle strips the way the GPU does.
+std::vector<Triangle> TrianglesFromStrips(const u16* indices, size_t count)
+{
+  std::vector<Triangle> triangles;
+  size_t strip_start = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (indices[i] == IndexGenerator::RESTART_INDEX)
+    {
+      strip_start = i + 1;
+      continue;
+    }
+    const size_t position = i - strip_start;
+    if (position < 2)
+      continue;
+    if (position & 1)
+      triangles.push_back(Canonical({{indices[i - 1], indices[i - 2], indices[i]}}));
+    else
+      triangles.push_back(Canonical({{indices[i - 2], indices[i - 1], indices[i]}}));
+  }
+  return triangles;
+}
+
+constexpr std::array<u32, 3> BASES = {{0, 7, 65400}};
+constexpr u32 MAX_VERTICES = 100;
+}  // Anonymous namespace
+
+TEST(IndexGenerator, MatchesReference)
+{
+  IndexGenerator::Init(false);
+  std::vector<u16> buffer(65536 + MAX_VERTICES * 6);
+
+  for (int primitive = 0; primitive < 8; ++primitive)
+  {
+    for (u32 base : BASES)
+    {
+      for (u32 count = 0; count <= MAX_VERTICES; ++count)
+      {
+        // Emit some points first to move the base index.
+        IndexGenerator::Start(buffer.data());
+        IndexGenerator::AddIndices(OpcodeDecoder::GX_DRAW_POINTS, base);
+        const u32 skip = IndexGenerator::GetIndexLen();
+        IndexGenerator::AddIndices(primitive, count);
+
+        std::vector<u16> expected;
+        ReferenceIndices(primitive, base, count, &expected);
+
+        ASSERT_EQ(skip + expected.size(), IndexGenerator::GetIndexLen())
+            << "primitive " << primitive << " base " << base << " count " << count;
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), buffer.begin() + skip))
+            << "primitive " << primitive << " base " << base << " count " << count;
+        EXPECT_EQ(base + count, IndexGenerator::GetNumVerts());
+      }
+    }
+  }
+}
+
+TEST(IndexGenerator, PrimitiveRestartMatchesLists)
+{
+  std::vector<u16> lists(MAX_VERTICES * 6 + 16);
+  std::vector<u16> strips(MAX_VERTICES * 6 + 16);
+
+  for (u32 primitive = OpcodeDecoder::GX_DRAW_QUADS;
+       primitive <= OpcodeDecoder::GX_DRAW_TRIANGLE_FAN; ++primitive)
+  {
+    for (u32 count = 0; count <= MAX_VERTICES; ++count)
+    {
+      // Two primitives back to back, so the second one starts at a non-zero base.
+      IndexGenerator::Init(false);
+      IndexGenerator::Start(lists.data());
+      IndexGenerator::AddIndices(primitive, count);
+      IndexGenerator::AddIndices(primitive, count + 1);
+      const u32 list_len = IndexGenerator::GetIndexLen();
+
+      IndexGenerator::Init(true);
+      IndexGenerator::Start(strips.data());
+      IndexGenerator::AddIndices(primitive, count);
+      IndexGenerator::AddIndices(primitive, count + 1);
+      const u32 strip_len = IndexGenerator::GetIndexLen();
+
+      EXPECT_EQ(TrianglesFromList(lists.data(), list_len),
+                TrianglesFromStrips(strips.data(), strip_len))
+          << "primitive " << primitive << " count " << count;
+      // Every strip is terminated, so primitives can be appended freely.
+      if (strip_len > 0)
+      {
+        EXPECT_EQ(IndexGenerator::RESTART_INDEX, strips[strip_len - 1]);
+      }
+    }
+  }
+
+  IndexGenerator::Init(false);
+}
@@ -0,0 +1,71 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/ObjectUsageProfiler.h"
+
+namespace
+{
+using Profiler = ObjectUsageProfiler<u32, pKey_t, int, std::hash<u32>>;
+
+constexpr pKey_t VERSION = 3;
+constexpr pKey_t GAME = 0x1234;
+
+std::vector<u32> Rank(Profiler& profiler)
+{
+  std::vector<u32> ranked;
+  profiler.ForEachMostUsedByCategory(GAME, [&](const u32& obj, size_t) { ranked.push_back(obj); });
+  return ranked;
+}
+}  // namespace
+
+TEST(ObjectUsageProfiler, RankingSurvivesPersisting)
+{
+  const std::string directory = File::CreateTempDir();
+  const std::string path = directory + "/game.usage";
+  {
+    Profiler profiler(VERSION);
+    profiler.SetCategory(GAME);
+    for (u32 obj : {1, 2, 2, 3, 3, 3})
+      profiler.GetOrAdd(obj);
+
+    // Objects loaded ahead of time don't look used
+    for (u32 obj : {1, 4})
+      profiler.GetOrAddUncounted(obj);
+    profiler.PersistToFile(path);
+  }
+
+  Profiler profiler(VERSION);
+  profiler.ReadFromFile(path);
+  profiler.SetCategory(GAME);
+  EXPECT_EQ((std::vector<u32>{3, 2, 1, 4}), Rank(profiler));
+
+  File::DeleteDirRecursively(directory);
+}
+
+TEST(ObjectUsageProfiler, OtherVersionIsIgnored)
+{
+  const std::string directory = File::CreateTempDir();
+  const std::string path = directory + "/game.usage";
+  {
+    Profiler profiler(VERSION);
+    profiler.SetCategory(GAME);
+    profiler.GetOrAdd(1);
+    profiler.PersistToFile(path);
+  }
+
+  Profiler profiler(VERSION + 1);
+  profiler.ReadFromFile(path);
+  profiler.SetCategory(GAME);
+  EXPECT_TRUE(Rank(profiler).empty());
+
+  File::DeleteDirRecursively(directory);
+}
@@ -0,0 +1,146 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BPStructs.h"
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/ShaderGenCommon.h"
+#include "VideoCommon/ShaderUidCache.h"
+#include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace
+{
+constexpr u32 COMPONENTS = VB_HAS_NRM0 | VB_HAS_COL0 | VB_HAS_UV0 | VB_HAS_UV1;
+
+class PixelShaderUidTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    BPInit();
+    VertexShaderManager::Init();
+    g_ActiveConfig.backend_info.APIType = API_VULKAN;
+  }
+
+  // Fills the registers the pixel shader uid is built from with random values, leaving out the
+  // combinations which the generator asserts on.
+  void RandomizeState()
+  {
+    for (u32 i = 0; i < 16; ++i)
+    {
+      const u32 address = m_random() % 0x100;
+      if (address != BPMEM_GENMODE && address != BPMEM_BP_MASK)
+        reinterpret_cast<u32*>(&bpmem)[address] = m_random() & 0xffffff;
+    }
+    bpmem.genMode.hex = (m_random() & 0x00033c00) | (m_random() % 9) | ((m_random() % 3) << 4);
+    for (TevStageIndirect& tevind : bpmem.tevind)
+    {
+      if (tevind.mid == 4 || tevind.mid == 8)
+        tevind.mid = 0;
+    }
+
+    for (u32 i = 0; i < 2; ++i)
+    {
+      xfmem.color[i].hex = m_random();
+      xfmem.alpha[i].hex = m_random();
+      if (xfmem.color[i].diffusefunc == 3)
+        xfmem.color[i].diffusefunc = 0;
+      if (xfmem.alpha[i].diffusefunc == 3)
+        xfmem.alpha[i].diffusefunc = 0;
+    }
+    xfmem.numChan.numColorChans = m_random() % 3;
+    xfmem.numTexGen.numTexGens = bpmem.genMode.numtexgens;
+    ShaderUidCache::Invalidate();
+  }
+
+  // Changes the fields of a canonical uid which must not affect the generated code
+  pixel_shader_uid_data Scramble(pixel_shader_uid_data data)
+  {
+    if (data.Pretest == AlphaTest::UNDETERMINED && m_random() % 2)
+      data.Pretest = AlphaTest::FAIL;
+    if (data.fog_fsel != 0 && data.fog_fsel < 4)
+      data.fog_fsel = 1 + m_random() % 3;
+    if (!data.per_pixel_depth)
+    {
+      data.early_ztest = m_random() % 2;
+      data.late_ztest = m_random() % 2;
+      if (data.fog_fsel == 0)
+        data.ztex_op = m_random() % 3;
+    }
+
+    for (u32 n = 0; n <= data.genMode_numtevstages; ++n)
+    {
+      stage_hash_data& stage = data.stagehash[n];
+      if (!stage.tevorders_enable && !stage.hasindstage)
+        stage.tevorders_texcoord = m_random() % 8;
+      if (!stage.hasindstage)
+        continue;
+
+      TevStageIndirect tevind;
+      tevind.hex = stage.tevind;
+      tevind.lb_utclod = m_random() % 2;
+      if (tevind.mid == 0)
+      {
+        tevind.bias = m_random() % 8;
+        if (tevind.bs == ITBA_OFF)
+        {
+          tevind.bt = m_random() % 4;
+          tevind.fmt = m_random() % 4;
+        }
+      }
+      stage.tevind = tevind.hex;
+    }
+    return data;
+  }
+
+  static std::string Generate(const pixel_shader_uid_data& data)
+  {
+    ShaderCode code;
+    GeneratePixelShaderCode(code, data, ShaderHostConfig{});
+    return code.data();
+  }
+
+  std::mt19937 m_random{1234};
+};
+}  // namespace
+
+TEST_F(PixelShaderUidTest, DontCareFieldsAreCleared)
+{
+  for (int i = 0; i < 500; ++i)
+  {
+    RandomizeState();
+    PixelShaderUid uid;
+    GetPixelShaderUID(uid, PSRM_DEFAULT, COMPONENTS, xfmem, bpmem);
+
+    PixelShaderUid variant;
+    variant.GetUidData<pixel_shader_uid_data>() = Scramble(uid.GetUidData());
+    variant.CalculateUIDHash();
+    EXPECT_EQ(0, std::memcmp(&uid.GetUidData(), &variant.GetUidData(),
+                             sizeof(pixel_shader_uid_data)));
+    EXPECT_EQ(PixelShaderUid::ShaderUidHasher()(uid), PixelShaderUid::ShaderUidHasher()(variant));
+  }
+}
+
+TEST_F(PixelShaderUidTest, DontCareFieldsDontChangeCode)
+{
+  for (int i = 0; i < 500; ++i)
+  {
+    RandomizeState();
+    PixelShaderUid uid;
+    GetPixelShaderUID(uid, PSRM_DEFAULT, COMPONENTS, xfmem, bpmem);
+
+    // Generated straight from the scrambled data, without clearing the fields first
+    EXPECT_EQ(Generate(uid.GetUidData()), Generate(Scramble(uid.GetUidData())));
+  }
+}
@@ -0,0 +1,427 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Replays a corpus of shader uids through every shader generator, for every API and a few host
+// configs. The size of the generated source is checked against a budget, so that a generator
+// which suddenly emits much more code fails the test, and the GLSL generated for Vulkan is
+// compiled with glslang to catch invalid code.
+//
+// The generation time is only reported, since it depends on the machine running the test. Set
+// SHADERGEN_ENFORCE_TIME_BUDGET in the environment to also fail when a stage is over its budget.
+//
+// The corpus is built from random register state with a fixed seed, the same way as in
+// PixelShaderUidTest, so it is the same on every run.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Vulkan/ShaderCompiler.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BPStructs.h"
+#include "VideoCommon/GeometryShaderGen.h"
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/RenderState.h"
+#include "VideoCommon/ShaderGenCommon.h"
+#include "VideoCommon/ShaderUidCache.h"
+#include "VideoCommon/TessellationShaderGen.h"
+#include "VideoCommon/UberShaderPixel.h"
+#include "VideoCommon/UberShaderVertex.h"
+#include "VideoCommon/VertexShaderGen.h"
+#include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace
+{
+enum Stage
+{
+  STAGE_VERTEX,
+  STAGE_GEOMETRY,
+  STAGE_PIXEL,
+  STAGE_TESSELLATION,
+  STAGE_VERTEX_UBER,
+  STAGE_PIXEL_UBER,
+  STAGE_COUNT
+};
+
+struct StageBudget
+{
+  const char* name;
+  // Average time to generate one shader, in microseconds. Around ten times what a release build
+  // needs. Only enforced when SHADERGEN_ENFORCE_TIME_BUDGET is set.
+  double max_average_us;
+  // Size of the largest shader generated from the corpus, in bytes. Around 25% over what the
+  // generators currently emit.
+  size_t max_source_size;
+};
+
+constexpr std::array<StageBudget, STAGE_COUNT> BUDGETS = {{
+    {"vertex", 120.0, 13000},
+    {"geometry", 120.0, 7000},
+    {"pixel", 300.0, 26000},
+    {"tessellation", 80.0, 14000},
+    {"vertex ubershader", 250.0, 19500},
+    {"pixel ubershader", 300.0, 37000},
+}};
+
+#ifdef _DEBUG
+constexpr double TIME_BUDGET_SCALE = 10.0;
+#else
+constexpr double TIME_BUDGET_SCALE = 1.0;
+#endif
+
+constexpr u32 CORPUS_SIZE = 256;
+
+// Only this many entries of the corpus are compiled with glslang, which is much slower than
+// generating the code.
+constexpr u32 VALIDATED_CORPUS_SIZE = 64;
+
+constexpr std::array<u32, 4> COMPONENTS = {{
+    VB_HAS_COL0 | VB_HAS_UV0,
+    VB_HAS_NRM0 | VB_HAS_COL0 | VB_HAS_UV0 | VB_HAS_UV1,
+    VB_HAS_TEXMTXIDX0 | VB_HAS_NRM0 | VB_HAS_NRM1 | VB_HAS_NRM2 | VB_HAS_COL0 | VB_HAS_COL1 |
+        VB_HAS_UV0 | VB_HAS_UV1 | VB_HAS_UV2 | VB_HAS_UV3,
+    VB_HAS_NRM0 | VB_HAS_UV0 | VB_HAS_UV1 | VB_HAS_UV2 | VB_HAS_UV3 | VB_HAS_UV4 | VB_HAS_UV5 |
+        VB_HAS_UV6 | VB_HAS_UV7,
+}};
+
+using VertexUberShaderUidData = UberShader::vertex_ubershader_uid_data;
+using PixelUberShaderUidData = UberShader::pixel_ubershader_uid_data;
+
+struct Corpus
+{
+  std::vector<vertex_shader_uid_data> vertex;
+  std::vector<geometry_shader_uid_data> geometry;
+  std::vector<pixel_shader_uid_data> pixel;
+  std::vector<Tessellation_shader_uid_data> tessellation;
+  std::vector<VertexUberShaderUidData> vertex_uber;
+  std::vector<PixelUberShaderUidData> pixel_uber;
+};
+
+struct HostConfigCase
+{
+  const char* name;
+  ShaderHostConfig config;
+};
+
+std::vector<HostConfigCase> GetHostConfigs()
+{
+  ShaderHostConfig minimal = {};
+
+  ShaderHostConfig desktop = {};
+  desktop.backend_dual_source_blend = true;
+  desktop.backend_geometry_shaders = true;
+  desktop.backend_early_z = true;
+  desktop.backend_bbox = true;
+  desktop.backend_gs_instancing = true;
+  desktop.backend_clip_control = true;
+  desktop.backend_ssaa = true;
+  desktop.backend_atomics = true;
+  desktop.backend_depth_clamp = true;
+  desktop.backend_bitfield = true;
+  desktop.backend_dynamic_sampler_indexing = true;
+
+  ShaderHostConfig enhanced = desktop;
+  enhanced.msaa = true;
+  enhanced.ssaa = true;
+  enhanced.stereo = true;
+  enhanced.bounding_box = true;
+  enhanced.fast_depth_calc = true;
+
+  ShaderHostConfig wireframe = desktop;
+  wireframe.wireframe = true;
+  wireframe.backend_gs_instancing = false;
+  wireframe.backend_reversed_depth_range = true;
+
+  return {{"minimal", minimal},
+          {"desktop", desktop},
+          {"enhanced", enhanced},
+          {"wireframe", wireframe}};
+}
+
+class ShaderGenTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_saved_config = g_ActiveConfig;
+    BPInit();
+    VertexShaderManager::Init();
+    g_ActiveConfig.backend_info.APIType = API_VULKAN;
+    g_ActiveConfig.backend_info.bSupportsPixelLighting = true;
+    g_ActiveConfig.backend_info.bSupportsNormalMaps = true;
+    BuildCorpus();
+  }
+
+  void TearDown() override
+  {
+    g_ActiveConfig = m_saved_config;
+    ShaderUidCache::Invalidate();
+  }
+
+  // Fills the registers the uids are built from with random values, leaving out the combinations
+  // which the generators assert on.
+  void RandomizeState()
+  {
+    for (u32 i = 0; i < 16; ++i)
+    {
+      const u32 address = m_random() % 0x100;
+      if (address != BPMEM_GENMODE && address != BPMEM_BP_MASK)
+        reinterpret_cast<u32*>(&bpmem)[address] = m_random() & 0xffffff;
+    }
+    bpmem.genMode.hex = (m_random() & 0x00033c00) | (m_random() % 9) | ((m_random() % 3) << 4);
+    for (TevStageIndirect& tevind : bpmem.tevind)
+    {
+      if (tevind.mid == 4 || tevind.mid == 8)
+        tevind.mid = 0;
+    }
+
+    for (u32 i = 0; i < 2; ++i)
+    {
+      xfmem.color[i].hex = m_random();
+      xfmem.alpha[i].hex = m_random();
+      if (xfmem.color[i].diffusefunc == 3)
+        xfmem.color[i].diffusefunc = 0;
+      if (xfmem.alpha[i].diffusefunc == 3)
+        xfmem.alpha[i].diffusefunc = 0;
+    }
+    xfmem.numChan.numColorChans = m_random() % 3;
+    xfmem.numTexGen.numTexGens = bpmem.genMode.numtexgens;
+    for (u32 i = 0; i < 8; ++i)
+    {
+      // Emboss mapping offsets a texture coordinate which has already been generated
+      TexMtxInfo& texmtxinfo = xfmem.texMtxInfo[i];
+      texmtxinfo.hex = m_random();
+      if (texmtxinfo.texgentype == XF_TEXGEN_EMBOSS_MAP && i == 0)
+        texmtxinfo.texgentype = XF_TEXGEN_REGULAR;
+      else if (texmtxinfo.texgentype == XF_TEXGEN_EMBOSS_MAP)
+        texmtxinfo.embosssourceshift = m_random() % i;
+    }
+    for (PostMtxInfo& postmtxinfo : xfmem.postMtxInfo)
+      postmtxinfo.hex = m_random();
+    xfmem.projection.type = m_random() % 2;
+    ShaderUidCache::Invalidate();
+  }
+
+  void BuildCorpus()
+  {
+    for (u32 i = 0; i < CORPUS_SIZE; ++i)
+    {
+      // Half of the corpus is captured with per-pixel lighting, which changes most generators
+      g_ActiveConfig.bEnablePixelLighting = (i % 2) != 0;
+      RandomizeState();
+      const u32 components = COMPONENTS[(i / 2) % COMPONENTS.size()];
+
+      VertexShaderUid vuid;
+      GetVertexShaderUID(vuid, components, xfmem, bpmem);
+      m_corpus.vertex.push_back(vuid.GetUidData());
+
+      // Triangle strips are drawn as triangles
+      GeometryShaderUid guid;
+      GetGeometryShaderUid(guid, static_cast<PrimitiveType>(i % 3), xfmem, components);
+      m_corpus.geometry.push_back(guid.GetUidData());
+
+      // PSRM_DEPTH_ONLY is left out, only the D3D9 backend uses it
+      PixelShaderUid puid;
+      GetPixelShaderUID(puid, static_cast<PIXEL_SHADER_RENDER_MODE>((i / 8) % 3), components,
+                        xfmem, bpmem);
+      m_corpus.pixel.push_back(puid.GetUidData());
+
+      TessellationShaderUid tuid;
+      GetTessellationShaderUID(tuid, xfmem, bpmem, components);
+      m_corpus.tessellation.push_back(tuid.GetUidData());
+
+      m_corpus.vertex_uber.push_back(
+          UberShader::GetVertexUberShaderUid(components, xfmem).GetUidData());
+      m_corpus.pixel_uber.push_back(
+          UberShader::GetPixelUberShaderUid(components, xfmem, bpmem).GetUidData());
+    }
+    g_ActiveConfig.bEnablePixelLighting = false;
+  }
+
+  // The generators look at the active config in places, besides the host config they are given
+  static void ApplyConfig(API_TYPE api_type, const ShaderHostConfig& host_config)
+  {
+    g_ActiveConfig.backend_info.APIType = api_type;
+    g_ActiveConfig.backend_info.bSupportsBindingLayout = api_type == API_VULKAN;
+    g_ActiveConfig.backend_info.bSupportsGSInstancing = host_config.backend_gs_instancing;
+    g_ActiveConfig.backend_info.bSupportsDepthClamp = host_config.backend_depth_clamp;
+    g_ActiveConfig.iMultisamples = host_config.msaa ? 4 : 1;
+    g_ActiveConfig.bSSAA = host_config.ssaa;
+    g_ActiveConfig.iStereoMode = host_config.stereo ? STEREO_SBS : STEREO_OFF;
+    g_ActiveConfig.bWireFrame = host_config.wireframe;
+    g_ActiveConfig.bFastDepthCalc = host_config.fast_depth_calc;
+  }
+
+  // Generates code for every uid in the corpus, checking the size of each shader and adding the
+  // time taken to the totals of the stage.
+  template <typename UidData, typename Generator>
+  void GenerateAll(Stage stage, const std::vector<UidData>& uids, const Generator& generate,
+                   API_TYPE api_type, const char* host_config)
+  {
+    size_t max_size = 0;
+    ShaderCode code;
+    const auto start = std::chrono::steady_clock::now();
+    for (const UidData& uid_data : uids)
+    {
+      code.clear();
+      generate(code, uid_data);
+      max_size = std::max(max_size, static_cast<size_t>(code.size()));
+    }
+    const auto end = std::chrono::steady_clock::now();
+    m_seconds[stage] += std::chrono::duration<double>(end - start).count();
+    m_shader_count[stage] += uids.size();
+    m_max_size[stage] = std::max(m_max_size[stage], max_size);
+
+    EXPECT_GT(max_size, 0u) << BUDGETS[stage].name << " api " << api_type << " " << host_config;
+    EXPECT_LE(max_size, BUDGETS[stage].max_source_size)
+        << BUDGETS[stage].name << " api " << api_type << " " << host_config;
+  }
+
+  VideoConfig m_saved_config;
+  std::mt19937 m_random{5678};
+  Corpus m_corpus;
+  std::array<double, STAGE_COUNT> m_seconds{};
+  std::array<size_t, STAGE_COUNT> m_shader_count{};
+  std::array<size_t, STAGE_COUNT> m_max_size{};
+};
+
+template <typename Compile>
+void ExpectCompiles(const char* name, const ShaderCode& code, const Compile& compile)
+{
+  const std::string source = code.data();
+  Vulkan::ShaderCompiler::SPIRVCodeVector spirv;
+  EXPECT_TRUE(compile(&spirv, source.c_str(), source.size()))
+      << name << " shader failed to compile:\n"
+      << source;
+  EXPECT_FALSE(spirv.empty()) << name;
+}
+}  // namespace
+
+TEST_F(ShaderGenTest, GenerationStaysWithinBudget)
+{
+  const std::array<API_TYPE, 4> api_types = {{API_OPENGL, API_VULKAN, API_D3D11, API_D3D9_SM30}};
+  for (const HostConfigCase& host : GetHostConfigs())
+  {
+    for (API_TYPE api_type : api_types)
+    {
+      ApplyConfig(api_type, host.config);
+      const ShaderHostConfig& hc = host.config;
+
+      GenerateAll(STAGE_VERTEX, m_corpus.vertex,
+                  [&](ShaderCode& code, const vertex_shader_uid_data& uid_data) {
+                    GenerateVertexShaderCode(code, uid_data, hc);
+                  },
+                  api_type, host.name);
+      GenerateAll(STAGE_PIXEL, m_corpus.pixel,
+                  [&](ShaderCode& code, const pixel_shader_uid_data& uid_data) {
+                    GeneratePixelShaderCode(code, uid_data, hc);
+                  },
+                  api_type, host.name);
+
+      // D3D9 has no geometry or tessellation shaders, and no ubershaders
+      if (api_type == API_D3D9_SM30)
+        continue;
+
+      GenerateAll(STAGE_GEOMETRY, m_corpus.geometry,
+                  [&](ShaderCode& code, const geometry_shader_uid_data& uid_data) {
+                    GenerateGeometryShaderCode(code, uid_data, hc);
+                  },
+                  api_type, host.name);
+      // The tessellation generator only emits GLSL for OpenGL, and HLSL otherwise
+      if (api_type != API_VULKAN)
+      {
+        GenerateAll(STAGE_TESSELLATION, m_corpus.tessellation,
+                    [&](ShaderCode& code, const Tessellation_shader_uid_data& uid_data) {
+                      GenerateTessellationShaderCode(code, api_type, uid_data);
+                    },
+                    api_type, host.name);
+      }
+      GenerateAll(STAGE_VERTEX_UBER, m_corpus.vertex_uber,
+                  [&](ShaderCode& code, const VertexUberShaderUidData& uid_data) {
+                    UberShader::GenVertexShader(code, api_type, hc, uid_data);
+                  },
+                  api_type, host.name);
+      GenerateAll(STAGE_PIXEL_UBER, m_corpus.pixel_uber,
+                  [&](ShaderCode& code, const PixelUberShaderUidData& uid_data) {
+                    UberShader::GenPixelShader(code, api_type, hc, uid_data);
+                  },
+                  api_type, host.name);
+    }
+  }
+
+  const bool enforce_time_budget = std::getenv("SHADERGEN_ENFORCE_TIME_BUDGET") != nullptr;
+  for (u32 stage = 0; stage < STAGE_COUNT; ++stage)
+  {
+    const StageBudget& budget = BUDGETS[stage];
+    ASSERT_GT(m_shader_count[stage], 0u) << budget.name;
+    const double average_us = m_seconds[stage] * 1000000.0 / m_shader_count[stage];
+    const double max_average_us = budget.max_average_us * TIME_BUDGET_SCALE;
+    std::printf("%-18s %6zu shaders, %8.1f us average%s, largest %zu bytes\n", budget.name,
+                m_shader_count[stage], average_us,
+                average_us > max_average_us ? " (over budget)" : "", m_max_size[stage]);
+    if (enforce_time_budget)
+    {
+      EXPECT_LE(average_us, max_average_us) << budget.name;
+    }
+  }
+}
+
+TEST_F(ShaderGenTest, VulkanOutputCompiles)
+{
+  using namespace Vulkan::ShaderCompiler;
+
+  for (const HostConfigCase& host : GetHostConfigs())
+  {
+    ApplyConfig(API_VULKAN, host.config);
+    const ShaderHostConfig& hc = host.config;
+    ShaderCode code;
+
+    for (u32 i = 0; i < VALIDATED_CORPUS_SIZE; ++i)
+    {
+      SCOPED_TRACE(testing::Message() << host.name << " corpus entry " << i);
+
+      code.clear();
+      GenerateVertexShaderCode(code, m_corpus.vertex[i], hc);
+      ExpectCompiles("vertex", code, CompileVertexShader);
+
+      code.clear();
+      GeneratePixelShaderCode(code, m_corpus.pixel[i], hc);
+      ExpectCompiles("pixel", code, CompileFragmentShader);
+
+      // The backend only uses geometry shaders when it supports them
+      if (hc.backend_geometry_shaders)
+      {
+        code.clear();
+        GenerateGeometryShaderCode(code, m_corpus.geometry[i], hc);
+        ExpectCompiles("geometry", code, CompileGeometryShader);
+      }
+    }
+
+    // There are far fewer ubershaders, so a handful covers most of them
+    for (u32 i = 0; i < 8; ++i)
+    {
+      SCOPED_TRACE(testing::Message() << host.name << " corpus entry " << i);
+
+      code.clear();
+      UberShader::GenVertexShader(code, API_VULKAN, hc, m_corpus.vertex_uber[i]);
+      ExpectCompiles("vertex ubershader", code, CompileVertexShader);
+
+      code.clear();
+      UberShader::GenPixelShader(code, API_VULKAN, hc, m_corpus.pixel_uber[i]);
+      ExpectCompiles("pixel ubershader", code, CompileFragmentShader);
+    }
+  }
+}
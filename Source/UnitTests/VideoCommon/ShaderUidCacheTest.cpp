@@ -0,0 +1,155 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <random>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BPStructs.h"
+#include "VideoCommon/GeometryShaderGen.h"
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/ShaderUidCache.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/TessellationShaderGen.h"
+#include "VideoCommon/VertexShaderGen.h"
+#include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace
+{
+constexpr u32 COMPONENTS = VB_HAS_NRM0 | VB_HAS_COL0 | VB_HAS_UV0 | VB_HAS_UV1;
+
+// ShaderUid::operator== compares past the end of the data when the lighting data is skipped
+template <typename UidType>
+bool IsSameUid(const UidType& a, const UidType& b)
+{
+  return std::memcmp(&a.GetUidData(), &b.GetUidData(), sizeof(a.GetUidData())) == 0;
+}
+
+class ShaderUidCacheTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    BPInit();
+    VertexShaderManager::Init();
+    std::memset(&stats, 0, sizeof(stats));
+  }
+
+  // Mirrors what BPWritten does for a changed register
+  void WriteBP(u32 address, u32 value)
+  {
+    if (reinterpret_cast<u32*>(&bpmem)[address] == value)
+      return;
+    reinterpret_cast<u32*>(&bpmem)[address] = value;
+    ShaderUidCache::BPRegisterChanged(address);
+  }
+
+  // Mirrors what LoadXFReg does for a single register
+  void WriteXF(u32 address, u32 value)
+  {
+    const bool changed = ShaderUidCache::IsXFWriteRelevant(address, value);
+    reinterpret_cast<u32*>(&xfmem)[address] = value;
+    if (changed)
+      ShaderUidCache::Invalidate();
+  }
+
+  // The UIDs for copies of bpmem and xfmem are always computed from scratch
+  void CheckUids(u32 components)
+  {
+    const std::unique_ptr<BPMemory> bp = std::make_unique<BPMemory>(bpmem);
+    const std::unique_ptr<XFMemory> xf = std::make_unique<XFMemory>(xfmem);
+
+    for (PIXEL_SHADER_RENDER_MODE render_mode : {PSRM_DEFAULT, PSRM_DEPTH_ONLY})
+    {
+      PixelShaderUid cached, reference;
+      GetPixelShaderUID(cached, render_mode, components, xfmem, bpmem);
+      GetPixelShaderUID(reference, render_mode, components, *xf, *bp);
+      EXPECT_TRUE(IsSameUid(cached, reference));
+    }
+
+    VertexShaderUid vertex_cached, vertex_reference;
+    GetVertexShaderUID(vertex_cached, components, xfmem, bpmem);
+    GetVertexShaderUID(vertex_reference, components, *xf, *bp);
+    EXPECT_TRUE(IsSameUid(vertex_cached, vertex_reference));
+
+    GeometryShaderUid geometry_cached, geometry_reference;
+    GetGeometryShaderUid(geometry_cached, PrimitiveType::Triangles, xfmem, components);
+    GetGeometryShaderUid(geometry_reference, PrimitiveType::Triangles, *xf, components);
+    EXPECT_TRUE(IsSameUid(geometry_cached, geometry_reference));
+
+    TessellationShaderUid tessellation_cached, tessellation_reference;
+    GetTessellationShaderUID(tessellation_cached, xfmem, bpmem, components);
+    GetTessellationShaderUID(tessellation_reference, *xf, *bp, components);
+    EXPECT_TRUE(IsSameUid(tessellation_cached, tessellation_reference));
+  }
+
+  std::mt19937 m_random{1234};
+};
+}  // namespace
+
+TEST_F(ShaderUidCacheTest, ReusedWithoutRegisterChanges)
+{
+  CheckUids(COMPONENTS);
+  const int computed = stats.thisFrame.numShaderUidsComputed;
+
+  CheckUids(COMPONENTS);
+  // Only the reference UIDs are computed again
+  EXPECT_EQ(computed + 5, stats.thisFrame.numShaderUidsComputed);
+  EXPECT_EQ(5, stats.thisFrame.numShaderUidsReused);
+}
+
+TEST_F(ShaderUidCacheTest, UniformRegistersDontInvalidate)
+{
+  CheckUids(COMPONENTS);
+  const int reused = stats.thisFrame.numShaderUidsReused;
+
+  WriteBP(BPMEM_TX_SETIMAGE0, 0x12345);
+  WriteBP(BPMEM_TEV_COLOR_RA, 0x7ff);
+  WriteBP(BPMEM_SCISSORTL, 0x155155);
+  WriteXF(XFMEM_SETVIEWPORT, 0x3f800000);
+  WriteXF(XFMEM_SETCHAN0_MATCOLOR, 0xffffffff);
+  CheckUids(COMPONENTS);
+  EXPECT_EQ(reused + 5, stats.thisFrame.numShaderUidsReused);
+}
+
+TEST_F(ShaderUidCacheTest, InputsOutsideOfRegistersInvalidate)
+{
+  CheckUids(COMPONENTS);
+  CheckUids(COMPONENTS & ~VB_HAS_NRM0);
+  CheckUids(COMPONENTS);
+}
+
+TEST_F(ShaderUidCacheTest, RandomRegisterWrites)
+{
+  // Keep the counts in range so that the generators don't index out of bounds
+  WriteBP(BPMEM_GENMODE, 0x00033c24);
+  WriteXF(XFMEM_SETNUMCHAN, 2);
+  WriteXF(XFMEM_SETNUMTEXGENS, 4);
+
+  for (int i = 0; i < 5000; ++i)
+  {
+    if (m_random() % 2)
+    {
+      const u32 address = m_random() % 0x100;
+      if (address == BPMEM_GENMODE || address == BPMEM_BP_MASK)
+        continue;
+      WriteBP(address, m_random() & 0xffffff);
+    }
+    else
+    {
+      const u32 address = 0x1000 + m_random() % 0x58;
+      if (address == XFMEM_SETNUMCHAN || address == XFMEM_SETNUMTEXGENS)
+        continue;
+      WriteXF(address, m_random());
+    }
+
+    CheckUids(COMPONENTS);
+  }
+}